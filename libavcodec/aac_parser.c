@@ -55,6 +55,7 @@ static av_cold int aac_parse_init(AVCodecParserContext *s1)
 const FFCodecParser ff_aac_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AAC),
     .priv_data_size = sizeof(AACAC3ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = aac_parse_init,
     .parse          = ff_aac_ac3_parse,
     .close          = ff_parse_close,
@@ -481,6 +481,7 @@ static av_cold int ac3_parse_init(AVCodecParserContext *s1)
 const FFCodecParser ff_ac3_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AC3, AV_CODEC_ID_EAC3),
     .priv_data_size = sizeof(AACAC3ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = ac3_parse_init,
     .parse          = ff_aac_ac3_parse,
     .close          = ff_parse_close,
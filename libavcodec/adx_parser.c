@@ -101,6 +101,7 @@ static int adx_parse(AVCodecParserContext *s1,
 const FFCodecParser ff_adx_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_ADPCM_ADX),
     .priv_data_size = sizeof(ADXParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = adx_parse,
     .close          = ff_parse_close,
 };
@@ -74,6 +74,7 @@ static int ahx_parse(AVCodecParserContext *s1,
 const FFCodecParser ff_ahx_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AHX),
     .priv_data_size = sizeof(AHXParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = ahx_parse,
     .close          = ff_parse_close,
 };
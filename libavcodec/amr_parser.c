@@ -126,6 +126,7 @@ static int amr_parse(AVCodecParserContext *s1,
 const FFCodecParser ff_amr_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AMR_NB, AV_CODEC_ID_AMR_WB),
     .priv_data_size = sizeof(AMRParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = amr_parse_init,
     .parse          = amr_parse,
     .close          = ff_parse_close,
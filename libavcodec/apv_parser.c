@@ -199,7 +199,7 @@ static av_cold void close(AVCodecParserContext *s)
     APVParseContext *p = s->priv_data;
     ParseContext *pc = &p->pc;
 
-    av_freep(&pc->buffer);
+    av_buffer_unref(&pc->buf);
     ff_cbs_fragment_free(&p->au);
     ff_cbs_close(&p->cbc);
 }
@@ -207,6 +207,7 @@ static av_cold void close(AVCodecParserContext *s)
 const FFCodecParser ff_apv_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_APV),
     .priv_data_size = sizeof(APVParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = init,
     .parse          = parse,
     .close          = close,
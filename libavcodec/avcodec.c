@@ -374,6 +374,19 @@ int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *code
             ret = AVERROR(EINVAL);
             goto free_and_end;
         }
+
+        if (avctx->async_depth > 0 &&
+            (avctx->codec_type == AVMEDIA_TYPE_VIDEO ||
+             avctx->codec_type == AVMEDIA_TYPE_AUDIO)) {
+#if HAVE_THREADS
+            ret = ff_decode_async_init(avctx);
+            if (ret < 0)
+                goto free_and_end;
+#else
+            av_log(avctx, AV_LOG_WARNING, "Asynchronous decoding requires "
+                   "threading support, decoding synchronously.\n");
+#endif
+        }
     }
     if (codec->priv_class)
         av_assert0(*(const AVClass **)avctx->priv_data == codec->priv_class);
@@ -418,6 +431,17 @@ void avcodec_flush_buffers(AVCodecContext *avctx)
         ffcodec(avctx->codec)->flush(avctx);
 }
 
+int avcodec_set_thread_count(AVCodecContext *avctx, int thread_count)
+{
+    if (!avcodec_is_open(avctx))
+        return AVERROR(EINVAL);
+
+    if (!HAVE_THREADS)
+        return AVERROR(ENOSYS);
+
+    return ff_thread_set_count(avctx, thread_count);
+}
+
 void avsubtitle_free(AVSubtitle *sub)
 {
     int i;
@@ -452,6 +476,8 @@ av_cold void ff_codec_close(AVCodecContext *avctx)
             ff_frame_thread_encoder_free(avctx);
         }
 #endif
+        if (HAVE_THREADS && avci->decode_async)
+            ff_decode_async_uninit(avctx);
         if (HAVE_THREADS && avci->thread_ctx)
             ff_thread_free(avctx);
         if (avci->needs_close && ffcodec(avctx->codec)->close)
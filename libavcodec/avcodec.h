@@ -357,6 +357,12 @@ typedef struct RcOverride{
  * Force audio encoders to use a fixed frame size.
  */
 #define AV_CODEC_FLAG2_FIXED_FRAME_SIZE (1 << 17)
+/**
+ * Allocate all the planes of a decoded video frame from a single buffer in
+ * the default get_buffer2() implementation, so that frame->buf[0] is the only
+ * reference. Large frames are backed by huge pages where supported.
+ */
+#define AV_CODEC_FLAG2_CONTIGUOUS_FRAMES (1 << 18)
 
 /**
  * Show all frames before the first keyframe
@@ -1935,6 +1941,45 @@ typedef struct AVCodecContext {
      * - decoding: Set by libavcodec
      */
     enum AVAlphaMode alpha_mode;
+
+    /**
+     * Asynchronous decoding: if set to a positive value, the decoder runs on
+     * an internal worker thread and decodes up to async_depth frames ahead
+     * of the caller. avcodec_send_packet() then only queues the packet; it
+     * returns AVERROR(EAGAIN) once async_depth packets are waiting, but
+     * always accepts the flush (NULL) packet. avcodec_receive_frame()
+     * returns AVERROR(EAGAIN) without blocking if no frame is ready and more
+     * packets can be queued; otherwise it waits for the worker. With
+     * AV_CODEC_RECEIVE_FRAME_FLAG_SYNCHRONOUS, it waits until the worker has
+     * run out of queued packets before returning AVERROR(EAGAIN). Decoding
+     * errors are returned by avcodec_receive_frame() in decoding order.
+     *
+     * While this is active, the decoder updates the fields of this context
+     * that it exports from the worker thread, so the caller should rely on
+     * the properties of the returned frames instead. Callbacks such as
+     * get_buffer2() and get_format() are invoked from the worker thread.
+     *
+     * Only used for audio and video decoders, and only in builds with
+     * threading support.
+     *
+     * - encoding: unused
+     * - decoding: Set by user before avcodec_open2(). Default 0 (synchronous
+     *             decoding).
+     */
+    int async_depth;
+
+    /**
+     * With asynchronous decoding, this is called from the worker thread
+     * every time a frame or an error becomes available to
+     * avcodec_receive_frame() and every time a queued packet is taken by
+     * the decoder. It may be used to wake up an event loop (e.g. by writing
+     * to a pipe or an eventfd), but must not call any libavcodec function
+     * on this context.
+     *
+     * - encoding: unused
+     * - decoding: Set by user before avcodec_open2(), may be NULL.
+     */
+    void (*async_notify)(struct AVCodecContext *s);
 } AVCodecContext;
 
 /**
@@ -2921,6 +2966,27 @@ int avcodec_fill_audio_frame(AVFrame *frame, int nb_channels,
  */
 void avcodec_flush_buffers(AVCodecContext *avctx);
 
+/**
+ * Change the number of threads used by an open codec context, e.g. to move
+ * CPU cores between concurrent jobs without reopening their codecs.
+ *
+ * The threads are started by avcodec_open2(), so the number of threads can
+ * only be lowered below AVCodecContext.thread_count as set after opening
+ * and raised back up to it; AVCodecContext.thread_count itself is left
+ * unchanged. The new value takes effect between frames: with frame threading
+ * on decoders, the packets already being decoded are finished first.
+ *
+ * Unlike other functions operating on the context, this function may be
+ * called from any thread.
+ *
+ * @param avctx        an open codec context
+ * @param thread_count number of threads to use, 0 for all threads started by
+ *                     avcodec_open2()
+ * @return the number of threads that will be used, AVERROR(ENOSYS) if the
+ *         context does not use libavcodec's frame or slice threading
+ */
+int avcodec_set_thread_count(AVCodecContext *avctx, int thread_count);
+
 /**
  * Return audio frame duration.
  *
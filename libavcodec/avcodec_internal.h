@@ -48,6 +48,42 @@ extern const SideDataMap ff_sd_global_map[];
 int ff_decode_receive_frame(struct AVCodecContext *avctx, struct AVFrame *frame,
                             unsigned flags);
 
+/**
+ * avcodec_send_packet() and avcodec_receive_frame() implementations for
+ * decoders, decoding in the calling thread. With asynchronous decoding
+ * they are called by the worker thread.
+ */
+int ff_decode_send_packet_sync(struct AVCodecContext *avctx, const AVPacket *avpkt);
+int ff_decode_receive_frame_sync(struct AVCodecContext *avctx, struct AVFrame *frame,
+                                 unsigned flags);
+
+/**
+ * Start the asynchronous decoding worker of a decoder opened with
+ * AVCodecContext.async_depth > 0. Called at the end of avcodec_open2().
+ */
+int ff_decode_async_init(struct AVCodecContext *avctx);
+
+/**
+ * Stop the asynchronous decoding worker and free its queues. Must be called
+ * before the decoder is closed.
+ */
+void ff_decode_async_uninit(struct AVCodecContext *avctx);
+
+/**
+ * Wait for the asynchronous decoding worker to become idle and drop all
+ * queued packets and frames. The worker stays idle until the next packet
+ * is sent. Called by avcodec_flush_buffers().
+ */
+void ff_decode_async_flush(struct AVCodecContext *avctx);
+
+/**
+ * avcodec_send_packet() and avcodec_receive_frame() implementations with
+ * asynchronous decoding.
+ */
+int ff_decode_async_send_packet(struct AVCodecContext *avctx, const AVPacket *avpkt);
+int ff_decode_async_receive_frame(struct AVCodecContext *avctx, struct AVFrame *frame,
+                                  unsigned flags);
+
 /**
  * avcodec_receive_frame() implementation for encoders.
  */
@@ -80,6 +116,11 @@ void ff_codec_close(struct AVCodecContext *avctx);
 int ff_thread_init(struct AVCodecContext *s);
 void ff_thread_free(struct AVCodecContext *s);
 
+/**
+ * avcodec_set_thread_count() implementation.
+ */
+int ff_thread_set_count(struct AVCodecContext *s, int thread_count);
+
 /**
  * Wait for decoding threads to finish and reset internal state.
  * Called by avcodec_flush_buffers().
@@ -193,6 +193,7 @@ static int avs2_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_avs2_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AVS2),
     .priv_data_size = sizeof(ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = avs2_parse,
     .close          = ff_parse_close,
 };
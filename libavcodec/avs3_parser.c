@@ -176,6 +176,7 @@ static int avs3_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_avs3_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AVS3),
     .priv_data_size = sizeof(ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = avs3_parse,
     .close          = ff_parse_close,
 };
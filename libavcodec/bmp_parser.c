@@ -109,6 +109,7 @@ flush:
 const FFCodecParser ff_bmp_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_BMP),
     .priv_data_size = sizeof(BMPParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = bmp_parse,
     .close          = ff_parse_close,
 };
@@ -153,6 +153,14 @@ static const CBSBSFType av1_metadata_type = {
 static int av1_metadata_init(AVBSFContext *bsf)
 {
     AV1MetadataContext *ctx = bsf->priv_data;
+    // Only the sequence header is ever modified; frame data is copied
+    // through untouched.
+    static const CodedBitstreamUnitType decompose_unit_types[] = {
+        AV1_OBU_SEQUENCE_HEADER,
+    };
+
+    ctx->common.decompose_unit_types    = decompose_unit_types;
+    ctx->common.nb_decompose_unit_types = FF_ARRAY_ELEMS(decompose_unit_types);
 
     ctx->td_obu = (AV1RawOBU) {
         .header.obu_type = AV1_OBU_TEMPORAL_DELIMITER,
@@ -206,6 +214,10 @@ static const AVOption av1_metadata_options[] = {
         OFFSET(delete_padding), AV_OPT_TYPE_BOOL,
         { .i64 = 0 }, 0, 1, FLAGS},
 
+    { "full_decompose", "Decompose all OBUs, not only those which are modified",
+        OFFSET(common.full_decompose), AV_OPT_TYPE_BOOL,
+        { .i64 = 0 }, 0, 1, FLAGS },
+
     { NULL }
 };
 
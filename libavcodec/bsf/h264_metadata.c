@@ -83,6 +83,8 @@ typedef struct H264MetadataContext {
     H264RawSEIDisplayOrientation display_orientation_payload;
 
     int level;
+
+    CodedBitstreamUnitType decompose_unit_types[5];
 } H264MetadataContext;
 
 
@@ -552,6 +554,8 @@ static const CBSBSFType h264_metadata_type = {
 static int h264_metadata_init(AVBSFContext *bsf)
 {
     H264MetadataContext *ctx = bsf->priv_data;
+    CodedBitstreamUnitType *types;
+    int n, sei;
 
     if (ctx->sei_user_data) {
         SEIRawUserDataUnregistered *udu = &ctx->sei_user_data_payload;
@@ -586,6 +590,26 @@ static int h264_metadata_init(AVBSFContext *bsf)
         }
     }
 
+    // Parameter set edits only need the SPS.  Slices (and the PPSs needed
+    // to read them) are only decomposed when the slice types are required
+    // for an AUD or when SEI messages are read, since SEI parsing relies on
+    // the active SPS being tracked through the slice headers.  All other
+    // NAL units are copied through without being parsed or rewritten.
+    types = ctx->decompose_unit_types;
+    n = 0;
+    types[n++] = H264_NAL_SPS;
+    sei = ctx->sei_user_data || ctx->delete_filler ||
+          ctx->display_orientation != BSF_ELEMENT_PASS;
+    if (sei)
+        types[n++] = H264_NAL_SEI;
+    if (sei || ctx->aud == BSF_ELEMENT_INSERT) {
+        types[n++] = H264_NAL_PPS;
+        types[n++] = H264_NAL_SLICE;
+        types[n++] = H264_NAL_IDR_SLICE;
+    }
+    ctx->common.decompose_unit_types    = types;
+    ctx->common.nb_decompose_unit_types = n;
+
     return ff_cbs_bsf_generic_init(bsf, &h264_metadata_type);
 }
 
@@ -699,6 +723,10 @@ static const AVOption h264_metadata_options[] = {
     { LEVEL("6.2", 62) },
 #undef LEVEL
 
+    { "full_decompose", "Decompose all NAL units, not only those which are modified",
+        OFFSET(common.full_decompose), AV_OPT_TYPE_BOOL,
+        { .i64 = 0 }, 0, 1, FLAGS },
+
     { NULL }
 };
 
@@ -489,6 +489,21 @@ static const CBSBSFType h265_metadata_type = {
 
 static int h265_metadata_init(AVBSFContext *bsf)
 {
+    H265MetadataContext *ctx = bsf->priv_data;
+    // Only the parameter sets are needed to edit them and to guess the
+    // level; slice data is copied through untouched.  Inserting an AUD
+    // needs the slice types and temporal IDs of every NAL unit.
+    static const CodedBitstreamUnitType decompose_unit_types[] = {
+        HEVC_NAL_VPS,
+        HEVC_NAL_SPS,
+        HEVC_NAL_PPS,
+    };
+
+    if (ctx->aud != BSF_ELEMENT_INSERT) {
+        ctx->common.decompose_unit_types    = decompose_unit_types;
+        ctx->common.nb_decompose_unit_types = FF_ARRAY_ELEMS(decompose_unit_types);
+    }
+
     return ff_cbs_bsf_generic_init(bsf, &h265_metadata_type);
 }
 
@@ -574,6 +589,10 @@ static const AVOption h265_metadata_options[] = {
     { LEVEL("8.5", 255) },
 #undef LEVEL
 
+    { "full_decompose", "Decompose all NAL units, not only those which are modified",
+        OFFSET(common.full_decompose), AV_OPT_TYPE_BOOL,
+        { .i64 = 0 }, 0, 1, FLAGS },
+
     { NULL }
 };
 
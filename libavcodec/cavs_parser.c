@@ -186,6 +186,7 @@ static int cavsvideo_parse(AVCodecParserContext *s,
 const FFCodecParser ff_cavsvideo_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_CAVS),
     .priv_data_size = sizeof(ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = cavsvideo_parse,
     .close          = ff_parse_close,
 };
@@ -159,6 +159,11 @@ av_cold int ff_cbs_bsf_generic_init(AVBSFContext *bsf, const CBSBSFType *type)
     if (err < 0)
         return err;
 
+    if (ctx->decompose_unit_types && !ctx->full_decompose) {
+        ctx->input->decompose_unit_types    = ctx->decompose_unit_types;
+        ctx->input->nb_decompose_unit_types = ctx->nb_decompose_unit_types;
+    }
+
     ctx->output->trace_enable = 1;
     ctx->output->trace_level  = AV_LOG_TRACE;
     ctx->output->trace_context = ctx->output;
@@ -57,6 +57,17 @@ typedef struct CBSBSFContext {
     CodedBitstreamContext *input;
     CodedBitstreamContext *output;
     CodedBitstreamFragment fragment;
+
+    // Unit types whose content the filter needs to inspect or modify, to
+    // be set before calling ff_cbs_bsf_generic_init().  Units of all other
+    // types are not decomposed and are written back from their original
+    // data.  If NULL, all units are decomposed.
+    const CodedBitstreamUnitType *decompose_unit_types;
+    int nb_decompose_unit_types;
+
+    // Ignore decompose_unit_types and decompose all units anyway
+    // (user option).
+    int full_decompose;
 } CBSBSFContext;
 
 /**
@@ -70,7 +81,9 @@ extern const enum AVCodecID ff_cbs_all_codec_ids[];
  * Initialise generic CBS BSF setup.
  *
  * Creates the input and output CBS instances, and applies the filter to
- * the extradata on the input codecpar if any is present.
+ * the extradata on the input codecpar if any is present.  If the filter
+ * has set decompose_unit_types then only units of those types will be
+ * decomposed when reading.
  *
  * Since it calls the update_fragment() function immediately to deal with
  * extradata, this should be called after any codec-specific setup is done
@@ -18,6 +18,7 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/avassert.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/mem.h"
 
 #include "bytestream.h"
@@ -320,12 +321,59 @@ int ff_cbs_h2645_write_slice_data(CodedBitstreamContext *ctx,
     return 0;
 }
 
+/**
+ * Copy the payload of a NAL unit to dst, inserting emulation prevention
+ * bytes where needed, and return the number of bytes written.  Words
+ * without any zero byte cannot need an escape, so outside of runs of
+ * zeros (which are rare in slice data) the payload is copied a word at a
+ * time.
+ */
+static size_t cbs_h2645_escape_unit(uint8_t *dst, const uint8_t *src,
+                                    size_t size)
+{
+    size_t dp = 0, sp = 0, start;
+    int zero_run = 0;
+
+    while (sp < size) {
+        start = sp;
+#if HAVE_FAST_UNALIGNED && HAVE_FAST_64BIT
+        if (!zero_run) {
+            while (sp + 8 <= size) {
+                uint64_t x = AV_RN64(src + sp);
+                if ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL)
+                    break;
+                sp += 8;
+            }
+            memcpy(dst + dp, src + start, sp - start);
+            dp += sp - start;
+            if (sp >= size)
+                break;
+        }
+#endif
+        if (zero_run < 2) {
+            if (src[sp] == 0)
+                ++zero_run;
+            else
+                zero_run = 0;
+        } else {
+            if ((src[sp] & ~3) == 0) {
+                // emulation_prevention_three_byte
+                dst[dp++] = 3;
+            }
+            zero_run = src[sp] == 0;
+        }
+        dst[dp++] = src[sp++];
+    }
+
+    return dp;
+}
+
 int ff_cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
                                        CodedBitstreamFragment *frag)
 {
     uint8_t *data;
-    size_t max_size, dp, sp;
-    int err, i, zero_run;
+    size_t max_size, dp;
+    int err, i;
 
     for (i = 0; i < frag->nb_units; i++) {
         // Data should already all have been written when we get here.
@@ -363,22 +411,7 @@ int ff_cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
         data[dp++] = 0;
         data[dp++] = 1;
 
-        zero_run = 0;
-        for (sp = 0; sp < unit->data_size; sp++) {
-            if (zero_run < 2) {
-                if (unit->data[sp] == 0)
-                    ++zero_run;
-                else
-                    zero_run = 0;
-            } else {
-                if ((unit->data[sp] & ~3) == 0) {
-                    // emulation_prevention_three_byte
-                    data[dp++] = 3;
-                }
-                zero_run = unit->data[sp] == 0;
-            }
-            data[dp++] = unit->data[sp];
-        }
+        dp += cbs_h2645_escape_unit(data + dp, unit->data, unit->data_size);
     }
 
     av_assert0(dp <= max_size);
@@ -101,6 +101,7 @@ static int cri_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_cri_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_CRI),
     .priv_data_size = sizeof(CRIParser),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = cri_parse,
     .close          = ff_parse_close,
 };
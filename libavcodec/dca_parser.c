@@ -348,6 +348,7 @@ static int dca_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_dca_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_DTS),
     .priv_data_size = sizeof(DCAParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = dca_parse_init,
     .parse          = dca_parse,
     .close          = ff_parse_close,
@@ -727,21 +727,15 @@ static int decode_receive_frame_internal(AVCodecContext *avctx, AVFrame *frame,
     return ret;
 }
 
-int attribute_align_arg avcodec_send_packet(AVCodecContext *avctx, const AVPacket *avpkt)
+int ff_decode_send_packet_sync(AVCodecContext *avctx, const AVPacket *avpkt)
 {
     AVCodecInternal *avci = avctx->internal;
     DecodeContext     *dc = decode_ctx(avci);
     int ret;
 
-    if (!avcodec_is_open(avctx) || !av_codec_is_decoder(avctx->codec))
-        return AVERROR(EINVAL);
-
     if (dc->draining_started)
         return AVERROR_EOF;
 
-    if (avpkt && !avpkt->size && avpkt->data)
-        return AVERROR(EINVAL);
-
     if (avpkt && (avpkt->data || avpkt->side_data_elems)) {
         if (!AVPACKET_IS_EMPTY(avci->buffer_pkt))
             return AVERROR(EAGAIN);
@@ -760,6 +754,20 @@ int attribute_align_arg avcodec_send_packet(AVCodecContext *avctx, const AVPacke
     return 0;
 }
 
+int attribute_align_arg avcodec_send_packet(AVCodecContext *avctx, const AVPacket *avpkt)
+{
+    if (!avcodec_is_open(avctx) || !av_codec_is_decoder(avctx->codec))
+        return AVERROR(EINVAL);
+
+    if (avpkt && !avpkt->size && avpkt->data)
+        return AVERROR(EINVAL);
+
+    if (HAVE_THREADS && avctx->internal->decode_async)
+        return ff_decode_async_send_packet(avctx, avpkt);
+
+    return ff_decode_send_packet_sync(avctx, avpkt);
+}
+
 static int apply_cropping(AVCodecContext *avctx, AVFrame *frame)
 {
     /* make sure we are noisy about decoders returning invalid cropping data */
@@ -814,7 +822,7 @@ fail:
     return AVERROR_BUG;
 }
 
-int ff_decode_receive_frame(AVCodecContext *avctx, AVFrame *frame, unsigned flags)
+int ff_decode_receive_frame_sync(AVCodecContext *avctx, AVFrame *frame, unsigned flags)
 {
     AVCodecInternal *avci = avctx->internal;
     int ret;
@@ -845,6 +853,14 @@ fail:
     return ret;
 }
 
+int ff_decode_receive_frame(AVCodecContext *avctx, AVFrame *frame, unsigned flags)
+{
+    if (HAVE_THREADS && avctx->internal->decode_async)
+        return ff_decode_async_receive_frame(avctx, frame, flags);
+
+    return ff_decode_receive_frame_sync(avctx, frame, flags);
+}
+
 static void get_subtitle_defaults(AVSubtitle *sub)
 {
     memset(sub, 0, sizeof(*sub));
@@ -2367,6 +2383,9 @@ av_cold void ff_decode_flush_buffers(AVCodecContext *avctx)
     AVCodecInternal *avci = avctx->internal;
     DecodeContext     *dc = decode_ctx(avci);
 
+    if (HAVE_THREADS && avci->decode_async)
+        ff_decode_async_flush(avctx);
+
     av_packet_unref(avci->last_pkt_props);
     av_packet_unref(avci->in_pkt);
 
@@ -0,0 +1,344 @@
+/*
+ * Asynchronous decoding
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Decode-ahead worker for AVCodecContext.async_depth.
+ *
+ * The worker thread drives the decoder exactly like a synchronous user of
+ * avcodec_send_packet()/avcodec_receive_frame() would: it feeds one queued
+ * packet, then receives frames until the decoder asks for more input. The
+ * caller only moves packets into and frames out of the queues.
+ */
+
+#include "libavutil/error.h"
+#include "libavutil/fifo.h"
+#include "libavutil/frame.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "avcodec.h"
+#include "avcodec_internal.h"
+#include "internal.h"
+#include "packet.h"
+#include "pthread_internal.h"
+
+typedef struct DecodeAsyncFrame {
+    AVFrame *frame;     ///< decoded frame, NULL for errors
+    int      ret;       ///< error returned by the decoder
+} DecodeAsyncFrame;
+
+typedef struct DecodeAsyncContext {
+    pthread_t       thread;
+    unsigned        pthread_init_cnt;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+
+    /* Queued input packets, a NULL entry marks the start of draining. */
+    AVFifo         *packets;
+    /* Decoded frames and errors, in decoding order. */
+    AVFifo         *frames;
+
+    int             depth;
+    AVFrame        *frame;
+
+    /* The following fields are protected by lock. */
+    int             need_input;  ///< the decoder returned EAGAIN, send a packet next
+    int             draining;    ///< the worker has sent the drain packet
+    int             eof;         ///< the decoder returned EOF
+    int             drain_sent;  ///< the caller has sent the drain packet
+    int             paused;      ///< stopped by a flush until the next packet
+    int             busy;        ///< the worker is inside the decoder
+    int             exit;
+} DecodeAsyncContext;
+
+#define OFF(member) offsetof(DecodeAsyncContext, member)
+DEFINE_OFFSET_ARRAY(DecodeAsyncContext, decode_async, pthread_init_cnt,
+                    (OFF(lock)), (OFF(cond)));
+#undef OFF
+
+static void notify(AVCodecContext *avctx)
+{
+    if (avctx->async_notify)
+        avctx->async_notify(avctx);
+}
+
+static int worker_idle(const DecodeAsyncContext *s)
+{
+    if (s->paused || s->eof)
+        return 1;
+    if (s->need_input)
+        return !av_fifo_can_read(s->packets);
+    return av_fifo_can_read(s->frames) >= s->depth;
+}
+
+static void *attribute_align_arg decode_async_worker(void *arg)
+{
+    AVCodecContext    *avctx = arg;
+    DecodeAsyncContext    *s = avctx->internal->decode_async;
+
+    ff_thread_setname("av:decode");
+
+    pthread_mutex_lock(&s->lock);
+    while (1) {
+        DecodeAsyncFrame out = { 0 };
+        int progress = 0, ret;
+
+        while (!s->exit && worker_idle(s))
+            pthread_cond_wait(&s->cond, &s->lock);
+        if (s->exit)
+            break;
+
+        s->busy = 1;
+        if (s->need_input) {
+            AVPacket *pkt;
+
+            av_fifo_read(s->packets, &pkt, 1);
+            s->need_input = 0;
+            s->draining  |= !pkt;
+            progress      = 1;
+            pthread_mutex_unlock(&s->lock);
+
+            ret = ff_decode_send_packet_sync(avctx, pkt);
+            av_packet_free(&pkt);
+            if (ret < 0 && ret != AVERROR_EOF)
+                out.ret = ret;
+
+            pthread_mutex_lock(&s->lock);
+        } else {
+            pthread_mutex_unlock(&s->lock);
+
+            ret = ff_decode_receive_frame_sync(avctx, s->frame, 0);
+            if (ret >= 0) {
+                out.frame = av_frame_alloc();
+                if (out.frame)
+                    av_frame_move_ref(out.frame, s->frame);
+                else
+                    ret = AVERROR(ENOMEM);
+            }
+            av_frame_unref(s->frame);
+
+            pthread_mutex_lock(&s->lock);
+            if (ret == AVERROR(EAGAIN)) {
+                if (s->draining && !av_fifo_can_read(s->packets))
+                    s->eof = 1;
+                else
+                    s->need_input = 1;
+            } else if (ret == AVERROR_EOF) {
+                s->eof = 1;
+            } else {
+                out.ret = ret < 0 ? ret : 0;
+            }
+        }
+        s->busy = 0;
+
+        /* A flush during the call drops its result with everything else. */
+        if ((out.frame || out.ret < 0) && !s->paused) {
+            ret = av_fifo_write(s->frames, &out, 1);
+            if (ret < 0)
+                av_frame_free(&out.frame);
+            else
+                progress = 1;
+        } else {
+            av_frame_free(&out.frame);
+        }
+        pthread_cond_broadcast(&s->cond);
+
+        if (progress) {
+            pthread_mutex_unlock(&s->lock);
+            notify(avctx);
+            pthread_mutex_lock(&s->lock);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+static void discard_queues(DecodeAsyncContext *s)
+{
+    AVPacket *pkt;
+    DecodeAsyncFrame out;
+
+    while (av_fifo_read(s->packets, &pkt, 1) >= 0)
+        av_packet_free(&pkt);
+    while (av_fifo_read(s->frames, &out, 1) >= 0)
+        av_frame_free(&out.frame);
+}
+
+av_cold int ff_decode_async_init(AVCodecContext *avctx)
+{
+    AVCodecInternal *avci = avctx->internal;
+    DecodeAsyncContext *s;
+    int ret;
+
+    s = av_mallocz(sizeof(*s));
+    if (!s)
+        return AVERROR(ENOMEM);
+    avci->decode_async = s;
+
+    s->depth      = avctx->async_depth;
+    s->need_input = 1;
+
+    /* one extra entry for the drain packet, which is always accepted */
+    s->packets = av_fifo_alloc2(s->depth + 1, sizeof(AVPacket*), 0);
+    s->frames  = av_fifo_alloc2(s->depth, sizeof(DecodeAsyncFrame),
+                                AV_FIFO_FLAG_AUTO_GROW);
+    s->frame   = av_frame_alloc();
+    if (!s->packets || !s->frames || !s->frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    ret = ff_pthread_init(s, decode_async_offsets);
+    if (ret < 0)
+        goto fail;
+
+    ret = pthread_create(&s->thread, NULL, decode_async_worker, avctx);
+    if (ret) {
+        ret = AVERROR(ret);
+        goto fail;
+    }
+
+    return 0;
+fail:
+    ff_pthread_free(s, decode_async_offsets);
+    av_fifo_freep2(&s->packets);
+    av_fifo_freep2(&s->frames);
+    av_frame_free(&s->frame);
+    av_freep(&avci->decode_async);
+    return ret;
+}
+
+av_cold void ff_decode_async_uninit(AVCodecContext *avctx)
+{
+    DecodeAsyncContext *s = avctx->internal->decode_async;
+
+    if (!s)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    s->exit = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread, NULL);
+
+    discard_queues(s);
+    ff_pthread_free(s, decode_async_offsets);
+    av_fifo_freep2(&s->packets);
+    av_fifo_freep2(&s->frames);
+    av_frame_free(&s->frame);
+    av_freep(&avctx->internal->decode_async);
+}
+
+void ff_decode_async_flush(AVCodecContext *avctx)
+{
+    DecodeAsyncContext *s = avctx->internal->decode_async;
+
+    pthread_mutex_lock(&s->lock);
+    s->paused = 1;
+    while (s->busy)
+        pthread_cond_wait(&s->cond, &s->lock);
+
+    discard_queues(s);
+    s->need_input = 1;
+    s->draining   = 0;
+    s->eof        = 0;
+    s->drain_sent = 0;
+    pthread_mutex_unlock(&s->lock);
+}
+
+int ff_decode_async_send_packet(AVCodecContext *avctx, const AVPacket *avpkt)
+{
+    DecodeAsyncContext *s = avctx->internal->decode_async;
+    AVPacket *pkt = NULL;
+    int ret;
+
+    if (avpkt && (avpkt->data || avpkt->side_data_elems)) {
+        pkt = av_packet_alloc();
+        if (!pkt)
+            return AVERROR(ENOMEM);
+        ret = av_packet_ref(pkt, avpkt);
+        if (ret < 0) {
+            av_packet_free(&pkt);
+            return ret;
+        }
+    }
+
+    pthread_mutex_lock(&s->lock);
+    if (s->drain_sent)
+        ret = AVERROR_EOF;
+    else if (pkt && av_fifo_can_read(s->packets) >= s->depth)
+        ret = AVERROR(EAGAIN);
+    else
+        ret = av_fifo_write(s->packets, &pkt, 1);
+
+    if (ret >= 0) {
+        s->drain_sent = !pkt;
+        s->paused     = 0;
+        pthread_cond_broadcast(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    if (ret < 0)
+        av_packet_free(&pkt);
+
+    return ret;
+}
+
+int ff_decode_async_receive_frame(AVCodecContext *avctx, AVFrame *frame,
+                                  unsigned flags)
+{
+    DecodeAsyncContext *s = avctx->internal->decode_async;
+    DecodeAsyncFrame out;
+    int ret;
+
+    pthread_mutex_lock(&s->lock);
+    while (1) {
+        if (av_fifo_read(s->frames, &out, 1) >= 0) {
+            ret = out.ret;
+            break;
+        }
+        if (s->eof) {
+            ret = AVERROR_EOF;
+            break;
+        }
+        /* Without a full input queue the caller may send more packets
+         * instead of waiting, unless it asked for synchronous output and
+         * the worker still has work to do. */
+        if (!s->drain_sent && av_fifo_can_read(s->packets) < s->depth &&
+            (!(flags & AV_CODEC_RECEIVE_FRAME_FLAG_SYNCHRONOUS) ||
+             (!s->busy && worker_idle(s)))) {
+            ret = AVERROR(EAGAIN);
+            break;
+        }
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+
+    if (ret >= 0 && out.frame) {
+        av_frame_move_ref(frame, out.frame);
+        av_frame_free(&out.frame);
+    }
+
+    return ret;
+}
@@ -142,6 +142,7 @@ static int dnxhd_parse(AVCodecParserContext *s,
 const FFCodecParser ff_dnxhd_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_DNXHD),
     .priv_data_size = sizeof(DNXHDParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = dnxhd_parse,
     .close          = ff_parse_close,
 };
@@ -813,13 +813,60 @@ int dnxhd_switch_matrix(DNXHDEncContext *ctx, int i)
     return x;
 }
 
+/* Computes the bits and (when needed) the reconstruction SSD of the
+ * macroblock whose blocks were loaded by dnxhd_get_blocks(); returns
+ * nonzero if any block has AC coefficients left at this qscale. */
+static av_always_inline int dnxhd_calc_mb_bits(AVCodecContext *avctx,
+                                               DNXHDEncContext *ctx,
+                                               unsigned mb, int qscale)
+{
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
+    int ssd     = 0;
+    int ac_bits = 0;
+    int dc_bits = 0;
+    int coded   = 0;
+
+    for (int i = 0; i < 8 + 4 * ctx->is_444; i++) {
+        int16_t *src_block = ctx->blocks[i];
+        int overflow, nbits, diff, last_index;
+        int n = dnxhd_switch_matrix(ctx, i);
+
+        memcpy(block, src_block, 64 * sizeof(*block));
+        last_index = ctx->m.dct_quantize(&ctx->m, block,
+                                         ctx->is_444 ? 4 * (n > 0): 4 & (2*i),
+                                         qscale, &overflow);
+        ac_bits   += dnxhd_calc_ac_bits(ctx, block, last_index);
+        coded     |= last_index;
+
+        diff = block[0] - ctx->m.last_dc[n];
+        if (diff < 0)
+            nbits = av_log2_16bit(-2 * diff);
+        else
+            nbits = av_log2_16bit(2 * diff);
+
+        av_assert1(nbits < ctx->bit_depth + 4);
+        dc_bits += ctx->cid_table->dc_bits[nbits] + nbits;
+
+        ctx->m.last_dc[n] = block[0];
+
+        if (avctx->mb_decision == FF_MB_DECISION_RD || !RC_VARIANCE) {
+            dnxhd_unquantize_c(ctx, block, i, qscale, last_index);
+            ctx->m.c.idsp.idct(block);
+            ssd += dnxhd_ssd_block(block, src_block);
+        }
+    }
+    ctx->mb_rc[(qscale * ctx->m.c.mb_num) + mb].ssd  = ssd;
+    ctx->mb_rc[(qscale * ctx->m.c.mb_num) + mb].bits = ac_bits + dc_bits + 12 +
+                                 (1 + ctx->is_444) * 8 * ctx->vlc_bits[0];
+    return coded;
+}
+
 static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
                                   int jobnr, int threadnr)
 {
     DNXHDEncContext *ctx = avctx->priv_data;
     int mb_y = jobnr;
     int qscale = ctx->qscale;
-    LOCAL_ALIGNED_16(int16_t, block, [64]);
     ctx = ctx->thread[threadnr];
 
     ctx->m.last_dc[0] =
@@ -827,45 +874,44 @@ static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
     ctx->m.last_dc[2] = 1 << (ctx->bit_depth + 2);
 
     for (int mb_x = 0; mb_x < ctx->m.c.mb_width; mb_x++) {
-        unsigned mb = mb_y * ctx->m.c.mb_width + mb_x;
-        int ssd     = 0;
-        int ac_bits = 0;
-        int dc_bits = 0;
-        int i;
-
         dnxhd_get_blocks(ctx, mb_x, mb_y);
+        dnxhd_calc_mb_bits(avctx, ctx, mb_y * ctx->m.c.mb_width + mb_x, qscale);
+    }
+    return 0;
+}
 
-        for (i = 0; i < 8 + 4 * ctx->is_444; i++) {
-            int16_t *src_block = ctx->blocks[i];
-            int overflow, nbits, diff, last_index;
-            int n = dnxhd_switch_matrix(ctx, i);
-
-            memcpy(block, src_block, 64 * sizeof(*block));
-            last_index = ctx->m.dct_quantize(&ctx->m, block,
-                                             ctx->is_444 ? 4 * (n > 0): 4 & (2*i),
-                                             qscale, &overflow);
-            ac_bits   += dnxhd_calc_ac_bits(ctx, block, last_index);
-
-            diff = block[0] - ctx->m.last_dc[n];
-            if (diff < 0)
-                nbits = av_log2_16bit(-2 * diff);
-            else
-                nbits = av_log2_16bit(2 * diff);
+/* Fills the bits/SSD table of every qscale for one macroblock row. The
+ * blocks of a macroblock are fetched once for all qscales, and since DC
+ * coding does not depend on the qscale, once no AC coefficient survives
+ * quantisation every coarser qscale gives the same result and is copied
+ * instead of being computed. */
+static int dnxhd_calc_rd_thread(AVCodecContext *avctx, void *arg,
+                                int jobnr, int threadnr)
+{
+    DNXHDEncContext *ctx = avctx->priv_data;
+    int mb_y = jobnr;
+    ctx = ctx->thread[threadnr];
 
-            av_assert1(nbits < ctx->bit_depth + 4);
-            dc_bits += ctx->cid_table->dc_bits[nbits] + nbits;
+    ctx->m.last_dc[0] =
+    ctx->m.last_dc[1] =
+    ctx->m.last_dc[2] = 1 << (ctx->bit_depth + 2);
 
-            ctx->m.last_dc[n] = block[0];
+    for (int mb_x = 0; mb_x < ctx->m.c.mb_width; mb_x++) {
+        unsigned mb = mb_y * ctx->m.c.mb_width + mb_x;
+        int last_dc[3];
 
-            if (avctx->mb_decision == FF_MB_DECISION_RD || !RC_VARIANCE) {
-                dnxhd_unquantize_c(ctx, block, i, qscale, last_index);
-                ctx->m.c.idsp.idct(block);
-                ssd += dnxhd_ssd_block(block, src_block);
+        dnxhd_get_blocks(ctx, mb_x, mb_y);
+        memcpy(last_dc, ctx->m.last_dc, sizeof(last_dc));
+
+        for (int q = 1; q < avctx->qmax; q++) {
+            memcpy(ctx->m.last_dc, last_dc, sizeof(last_dc));
+            if (!dnxhd_calc_mb_bits(avctx, ctx, mb, q)) {
+                for (int q2 = q + 1; q2 < avctx->qmax; q2++)
+                    ctx->mb_rc[(q2 * ctx->m.c.mb_num) + mb] =
+                        ctx->mb_rc[(q * ctx->m.c.mb_num) + mb];
+                break;
             }
         }
-        ctx->mb_rc[(qscale * ctx->m.c.mb_num) + mb].ssd  = ssd;
-        ctx->mb_rc[(qscale * ctx->m.c.mb_num) + mb].bits = ac_bits + dc_bits + 12 +
-                                     (1 + ctx->is_444) * 8 * ctx->vlc_bits[0];
     }
     return 0;
 }
@@ -998,11 +1044,8 @@ static int dnxhd_encode_rdo(AVCodecContext *avctx, DNXHDEncContext *ctx)
     int lambda, up_step, down_step;
     int last_lower = INT_MAX, last_higher = 0;
 
-    for (int q = 1; q < avctx->qmax; q++) {
-        ctx->qscale = q;
-        avctx->execute2(avctx, dnxhd_calc_bits_thread,
-                        NULL, NULL, ctx->m.c.mb_height);
-    }
+    avctx->execute2(avctx, dnxhd_calc_rd_thread,
+                    NULL, NULL, ctx->m.c.mb_height);
     up_step = down_step = 2 << LAMBDA_FRAC_BITS;
     lambda  = ctx->lambda;
 
@@ -1218,7 +1261,7 @@ retry:
             int rc = (ctx->qscale * ctx->m.c.mb_num ) + mb;
             max_bits -= ctx->mb_rc[rc].bits -
                         ctx->mb_rc[rc + ctx->m.c.mb_num].bits;
-            if (ctx->mb_qscale[mb] < 255)
+            if (ctx->mb_qscale[mb] < ctx->m.c.avctx->qmax)
                 ctx->mb_qscale[mb]++;
             ctx->mb_bits[mb]   = ctx->mb_rc[rc + ctx->m.c.mb_num].bits;
         }
@@ -98,7 +98,7 @@ typedef struct DNXHDEncContext {
     unsigned lambda;
 
     uint32_t *mb_bits;
-    uint8_t  *mb_qscale;
+    uint16_t *mb_qscale;
 
     RCCMPEntry *mb_cmp;
     RCCMPEntry *mb_cmp_tmp;
@@ -85,6 +85,7 @@ static int dnxuc_parse(AVCodecParserContext *s,
 const FFCodecParser ff_dnxuc_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_DNXUC),
     .priv_data_size = sizeof(DNxUcParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = dnxuc_parse,
     .close          = ff_parse_close,
 };
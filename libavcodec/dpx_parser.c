@@ -112,6 +112,7 @@ flush:
 const FFCodecParser ff_dpx_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_DPX),
     .priv_data_size = sizeof(DPXParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = dpx_parse,
     .close          = ff_parse_close,
 };
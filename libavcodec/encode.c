@@ -935,7 +935,16 @@ void ff_encode_flush_buffers(AVCodecContext *avctx)
 
 AVCodecInternal *ff_encode_internal_alloc(void)
 {
-    return av_mallocz(sizeof(EncodeContext));
+    EncodeContext *ec = av_mallocz(sizeof(*ec));
+
+    if (!ec)
+        return NULL;
+
+    ec->avci.gop_start.frame_number = -1;
+    ec->avci.gop_start.vbv_fullness = -1;
+    ec->avci.gop_start.total_bits   = -1;
+
+    return &ec->avci;
 }
 
 AVCPBProperties *ff_encode_add_cpb_side_data(AVCodecContext *avctx)
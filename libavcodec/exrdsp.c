@@ -56,10 +56,30 @@ static void predictor_scalar(uint8_t *src, ptrdiff_t size)
     }
 }
 
+static void reorder_pixels_enc_scalar(uint8_t *dst, const uint8_t *src, ptrdiff_t size)
+{
+    const ptrdiff_t half_size = size / 2;
+    uint8_t *t1 = dst;
+    uint8_t *t2 = dst + half_size;
+
+    for (ptrdiff_t i = 0; i < half_size; i++) {
+        t1[i] = *(src++);
+        t2[i] = *(src++);
+    }
+}
+
+static void predictor_enc_scalar(uint8_t *src, ptrdiff_t size)
+{
+    for (ptrdiff_t i = size - 1; i > 0; i--)
+        src[i] = (src[i] - src[i - 1]) ^ 0x80;
+}
+
 av_cold void ff_exrdsp_init(ExrDSPContext *c)
 {
-    c->reorder_pixels   = reorder_pixels_scalar;
-    c->predictor        = predictor_scalar;
+    c->reorder_pixels     = reorder_pixels_scalar;
+    c->predictor          = predictor_scalar;
+    c->reorder_pixels_enc = reorder_pixels_enc_scalar;
+    c->predictor_enc      = predictor_enc_scalar;
 
 #if ARCH_RISCV
     ff_exrdsp_init_riscv(c);
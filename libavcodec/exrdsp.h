@@ -25,6 +25,10 @@
 typedef struct ExrDSPContext {
     void (*reorder_pixels)(uint8_t *dst, const uint8_t *src, ptrdiff_t size);
     void (*predictor)(uint8_t *src, ptrdiff_t size);
+
+    /* encoder side: split even and odd bytes, in-place byte delta + 128 */
+    void (*reorder_pixels_enc)(uint8_t *dst, const uint8_t *src, ptrdiff_t size);
+    void (*predictor_enc)(uint8_t *src, ptrdiff_t size);
 } ExrDSPContext;
 
 void ff_exrdsp_init(ExrDSPContext *c);
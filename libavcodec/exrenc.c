@@ -36,12 +36,15 @@
 #include "bytestream.h"
 #include "codec_internal.h"
 #include "encode.h"
+#include "exrdsp.h"
+#include "put_bits.h"
 
 enum ExrCompr {
     EXR_RAW,
     EXR_RLE,
     EXR_ZIP1,
     EXR_ZIP16,
+    EXR_PIZ,
     EXR_NBCOMPR,
 };
 
@@ -72,6 +75,29 @@ typedef struct EXRScanlineData {
     int64_t actual_size;
 } EXRScanlineData;
 
+#define USHORT_RANGE (1 << 16)
+#define BITMAP_SIZE  (1 << 13)
+
+#define HUF_ENCBITS 16  // literal (value) bit length
+#define HUF_ENCSIZE ((1 << HUF_ENCBITS) + 1)  // encoding table size
+
+#define SHORT_ZEROCODE_RUN  59
+#define LONG_ZEROCODE_RUN   63
+#define SHORTEST_LONG_RUN   (2 + LONG_ZEROCODE_RUN - SHORT_ZEROCODE_RUN)
+#define LONGEST_LONG_RUN    (255 + SHORTEST_LONG_RUN)
+
+/* worst case PIZ overhead: bitmap, lengths, Huffman table and one run */
+#define PIZ_OVERHEAD (BITMAP_SIZE + 32 + (HUF_ENCSIZE * 6 + 7) / 8 + 2048)
+
+typedef struct EXRThreadData {
+    uint8_t  *bitmap;
+    uint16_t *lut;
+    uint64_t *freq;
+    uint64_t *scode;
+    int      *hlink;
+    int      *heap;
+} EXRThreadData;
+
 typedef struct EXRContext {
     const AVClass *class;
 
@@ -86,7 +112,10 @@ typedef struct EXRContext {
     PutByteContext pb;
 
     EXRScanlineData *scanline;
+    EXRThreadData *thread_data;
+    int nb_threads;
 
+    ExrDSPContext dsp;
     Float2HalfTables f2h_tables;
 } EXRContext;
 
@@ -95,6 +124,7 @@ static av_cold int encode_init(AVCodecContext *avctx)
     EXRContext *s = avctx->priv_data;
 
     ff_init_float2half_tables(&s->f2h_tables);
+    ff_exrdsp_init(&s->dsp);
 
     switch (avctx->pix_fmt) {
     case AV_PIX_FMT_GBRPF32:
@@ -127,6 +157,10 @@ static av_cold int encode_init(AVCodecContext *avctx)
         s->scanline_height = 16;
         s->nb_scanlines = (avctx->height + s->scanline_height - 1) / s->scanline_height;
         break;
+    case EXR_PIZ:
+        s->scanline_height = 32;
+        s->nb_scanlines = (avctx->height + s->scanline_height - 1) / s->scanline_height;
+        break;
     default:
         av_assert0(0);
     }
@@ -135,6 +169,27 @@ static av_cold int encode_init(AVCodecContext *avctx)
     if (!s->scanline)
         return AVERROR(ENOMEM);
 
+    if (s->compression == EXR_PIZ) {
+        s->nb_threads  = FFMAX(avctx->thread_count, 1);
+        s->thread_data = av_calloc(s->nb_threads, sizeof(*s->thread_data));
+        if (!s->thread_data)
+            return AVERROR(ENOMEM);
+
+        for (int i = 0; i < s->nb_threads; i++) {
+            EXRThreadData *td = &s->thread_data[i];
+
+            td->bitmap = av_malloc(BITMAP_SIZE);
+            td->lut    = av_malloc_array(USHORT_RANGE, sizeof(*td->lut));
+            td->freq   = av_malloc_array(HUF_ENCSIZE, sizeof(*td->freq));
+            td->scode  = av_malloc_array(HUF_ENCSIZE, sizeof(*td->scode));
+            td->hlink  = av_malloc_array(HUF_ENCSIZE, sizeof(*td->hlink));
+            td->heap   = av_malloc_array(HUF_ENCSIZE, sizeof(*td->heap));
+            if (!td->bitmap || !td->lut || !td->freq ||
+                !td->scode || !td->hlink || !td->heap)
+                return AVERROR(ENOMEM);
+        }
+    }
+
     return 0;
 }
 
@@ -152,31 +207,20 @@ static av_cold int encode_close(AVCodecContext *avctx)
 
     av_freep(&s->scanline);
 
-    return 0;
-}
-
-static void reorder_pixels(uint8_t *dst, const uint8_t *src, ptrdiff_t size)
-{
-    const ptrdiff_t half_size = (size + 1) / 2;
-    uint8_t *t1 = dst;
-    uint8_t *t2 = dst + half_size;
+    for (int i = 0; i < s->nb_threads && s->thread_data; i++) {
+        EXRThreadData *td = &s->thread_data[i];
 
-    for (ptrdiff_t i = 0; i < half_size; i++) {
-        t1[i] = *(src++);
-        t2[i] = *(src++);
+        av_freep(&td->bitmap);
+        av_freep(&td->lut);
+        av_freep(&td->freq);
+        av_freep(&td->scode);
+        av_freep(&td->hlink);
+        av_freep(&td->heap);
     }
-}
-
-static void predictor(uint8_t *src, ptrdiff_t size)
-{
-    int p = src[0];
 
-    for (ptrdiff_t i = 1; i < size; i++) {
-        int d = src[i] - p + 384;
+    av_freep(&s->thread_data);
 
-        p = src[i];
-        src[i] = d;
-    }
+    return 0;
 }
 
 static int64_t rle_compress(uint8_t *out, int64_t out_size,
@@ -218,135 +262,489 @@ static int64_t rle_compress(uint8_t *out, int64_t out_size,
     return o;
 }
 
-static int encode_scanline_rle(EXRContext *s, const AVFrame *frame)
+/* Convert the lines of a block, with the channels of a line stored
+ * line_stride bytes apart and the lines plane_stride bytes apart. */
+static void fill_block(EXRContext *s, const AVFrame *frame, uint8_t *dst,
+                       int y0, int lines, ptrdiff_t line_stride, ptrdiff_t plane_stride)
 {
-    const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
-
-    for (int y = 0; y < frame->height; y++) {
-        EXRScanlineData *scanline = &s->scanline[y];
-        int64_t tmp_size = element_size * s->planes * frame->width;
-        int64_t max_compressed_size = tmp_size * 3 / 2;
-
-        av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
-        if (!scanline->uncompressed_data)
-            return AVERROR(ENOMEM);
-
-        av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
-        if (!scanline->tmp)
-            return AVERROR(ENOMEM);
-
-        av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
-        if (!scanline->compressed_data)
-            return AVERROR(ENOMEM);
-
-        switch (s->pixel_type) {
-        case EXR_FLOAT:
+    switch (s->pixel_type) {
+    case EXR_FLOAT:
+        for (int l = 0; l < lines; l++) {
             for (int p = 0; p < s->planes; p++) {
                 int ch = s->ch_order[p];
 
-                memcpy(scanline->uncompressed_data + frame->width * 4 * p,
-                       frame->data[ch] + y * frame->linesize[ch], frame->width * 4);
+                memcpy(dst + line_stride * l + plane_stride * p,
+                       frame->data[ch] + (y0 + l) * frame->linesize[ch],
+                       frame->width * 4);
             }
-            break;
-        case EXR_HALF:
+        }
+        break;
+    case EXR_HALF:
+        for (int l = 0; l < lines; l++) {
             for (int p = 0; p < s->planes; p++) {
                 int ch = s->ch_order[p];
-                uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + frame->width * 2 * p);
-                const uint32_t *src = (const uint32_t *)(frame->data[ch] + y * frame->linesize[ch]);
+                uint16_t *dst16 = (uint16_t *)(dst + line_stride * l + plane_stride * p);
+                const uint32_t *src = (const uint32_t *)(frame->data[ch] + (y0 + l) * frame->linesize[ch]);
 
                 for (int x = 0; x < frame->width; x++)
-                    dst[x] = float2half(src[x], &s->f2h_tables);
+                    dst16[x] = float2half(src[x], &s->f2h_tables);
             }
-            break;
         }
+        break;
+    }
+}
+
+static void bitmap_from_data(const uint16_t *data, int dsize, uint8_t *bitmap,
+                             uint16_t *min_non_zero, uint16_t *max_non_zero)
+{
+    memset(bitmap, 0, BITMAP_SIZE);
+
+    for (int i = 0; i < dsize; i++)
+        bitmap[data[i] >> 3] |= 1 << (data[i] & 7);
+
+    bitmap[0] &= ~1; /* zero is not explicitly stored in the bitmap */
 
-        reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
-        predictor(scanline->tmp, tmp_size);
-        scanline->actual_size = rle_compress(scanline->compressed_data,
-                                             max_compressed_size,
-                                             scanline->tmp, tmp_size);
+    *min_non_zero = BITMAP_SIZE - 1;
+    *max_non_zero = 0;
 
-        if (scanline->actual_size <= 0 || scanline->actual_size >= tmp_size) {
-            FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
-            FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
-            scanline->actual_size = tmp_size;
+    for (int i = 0; i < BITMAP_SIZE; i++) {
+        if (bitmap[i]) {
+            *min_non_zero = FFMIN(*min_non_zero, i);
+            *max_non_zero = i;
         }
     }
-
-    return 0;
 }
 
-static int encode_scanline_zip(EXRContext *s, const AVFrame *frame)
+static uint16_t forward_lut(const uint8_t *bitmap, uint16_t *lut)
 {
-    const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
+    int k = 0;
 
-    for (int y = 0; y < s->nb_scanlines; y++) {
-        EXRScanlineData *scanline = &s->scanline[y];
-        const int scanline_height = FFMIN(s->scanline_height, frame->height - y * s->scanline_height);
-        int64_t tmp_size = element_size * s->planes * frame->width * scanline_height;
-        int64_t max_compressed_size = tmp_size * 3 / 2;
-        unsigned long actual_size, source_size;
+    for (int i = 0; i < USHORT_RANGE; i++) {
+        if (i == 0 || (bitmap[i >> 3] & (1 << (i & 7))))
+            lut[i] = k++;
+        else
+            lut[i] = 0;
+    }
 
-        av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
-        if (!scanline->uncompressed_data)
-            return AVERROR(ENOMEM);
+    return k - 1;
+}
 
-        av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
-        if (!scanline->tmp)
-            return AVERROR(ENOMEM);
+static inline void wenc14(uint16_t a, uint16_t b, uint16_t *l, uint16_t *h)
+{
+    int16_t as = a;
+    int16_t bs = b;
 
-        av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
-        if (!scanline->compressed_data)
-            return AVERROR(ENOMEM);
+    *l = (as + bs) >> 1;
+    *h = as - bs;
+}
 
-        switch (s->pixel_type) {
-        case EXR_FLOAT:
-            for (int l = 0; l < scanline_height; l++) {
-                const int scanline_size = frame->width * 4 * s->planes;
+#define NBITS      16
+#define A_OFFSET  (1 << (NBITS - 1))
+#define MOD_MASK  ((1 << NBITS) - 1)
 
-                for (int p = 0; p < s->planes; p++) {
-                    int ch = s->ch_order[p];
+static inline void wenc16(uint16_t a, uint16_t b, uint16_t *l, uint16_t *h)
+{
+    int ao = (a + A_OFFSET) & MOD_MASK;
+    int m  = (ao + b) >> 1;
+    int d  = ao - b;
+
+    if (d < 0)
+        m = (m + A_OFFSET) & MOD_MASK;
+
+    *l = m;
+    *h = d & MOD_MASK;
+}
 
-                    memcpy(scanline->uncompressed_data + scanline_size * l + p * frame->width * 4,
-                           frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch],
-                           frame->width * 4);
+/* the exact inverse of wav_decode() in exr.c */
+static void wav_encode(uint16_t *in, int nx, int ox,
+                       int ny, int oy, uint16_t mx)
+{
+    int w14 = (mx < (1 << 14));
+    int n   = (nx > ny) ? ny : nx;
+    int p   = 1;
+    int p2  = 2;
+
+    while (p2 <= n) {
+        uint16_t *py = in;
+        uint16_t *ey = in + oy * (ny - p2);
+        uint16_t i00, i01, i10, i11;
+        int oy1 = oy * p;
+        int oy2 = oy * p2;
+        int ox1 = ox * p;
+        int ox2 = ox * p2;
+
+        for (; py <= ey; py += oy2) {
+            uint16_t *px = py;
+            uint16_t *ex = py + ox * (nx - p2);
+
+            for (; px <= ex; px += ox2) {
+                uint16_t *p01 = px + ox1;
+                uint16_t *p10 = px + oy1;
+                uint16_t *p11 = p10 + ox1;
+
+                if (w14) {
+                    wenc14(*px, *p01, &i00, &i01);
+                    wenc14(*p10, *p11, &i10, &i11);
+                    wenc14(i00, i10, px, p10);
+                    wenc14(i01, i11, p01, p11);
+                } else {
+                    wenc16(*px, *p01, &i00, &i01);
+                    wenc16(*p10, *p11, &i10, &i11);
+                    wenc16(i00, i10, px, p10);
+                    wenc16(i01, i11, p01, p11);
                 }
             }
-            break;
-        case EXR_HALF:
-            for (int l = 0; l < scanline_height; l++) {
-                const int scanline_size = frame->width * 2 * s->planes;
 
-                for (int p = 0; p < s->planes; p++) {
-                    int ch = s->ch_order[p];
-                    uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + scanline_size * l + p * frame->width * 2);
-                    const uint32_t *src = (const uint32_t *)(frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch]);
+            if (nx & p) {
+                uint16_t *p10 = px + oy1;
 
-                    for (int x = 0; x < frame->width; x++)
-                        dst[x] = float2half(src[x], &s->f2h_tables);
-                }
+                if (w14)
+                    wenc14(*px, *p10, &i00, p10);
+                else
+                    wenc16(*px, *p10, &i00, p10);
+
+                *px = i00;
+            }
+        }
+
+        if (ny & p) {
+            uint16_t *px = py;
+            uint16_t *ex = py + ox * (nx - p2);
+
+            for (; px <= ex; px += ox2) {
+                uint16_t *p01 = px + ox1;
+
+                if (w14)
+                    wenc14(*px, *p01, &i00, p01);
+                else
+                    wenc16(*px, *p01, &i00, p01);
+
+                *px = i00;
             }
+        }
+
+        p   = p2;
+        p2 <<= 1;
+    }
+}
+
+static void heap_sift_down(int *heap, int nb, int i, const uint64_t *freq)
+{
+    int v = heap[i];
+
+    for (;;) {
+        int c = 2 * i + 1;
+
+        if (c >= nb)
+            break;
+        if (c + 1 < nb && freq[heap[c + 1]] < freq[heap[c]])
+            c++;
+        if (freq[heap[c]] >= freq[v])
             break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = v;
+}
+
+static void huf_canonical_code_table(uint64_t *scode)
+{
+    uint64_t c, n[59] = { 0 };
+
+    for (int i = 0; i < HUF_ENCSIZE; i++)
+        n[scode[i]] += 1;
+
+    c = 0;
+    for (int i = 58; i > 0; --i) {
+        uint64_t nc = ((c + n[i]) >> 1);
+        n[i] = c;
+        c    = nc;
+    }
+
+    for (int i = 0; i < HUF_ENCSIZE; ++i) {
+        int l = scode[i];
+
+        if (l > 0)
+            scode[i] = l | (n[l]++ << 6);
+    }
+}
+
+/**
+ * Build the canonical Huffman code of the symbols counted in td->freq.
+ * The pseudo symbol iM, one past the last used symbol, codes runs.
+ * Code lengths are longer than 32 bits only for pathological
+ * distributions, which the decoder does not support; report failure then.
+ */
+static int huf_build_enc_table(EXRThreadData *td, int *im, int *iM)
+{
+    uint64_t *freq  = td->freq;
+    uint64_t *scode = td->scode;
+    int *hlink = td->hlink;
+    int *heap  = td->heap;
+    int nb = 0;
+
+    *im = 0;
+    while (!freq[*im])
+        (*im)++;
+
+    for (int i = *im; i < HUF_ENCSIZE; i++) {
+        hlink[i] = i;
+        if (freq[i]) {
+            heap[nb++] = i;
+            *iM = i;
         }
+    }
+
+    (*iM)++;
+    freq[*iM] = 1;
+    heap[nb++] = *iM;
+
+    memset(scode, 0, HUF_ENCSIZE * sizeof(*scode));
 
-        reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
-        predictor(scanline->tmp, tmp_size);
-        source_size = tmp_size;
-        actual_size = max_compressed_size;
-        compress(scanline->compressed_data, &actual_size,
-                 scanline->tmp, source_size);
-
-        scanline->actual_size = actual_size;
-        if (scanline->actual_size >= tmp_size) {
-            FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
-            FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
-            scanline->actual_size = tmp_size;
+    for (int i = nb / 2 - 1; i >= 0; i--)
+        heap_sift_down(heap, nb, i, freq);
+
+    while (nb > 1) {
+        int mm = heap[0], m;
+
+        heap[0] = heap[--nb];
+        heap_sift_down(heap, nb, 0, freq);
+        m = heap[0];
+        freq[m] += freq[mm];
+        heap_sift_down(heap, nb, 0, freq);
+
+        /* add a bit to all codes in the merged chains */
+        for (int j = m;; j = hlink[j]) {
+            scode[j]++;
+            if (hlink[j] == j) {
+                hlink[j] = mm;
+                break;
+            }
+        }
+        for (int j = mm;; j = hlink[j]) {
+            scode[j]++;
+            if (hlink[j] == j)
+                break;
         }
     }
 
+    for (int i = *im; i <= *iM; i++)
+        if (scode[i] > 32)
+            return AVERROR(EINVAL);
+
+    huf_canonical_code_table(scode);
+
     return 0;
 }
 
+static void huf_pack_enc_table(PutBitContext *pb, const uint64_t *scode, int im, int iM)
+{
+    for (; im <= iM; im++) {
+        int l = scode[im] & 63;
+
+        if (l == 0) {
+            int zerun = 1;
+
+            while (im < iM && zerun < LONGEST_LONG_RUN) {
+                if (scode[im + 1] & 63)
+                    break;
+                im++;
+                zerun++;
+            }
+
+            if (zerun >= 2) {
+                if (zerun >= SHORTEST_LONG_RUN) {
+                    put_bits(pb, 6, LONG_ZEROCODE_RUN);
+                    put_bits(pb, 8, zerun - SHORTEST_LONG_RUN);
+                } else {
+                    put_bits(pb, 6, SHORT_ZEROCODE_RUN + zerun - 2);
+                }
+                continue;
+            }
+        }
+
+        put_bits(pb, 6, l);
+    }
+}
+
+static inline void huf_put_code(PutBitContext *pb, uint64_t code)
+{
+    put_bits63(pb, code & 63, code >> 6);
+}
+
+static inline void huf_send_code(PutBitContext *pb, uint64_t scode, int run,
+                                 uint64_t rcode)
+{
+    int len = scode & 63;
+
+    if (len + (rcode & 63) + 8 < len * run) {
+        huf_put_code(pb, scode);
+        huf_put_code(pb, rcode);
+        put_bits(pb, 8, run);
+    } else {
+        while (run-- >= 0)
+            huf_put_code(pb, scode);
+    }
+}
+
+/* Returns the size of the compressed data, or a negative value
+ * if it does not fit into dst_size bytes. */
+static int64_t huf_compress(EXRThreadData *td, const uint16_t *src, int nb,
+                            uint8_t *dst, int64_t dst_size)
+{
+    const uint64_t *scode = td->scode;
+    PutBitContext pb;
+    int im, iM, table_size, nbits, run = 0;
+    uint16_t s;
+
+    memset(td->freq, 0, HUF_ENCSIZE * sizeof(*td->freq));
+    for (int i = 0; i < nb; i++)
+        td->freq[src[i]]++;
+
+    if (huf_build_enc_table(td, &im, &iM) < 0)
+        return -1;
+
+    /* the decoder needs a symbol not present in the data for the runs */
+    if (im == 0 && iM >= USHORT_RANGE - 1) {
+        int i = 0;
+
+        while (i < iM && (scode[i] & 63))
+            i++;
+        if (i == iM)
+            return -1;
+    }
+
+    init_put_bits(&pb, dst + 20, dst_size - 20);
+    huf_pack_enc_table(&pb, scode, im, iM);
+    flush_put_bits(&pb);
+    table_size = put_bytes_output(&pb);
+
+    init_put_bits(&pb, dst + 20 + table_size, dst_size - 20 - table_size);
+    s = src[0];
+    for (int i = 1; i < nb; i++) {
+        if (s == src[i] && run < 255) {
+            run++;
+        } else {
+            /* a single run emits at most 256 codes of up to 32 bits */
+            if (put_bytes_left(&pb, 0) < 1100)
+                return -1;
+            huf_send_code(&pb, scode[s], run, scode[iM]);
+            run = 0;
+        }
+        s = src[i];
+    }
+    if (put_bytes_left(&pb, 0) < 1100)
+        return -1;
+    huf_send_code(&pb, scode[s], run, scode[iM]);
+
+    nbits = put_bits_count(&pb);
+    flush_put_bits(&pb);
+
+    AV_WL32(dst,      im);
+    AV_WL32(dst +  4, iM);
+    AV_WL32(dst +  8, table_size);
+    AV_WL32(dst + 12, nbits);
+    AV_WL32(dst + 16, 0);
+
+    return 20 + table_size + put_bytes_output(&pb);
+}
+
+static int64_t piz_compress(EXRContext *s, EXRThreadData *td,
+                            uint8_t *dst, int64_t dst_size,
+                            uint16_t *tmp, int width, int lines)
+{
+    const int words = s->pixel_type == EXR_HALF ? 1 : 2;
+    const int nb = width * lines * words * s->planes;
+    uint16_t min_non_zero, max_non_zero, maxval;
+    uint8_t *ptr = dst;
+    int64_t ret;
+
+    bitmap_from_data(tmp, nb, td->bitmap, &min_non_zero, &max_non_zero);
+    maxval = forward_lut(td->bitmap, td->lut);
+    for (int i = 0; i < nb; i++)
+        tmp[i] = td->lut[tmp[i]];
+
+    AV_WL16(ptr,     min_non_zero);
+    AV_WL16(ptr + 2, max_non_zero);
+    ptr += 4;
+    if (min_non_zero <= max_non_zero) {
+        memcpy(ptr, td->bitmap + min_non_zero, max_non_zero - min_non_zero + 1);
+        ptr += max_non_zero - min_non_zero + 1;
+    }
+
+    for (int p = 0; p < s->planes; p++) {
+        uint16_t *plane = tmp + p * width * lines * words;
+
+        for (int j = 0; j < words; j++)
+            wav_encode(plane + j, width, words, lines, width * words, maxval);
+    }
+
+    ret = huf_compress(td, tmp, nb, ptr + 4, dst + dst_size - ptr - 4);
+    if (ret < 0)
+        return ret;
+    AV_WL32(ptr, ret);
+
+    return ptr + 4 + ret - dst;
+}
+
+static int encode_block(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    EXRContext *s = avctx->priv_data;
+    const AVFrame *frame = arg;
+    EXRScanlineData *scanline = &s->scanline[jobnr];
+    const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
+    const int y0 = jobnr * s->scanline_height;
+    const int scanline_height = FFMIN(s->scanline_height, frame->height - y0);
+    const int64_t line_size = element_size * frame->width;
+    int64_t tmp_size = line_size * s->planes * scanline_height;
+    int64_t max_compressed_size = tmp_size * 3 / 2;
+    unsigned long actual_size;
+
+    switch (s->compression) {
+    case EXR_RLE:
+    case EXR_ZIP1:
+    case EXR_ZIP16:
+        fill_block(s, frame, scanline->uncompressed_data, y0, scanline_height,
+                   line_size * s->planes, line_size);
+        s->dsp.reorder_pixels_enc(scanline->tmp, scanline->uncompressed_data, tmp_size);
+        s->dsp.predictor_enc(scanline->tmp, tmp_size);
+
+        if (s->compression == EXR_RLE) {
+            scanline->actual_size = rle_compress(scanline->compressed_data,
+                                                 max_compressed_size,
+                                                 scanline->tmp, tmp_size);
+        } else {
+            actual_size = max_compressed_size;
+            compress(scanline->compressed_data, &actual_size,
+                     scanline->tmp, tmp_size);
+            scanline->actual_size = actual_size;
+        }
+        break;
+    case EXR_PIZ:
+        /* PIZ works on planar data: each channel's lines are contiguous */
+        fill_block(s, frame, scanline->tmp, y0, scanline_height,
+                   line_size, line_size * scanline_height);
+        scanline->actual_size = piz_compress(s, &s->thread_data[threadnr],
+                                             scanline->compressed_data,
+                                             tmp_size + PIZ_OVERHEAD,
+                                             (uint16_t *)scanline->tmp,
+                                             frame->width, scanline_height);
+        if (scanline->actual_size <= 0 || scanline->actual_size >= tmp_size)
+            fill_block(s, frame, scanline->uncompressed_data, y0, scanline_height,
+                       line_size * s->planes, line_size);
+        break;
+    default:
+        av_assert0(0);
+    }
+
+    if (scanline->actual_size <= 0 || scanline->actual_size >= tmp_size) {
+        FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
+        FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
+        scanline->actual_size = tmp_size;
+    }
+
+    return 0;
+}
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *frame, int *got_packet)
 {
@@ -432,19 +830,30 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     bytestream2_put_buffer(pb, "lavc", 4);
     bytestream2_put_byte(pb, 0);
 
-    switch (s->compression) {
-    case EXR_RAW:
-        /* nothing to do */
-        break;
-    case EXR_RLE:
-        encode_scanline_rle(s, frame);
-        break;
-    case EXR_ZIP16:
-    case EXR_ZIP1:
-        encode_scanline_zip(s, frame);
-        break;
-    default:
-        av_assert0(0);
+    if (s->compression != EXR_RAW) {
+        const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
+
+        for (int y = 0; y < s->nb_scanlines; y++) {
+            EXRScanlineData *scanline = &s->scanline[y];
+            const int scanline_height = FFMIN(s->scanline_height, frame->height - y * s->scanline_height);
+            int64_t tmp_size = element_size * s->planes * frame->width * scanline_height;
+            int64_t max_compressed_size = s->compression == EXR_PIZ ? tmp_size + PIZ_OVERHEAD
+                                                                    : tmp_size * 3 / 2;
+
+            av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
+            if (!scanline->uncompressed_data)
+                return AVERROR(ENOMEM);
+
+            av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
+            if (!scanline->tmp)
+                return AVERROR(ENOMEM);
+
+            av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
+            if (!scanline->compressed_data)
+                return AVERROR(ENOMEM);
+        }
+
+        avctx->execute2(avctx, encode_block, (void *)frame, NULL, s->nb_scanlines);
     }
 
     switch (s->compression) {
@@ -486,6 +895,7 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
             }
         }
         break;
+    case EXR_PIZ:
     case EXR_ZIP16:
     case EXR_ZIP1:
     case EXR_RLE:
@@ -526,6 +936,7 @@ static const AVOption options[] = {
     { "rle" ,        "RLE",                  0,                   AV_OPT_TYPE_CONST, {.i64=EXR_RLE}, 0, 0, VE, .unit = "compr" },
     { "zip1",        "ZIP1",                 0,                   AV_OPT_TYPE_CONST, {.i64=EXR_ZIP1}, 0, 0, VE, .unit = "compr" },
     { "zip16",       "ZIP16",                0,                   AV_OPT_TYPE_CONST, {.i64=EXR_ZIP16}, 0, 0, VE, .unit = "compr" },
+    { "piz",         "PIZ",                  0,                   AV_OPT_TYPE_CONST, {.i64=EXR_PIZ}, 0, 0, VE, .unit = "compr" },
     { "format", "set pixel type", OFFSET(pixel_type), AV_OPT_TYPE_INT,   {.i64=EXR_FLOAT}, EXR_HALF, EXR_UNKNOWN-1, VE, .unit = "pixel" },
     { "half" ,       NULL,                   0,                   AV_OPT_TYPE_CONST, {.i64=EXR_HALF},  0, 0, VE, .unit = "pixel" },
     { "float",       NULL,                   0,                   AV_OPT_TYPE_CONST, {.i64=EXR_FLOAT}, 0, 0, VE, .unit = "pixel" },
@@ -548,6 +959,7 @@ const FFCodec ff_exr_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_EXR,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .init           = encode_init,
     FF_CODEC_ENCODE_CB(encode_frame),
@@ -104,6 +104,8 @@ typedef struct FFV1SliceContext {
         struct {
             uint64_t rc_stat[256][2];
             uint64_t (*rc_stat2[MAX_QUANT_TABLES])[32][2];
+            int *line_context;           ///< per sample context of the line being coded
+            int *line_diff;              ///< per sample folded residual of the line being coded
         };
     };
     int remap_count[4];
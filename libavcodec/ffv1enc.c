@@ -41,6 +41,12 @@
 #include "rangecoder.h"
 #include "ffv1.h"
 #include "ffv1enc.h"
+#include "ffv1encdsp.h"
+
+typedef struct FFV1EncContext {
+    FFV1Context f;                ///< must be first, the options refer to it
+    FFV1EncDSPContext dsp;
+} FFV1EncContext;
 
 static const int8_t quant5_10bit[256] = {
      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  1,  1,  1,
@@ -137,49 +143,81 @@ static const uint8_t ver2_state[256] = {
     241, 243, 242, 244, 245, 246, 247, 248, 249, 250, 251, 252, 252, 253, 254, 255,
 };
 
-static void find_best_state(uint8_t best_state[256][256],
-                            const uint8_t one_state[256])
-{
-    int i, j, k, m;
+typedef struct FindBestStateContext {
+    uint8_t (*best_state)[256];
+    const uint8_t *one_state;
     uint32_t l2tab[256];
+} FindBestStateContext;
 
-    for (i = 1; i < 256; i++)
-        l2tab[i] = -log2(i / 256.0) * ((1U << 31) / 8);
-
-    for (i = 0; i < 256; i++) {
-        uint64_t best_len[256];
+/* Find the best initial state for each length k of a bit sequence with
+ * probability i / 256 of a zero bit. The rows are independent and computed
+ * in parallel, this dominates the encoder setup in 2-pass mode. */
+static int find_best_state_thread(AVCodecContext *avctx, void *arg,
+                                  int i, int threadnr)
+{
+    const FindBestStateContext *s = arg;
+    const uint8_t *one_state = s->one_state;
+    uint8_t *best_state = s->best_state[i];
+    uint64_t best_len[256];
+    uint64_t cost[256];
+    int j, k, m;
+
+    for (j = 0; j < 256; j++)
+        best_len[j] = UINT64_MAX;
+
+    for (m = 1; m < 256; m++)
+        cost[m] = (       i *(uint64_t)s->l2tab[    m]
+                   + (256-i)*(uint64_t)s->l2tab[256-m]) >> 8;
+
+    for (j = FFMAX(i - 10, 1); j < FFMIN(i + 11, 256); j++) {
+        uint32_t occ[256] = { 0 };
+        uint64_t len      = 0;
+        int lo = j, hi = j; // range of occupied states
+        occ[j] = UINT32_MAX;
+
+        if (!one_state[j])
+            continue;
+
+        for (k = 0; k < 256; k++) {
+            uint32_t newocc[256] = { 0 };
+            int newlo = 255, newhi = 1;
+
+            for (m = lo; m <= hi; m++)
+                len += (occ[m] * cost[m]) >> 8;
+            if (len < best_len[k]) {
+                best_len[k]   = len;
+                best_state[k] = j;
+            }
+            for (m = lo; m <= hi; m++)
+                if (occ[m]) {
+                    const int s0 =       one_state[      m];
+                    const int s1 = 256 - one_state[256 - m];
+                    newocc[s0] += occ[m] * (uint64_t)       i  >> 8;
+                    newocc[s1] += occ[m] * (uint64_t)(256 - i) >> 8;
+                    newlo = FFMIN(newlo, FFMIN(s0, s1));
+                    newhi = FFMAX(newhi, FFMAX(s0, s1));
+                }
+            memcpy(occ, newocc, sizeof(occ));
+            lo = FFMAX(newlo, 1);
+            hi = newhi;
+        }
+    }
 
-        for (j = 0; j < 256; j++)
-            best_len[j] = UINT64_MAX;
+    return 0;
+}
 
-        for (j = FFMAX(i - 10, 1); j < FFMIN(i + 11, 256); j++) {
-            uint32_t occ[256] = { 0 };
-            uint64_t len      = 0;
-            occ[j] = UINT32_MAX;
+static void find_best_state(AVCodecContext *avctx, uint8_t best_state[256][256],
+                            const uint8_t one_state[256])
+{
+    FindBestStateContext s = {
+        .best_state = best_state,
+        .one_state  = one_state,
+    };
 
-            if (!one_state[j])
-                continue;
+    for (int i = 1; i < 256; i++)
+        s.l2tab[i] = -log2(i / 256.0) * ((1U << 31) / 8);
 
-            for (k = 0; k < 256; k++) {
-                uint32_t newocc[256] = { 0 };
-                for (m = 1; m < 256; m++)
-                    if (occ[m]) {
-                        len += (occ[m]*((       i *(uint64_t)l2tab[    m]
-                                         + (256-i)*(uint64_t)l2tab[256-m])>>8)) >> 8;
-                    }
-                if (len < best_len[k]) {
-                    best_len[k]      = len;
-                    best_state[i][k] = j;
-                }
-                for (m = 1; m < 256; m++)
-                    if (occ[m]) {
-                        newocc[      one_state[      m]] += occ[m] * (uint64_t)       i  >> 8;
-                        newocc[256 - one_state[256 - m]] += occ[m] * (uint64_t)(256 - i) >> 8;
-                    }
-                memcpy(occ, newocc, sizeof(occ));
-            }
-        }
-    }
+    avctx->execute2(avctx, find_best_state_thread, &s, NULL, 256);
 }
 
 static av_always_inline av_flatten void put_symbol_inline(RangeCoder *c,
@@ -189,6 +227,8 @@ static av_always_inline av_flatten void put_symbol_inline(RangeCoder *c,
                                                           uint64_t rc_stat2[32][2])
 {
     int i;
+    int low   = c->low;
+    int range = c->range;
 
 #define put_rac(C, S, B)                        \
     do {                                        \
@@ -196,7 +236,7 @@ static av_always_inline av_flatten void put_symbol_inline(RangeCoder *c,
             rc_stat[*(S)][B]++;                 \
             rc_stat2[(S) - state][B]++;         \
         }                                       \
-        put_rac(C, S, B);                       \
+        put_rac_local(C, &low, &range, S, B);   \
     } while (0)
 
     if (v) {
@@ -227,6 +267,8 @@ static av_always_inline av_flatten void put_symbol_inline(RangeCoder *c,
     } else {
         put_rac(c, state + 0, 1);
     }
+    c->low   = low;
+    c->range = range;
 #undef put_rac
 }
 
@@ -763,7 +805,7 @@ av_cold int ff_ffv1_encode_init(AVCodecContext *avctx)
         if (s->ac == AC_RANGE_CUSTOM_TAB)
             sort_stt(s, s->state_transition);
 
-        find_best_state(best_state, s->state_transition);
+        find_best_state(avctx, best_state, s->state_transition);
 
         for (i = 0; i < s->quant_table_count; i++) {
             for (k = 0; k < 32; k++) {
@@ -1002,11 +1044,14 @@ av_cold int ff_ffv1_encode_setup_plane_info(AVCodecContext *avctx,
 static av_cold int encode_init_internal(AVCodecContext *avctx)
 {
     int ret;
-    FFV1Context *s = avctx->priv_data;
+    FFV1EncContext *const enc = avctx->priv_data;
+    FFV1Context *s = &enc->f;
 
     if ((ret = ff_ffv1_common_init(avctx, s)) < 0)
         return ret;
 
+    ff_ffv1_encdsp_init(&enc->dsp);
+
     if (s->ac == 1) // Compatibility with common command line usage
         s->ac = AC_RANGE_CUSTOM_TAB;
     else if (s->ac == AC_RANGE_DEFAULT_TAB_FORCE)
@@ -1073,6 +1118,13 @@ static av_cold int encode_init_internal(AVCodecContext *avctx)
             }
         }
 
+        sc->line_context = av_malloc_array(sc->slice_width,
+                                           sizeof(*sc->line_context));
+        sc->line_diff    = av_malloc_array(sc->slice_width,
+                                           sizeof(*sc->line_diff));
+        if (!sc->line_context || !sc->line_diff)
+            return AVERROR(ENOMEM);
+
         ff_build_rac_states(&s->slices[j].c, 0.05 * (1LL << 32), 256 - 8);
 
         s->slices[j].remap = s->remap_mode;
@@ -2036,6 +2088,8 @@ static av_cold int encode_close(AVCodecContext *avctx)
             av_freep(&sc->unit[p]);
             av_freep(&sc->bitmap[p]);
         }
+        av_freep(&sc->line_context);
+        av_freep(&sc->line_diff);
     }
 
     av_freep(&avctx->stats_out);
@@ -2097,7 +2151,7 @@ const FFCodec ff_ffv1_encoder = {
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
                       AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
-    .priv_data_size = sizeof(FFV1Context),
+    .priv_data_size = sizeof(FFV1EncContext),
     .init           = encode_init_internal,
     FF_CODEC_ENCODE_CB(encode_frame),
     .close          = encode_close,
@@ -28,6 +28,7 @@ RENAME(encode_line)(FFV1Context *f, FFV1SliceContext *sc,
                     int w, TYPE *const sample[3], int plane_index, int bits,
                     int ac, int pass1)
 {
+    const FFV1EncContext *const enc = f->avctx->priv_data;
     PlaneContext *const p = &sc->plane[plane_index];
     RangeCoder *const c   = &sc->c;
     int x;
@@ -68,19 +69,12 @@ RENAME(encode_line)(FFV1Context *f, FFV1SliceContext *sc,
         }
     }
 
-    for (x = 0; x < w; x++) {
-        int diff, context;
-
-        context = RENAME(get_context)(f->quant_tables[p->quant_table_index],
-                                      sample[0] + x, sample[1] + x, sample[2] + x);
-        diff    = sample[0][x] - RENAME(predict)(sample[0] + x, sample[1] + x);
+    enc->dsp.RENAME(line_contexts)(sc->line_context, sc->line_diff, sample,
+                                   f->quant_tables[p->quant_table_index], w, bits);
 
-        if (context < 0) {
-            context = -context;
-            diff    = -diff;
-        }
-
-        diff = fold(diff, bits);
+    for (x = 0; x < w; x++) {
+        const int context = sc->line_context[x];
+        int diff          = sc->line_diff[x];
 
         if (ac != AC_GOLOMB_RICE) {
             if (pass1) {
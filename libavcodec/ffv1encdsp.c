@@ -0,0 +1,61 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+
+#include "ffv1.h"
+#include "ffv1encdsp.h"
+
+#define LINE_CONTEXTS(name, TYPE)                                             \
+static void name ## _c(int *context, int *diff, TYPE *const sample[3],       \
+                       const int16_t quant_table[][256], int w, int bits)   \
+{                                                                            \
+    const TYPE *src   = sample[0];                                           \
+    const TYPE *last  = sample[1];                                           \
+    const TYPE *last2 = sample[2];                                           \
+    const int five_inputs = quant_table[3][127] || quant_table[4][127];      \
+                                                                             \
+    for (int x = 0; x < w; x++) {                                            \
+        const int LT = last[x - 1];                                          \
+        const int T  = last[x];                                              \
+        const int RT = last[x + 1];                                          \
+        const int L  = src[x - 1];                                           \
+        int ctx = quant_table[0][(L  - LT) & MAX_QUANT_TABLE_MASK] +         \
+                  quant_table[1][(LT - T)  & MAX_QUANT_TABLE_MASK] +         \
+                  quant_table[2][(T  - RT) & MAX_QUANT_TABLE_MASK];          \
+        int d, sign;                                                         \
+                                                                             \
+        if (five_inputs)                                                     \
+            ctx += quant_table[3][(src[x - 2] - L) & MAX_QUANT_TABLE_MASK] + \
+                   quant_table[4][(last2[x] - T)   & MAX_QUANT_TABLE_MASK];  \
+                                                                             \
+        d    = src[x] - mid_pred(L, L + T - LT, T);                          \
+        sign = ctx >> 31;                                                    \
+        context[x] = (ctx ^ sign) - sign;                                    \
+        diff[x]    = fold((d ^ sign) - sign, bits);                          \
+    }                                                                        \
+}
+
+LINE_CONTEXTS(line_contexts,   int16_t)
+LINE_CONTEXTS(line_contexts32, int32_t)
+
+av_cold void ff_ffv1_encdsp_init(FFV1EncDSPContext *c)
+{
+    c->line_contexts   = line_contexts_c;
+    c->line_contexts32 = line_contexts32_c;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_FFV1ENCDSP_H
+#define AVCODEC_FFV1ENCDSP_H
+
+#include <stdint.h>
+
+typedef struct FFV1EncDSPContext {
+    /**
+     * Compute the context and the prediction residual of every sample of a
+     * line. For each x < w, context[x] is the absolute value of the context
+     * and diff[x] the median prediction residual, negated if the context is
+     * negative and folded to bits bits.
+     *
+     * @param context  output, w entries
+     * @param diff     output, w entries
+     * @param sample   current, previous and second previous line; each line
+     *                 is read from index -2 up to w
+     * @param quant_table the 5 quantisation tables of 256 entries, if the
+     *                 last two are zero only 3 context inputs are used
+     */
+    void (*line_contexts)(int *context, int *diff,
+                          int16_t *const sample[3],
+                          const int16_t quant_table[][256], int w, int bits);
+    void (*line_contexts32)(int *context, int *diff,
+                            int32_t *const sample[3],
+                            const int16_t quant_table[][256], int w, int bits);
+} FFV1EncDSPContext;
+
+void ff_ffv1_encdsp_init(FFV1EncDSPContext *c);
+
+#endif /* AVCODEC_FFV1ENCDSP_H */
@@ -120,7 +120,8 @@ typedef struct FlacEncodeContext {
     FlacFrame frame;
     CompressionOptions options;
     AVCodecContext *avctx;
-    LPCContext lpc_ctx;
+    LPCContext *lpc_ctx;    ///< one per slice thread
+    int nb_lpc_ctx;
     struct AVMD5 *md5ctx;
     uint8_t *md5_buffer;
     unsigned int md5_buffer_size;
@@ -272,7 +273,7 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
     int freq = avctx->sample_rate;
     int channels = avctx->ch_layout.nb_channels;
     FlacEncodeContext *s = avctx->priv_data;
-    int i, level, ret;
+    int i, level, ret, nb_threads;
     uint8_t *streaminfo;
 
     s->avctx = avctx;
@@ -464,8 +465,19 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
         }
     }
 
-    ret = ff_lpc_init(&s->lpc_ctx, avctx->frame_size,
-                      s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+    /* channels are analysed in parallel with slice threading, each thread
+     * needs its own LPC scratch buffers */
+    nb_threads = avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+    s->lpc_ctx = av_calloc(nb_threads, sizeof(*s->lpc_ctx));
+    if (!s->lpc_ctx)
+        return AVERROR(ENOMEM);
+    s->nb_lpc_ctx = nb_threads;
+    for (i = 0; i < s->nb_lpc_ctx; i++) {
+        ret = ff_lpc_init(&s->lpc_ctx[i], avctx->frame_size,
+                          s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+        if (ret < 0)
+            return ret;
+    }
 
     ff_bswapdsp_init(&s->bdsp);
     ff_flacencdsp_init(&s->flac_dsp);
@@ -950,7 +962,7 @@ static int lpc_encode_choose_datapath(FlacEncodeContext *s, int32_t bps,
     return subframe_count_exact(s, sub, 0);                 \
 }
 
-static int encode_residual_ch(FlacEncodeContext *s, int ch)
+static int encode_residual_ch(FlacEncodeContext *s, int ch, LPCContext *lpc_ctx)
 {
     int i, n;
     int min_order, max_order, opt_order, omethod;
@@ -1048,7 +1060,7 @@ static int encode_residual_ch(FlacEncodeContext *s, int ch)
         for (i = 0; i < n; i++)
             smp[i] = smp_33bps[i] >> 1;
 
-    opt_order = ff_lpc_calc_coefs(&s->lpc_ctx, smp, n, min_order, max_order,
+    opt_order = ff_lpc_calc_coefs(lpc_ctx, smp, n, min_order, max_order,
                                   s->options.lpc_coeff_precision, coefs, shift, s->options.lpc_type,
                                   s->options.lpc_passes, omethod,
                                   MIN_LPC_SHIFT, MAX_LPC_SHIFT, 0);
@@ -1170,6 +1182,17 @@ static int encode_residual_ch(FlacEncodeContext *s, int ch)
 }
 
 
+static int encode_residual_ch_thread(AVCodecContext *avctx, void *arg,
+                                     int ch, int threadnr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    int *bits = arg;
+
+    bits[ch] = encode_residual_ch(s, ch, &s->lpc_ctx[threadnr]);
+    return 0;
+}
+
+
 static int count_frame_header(FlacEncodeContext *s)
 {
     av_unused uint8_t tmp;
@@ -1213,8 +1236,17 @@ static int encode_frame(FlacEncodeContext *s)
 
     count = count_frame_header(s);
 
-    for (ch = 0; ch < s->channels; ch++)
-        count += encode_residual_ch(s, ch);
+    if (s->nb_lpc_ctx > 1 && s->channels > 1) {
+        int bits[FLAC_MAX_CHANNELS];
+
+        s->avctx->execute2(s->avctx, encode_residual_ch_thread, bits, NULL,
+                           s->channels);
+        for (ch = 0; ch < s->channels; ch++)
+            count += bits[ch];
+    } else {
+        for (ch = 0; ch < s->channels; ch++)
+            count += encode_residual_ch(s, ch, &s->lpc_ctx[0]);
+    }
 
     count += (8 - (count & 7)) & 7; // byte alignment
     count += 16;                    // CRC-16
@@ -1705,7 +1737,9 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 
     av_freep(&s->md5ctx);
     av_freep(&s->md5_buffer);
-    ff_lpc_end(&s->lpc_ctx);
+    for (int i = 0; i < s->nb_lpc_ctx; i++)
+        ff_lpc_end(&s->lpc_ctx[i]);
+    av_freep(&s->lpc_ctx);
     return 0;
 }
 
@@ -1755,6 +1789,7 @@ const FFCodec ff_flac_encoder = {
     .p.id           = AV_CODEC_ID_FLAC,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
                       AV_CODEC_CAP_SMALL_LAST_FRAME |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(FlacEncodeContext),
     .init           = flac_encode_init,
@@ -24,6 +24,7 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/cpu.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
@@ -35,6 +36,8 @@
 #include "pthread_internal.h"
 
 #define MAX_THREADS 64
+/* Warn when GOP threading may hold more than this many bytes of input frames */
+#define GOP_THREADS_WARN_BUFFERED (1LL << 30)
 /* There can be as many as MAX_THREADS + 1 outstanding tasks.
  * An additional + 1 is needed so that one can distinguish
  * the case of zero and MAX_THREADS + 1 outstanding tasks modulo
@@ -49,6 +52,31 @@ typedef struct{
     int       got_packet;
 } Task;
 
+/**
+ * A closed GOP encoded as a unit by a worker in GOP threading mode.
+ */
+typedef struct GOPTask {
+    AVFrame  **frames;
+    AVPacket **pkts;
+    int        nb_frames;
+    int        nb_pkts;
+    int        next_pkt;    ///< next packet to return to the user
+    int64_t    gop_number;
+    int64_t    frame_number;
+    int64_t    vbv_fullness;
+    int64_t    total_bits;
+    int        return_code;
+    int        finished;
+    /**
+     * Set once the packets of the GOP have been added to the rate control
+     * model; the model state after this GOP is then stored in the end_ fields.
+     */
+    int        accounted;
+    int64_t    end_frames;
+    int64_t    end_bits;
+    double     end_vbv_fullness;
+} GOPTask;
+
 typedef struct{
     AVCodecContext *parent_avctx;
 
@@ -58,6 +86,32 @@ typedef struct{
     unsigned pthread_init_cnt;
     unsigned max_tasks;
     Task tasks[BUFFER_SIZE];
+
+    /**
+     * GOP threading: every task is a closed GOP of up to gop_size frames,
+     * 0 when frame threading is used.
+     */
+    int gop_size;
+    GOPTask gop_tasks[BUFFER_SIZE];
+    int64_t frame_number;       ///< number of frames submitted in GOPs
+    int64_t nb_gops;            ///< number of GOPs submitted
+    int64_t nb_accounted_gops;  ///< number of GOPs added to the rate control model
+    int64_t accounted_frames;   ///< number of packets of these GOPs
+    int64_t accounted_bits;     ///< size of the packets of these GOPs
+    double bits_per_frame;      ///< target average frame size, 0 without a bit rate
+    int reorder;                ///< B-frames are used, so dts can differ from pts
+    int64_t last_reordered_pts;
+    int has_reordered_pts;
+    /**
+     * Shared VBV model: fullness in bits after the accounted GOPs. A new GOP
+     * starts from the state after the GOP submitted thread_count GOPs before
+     * it, so the output does not depend on how fast the workers are.
+     */
+    int vbv;
+    double vbv_fullness;
+    double initial_vbv_fullness;
+    double vbv_size;
+    double vbv_max_rate;
     pthread_mutex_t finished_task_mutex; /* Guards tasks[i].finished */
     pthread_cond_t finished_task_cond;
 
@@ -65,6 +119,9 @@ typedef struct{
     unsigned task_index;
     unsigned finished_task_index;
 
+    int nb_running;             ///< workers encoding a task, guarded by task_fifo_mutex
+    atomic_int nb_threads;      ///< number of workers allowed to run at once
+
     pthread_t worker[MAX_THREADS];
     atomic_int exit;
 } ThreadContext;
@@ -75,6 +132,46 @@ DEFINE_OFFSET_ARRAY(ThreadContext, thread_ctx, pthread_init_cnt,
                     (OFF(task_fifo_cond),  OFF(finished_task_cond)));
 #undef OFF
 
+/**
+ * Encode all frames of a GOP and drain the encoder, so that the next GOP
+ * starts from an empty state.
+ */
+static int encode_gop(AVCodecContext *avctx, GOPTask *task)
+{
+    avctx->internal->gop_start.frame_number = task->frame_number;
+    avctx->internal->gop_start.vbv_fullness = task->vbv_fullness;
+    avctx->internal->gop_start.total_bits   = task->total_bits;
+
+    for (int i = 0; i <= task->nb_frames; i++) {
+        AVFrame *frame = i < task->nb_frames ? task->frames[i] : NULL;
+
+        do {
+            int got_packet = 0;
+            int ret = ff_encode_encode_cb(avctx, task->pkts[task->nb_pkts],
+                                          frame, &got_packet);
+            if (ret < 0)
+                return ret;
+            if (!got_packet)
+                break;
+            task->nb_pkts++;
+        } while (!frame);
+    }
+
+    return 0;
+}
+
+/**
+ * Let another worker take a queued task, in case the number of running
+ * workers was limited by ff_frame_thread_encoder_set_count().
+ */
+static void task_done(ThreadContext *c)
+{
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    c->nb_running--;
+    pthread_cond_signal(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+}
+
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
@@ -87,7 +184,8 @@ static void * attribute_align_arg worker(void *v){
         unsigned task_index;
 
         pthread_mutex_lock(&c->task_fifo_mutex);
-        while (c->next_task_index == c->task_index || atomic_load(&c->exit)) {
+        while (c->next_task_index == c->task_index ||
+               c->nb_running >= atomic_load(&c->nb_threads) || atomic_load(&c->exit)) {
             if (atomic_load(&c->exit)) {
                 pthread_mutex_unlock(&c->task_fifo_mutex);
                 goto end;
@@ -96,16 +194,31 @@ static void * attribute_align_arg worker(void *v){
         }
         task_index         = c->next_task_index;
         c->next_task_index = (c->next_task_index + 1) % c->max_tasks;
+        c->nb_running++;
         pthread_mutex_unlock(&c->task_fifo_mutex);
         /* The main thread ensures that any two outstanding tasks have
          * different indices, ergo each worker thread owns its element
          * of c->tasks with the exception of finished, which is shared
          * with the main thread and guarded by finished_task_mutex. */
+        if (c->gop_size) {
+            GOPTask *gop = &c->gop_tasks[task_index];
+
+            ret = encode_gop(avctx, gop);
+            task_done(c);
+            pthread_mutex_lock(&c->finished_task_mutex);
+            gop->return_code = ret;
+            gop->finished    = 1;
+            pthread_cond_signal(&c->finished_task_cond);
+            pthread_mutex_unlock(&c->finished_task_mutex);
+            continue;
+        }
+
         task  = &c->tasks[task_index];
         frame = task->indata;
         pkt   = task->outdata;
 
         ret = ff_encode_encode_cb(avctx, pkt, frame, &task->got_packet);
+        task_done(c);
         pthread_mutex_lock(&c->finished_task_mutex);
         task->return_code = ret;
         task->finished    = 1;
@@ -123,12 +236,30 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
     ThreadContext *c;
     AVCodecContext *thread_avctx = NULL;
     AVCodecParameters *par = NULL;
+    int gop_threads = 0;
     int ret;
 
-    if(   !(avctx->thread_type & FF_THREAD_FRAME)
-       || !(avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS))
+    if (!(avctx->thread_type & FF_THREAD_FRAME))
         return 0;
 
+    /* Encoders with inter frames can still encode closed GOPs in parallel,
+     * if they support it. */
+    if (!(avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)) {
+        int64_t tmp;
+
+        if (!avctx->codec->priv_class ||
+            av_opt_get_int(avctx->priv_data, "gop_threads", 0, &tmp) < 0 || !tmp)
+            return 0;
+        if (avctx->gop_size <= 0 ||
+            avctx->flags & (AV_CODEC_FLAG_PASS1 | AV_CODEC_FLAG_PASS2)) {
+            av_log(avctx, AV_LOG_WARNING,
+                   "GOP threading needs a positive GOP size and single pass "
+                   "encoding, disabling it\n");
+            return 0;
+        }
+        gop_threads = 1;
+    }
+
     if(   !avctx->thread_count
        && avctx->codec_id == AV_CODEC_ID_MJPEG
        && !(avctx->flags & AV_CODEC_FLAG_QSCALE)) {
@@ -186,13 +317,64 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
     if (ret < 0)
         goto fail;
     atomic_init(&c->exit, 0);
+    atomic_init(&c->nb_threads, avctx->thread_count);
 
     c->max_tasks = avctx->thread_count + 2;
-    for (unsigned j = 0; j < c->max_tasks; j++) {
-        if (!(c->tasks[j].indata  = av_frame_alloc()) ||
-            !(c->tasks[j].outdata = av_packet_alloc())) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
+    if (gop_threads) {
+        /* one GOP per busy thread plus the one being filled */
+        int64_t max_frames = (int64_t)(avctx->thread_count + 1) * avctx->gop_size;
+        int frame_size = av_image_get_buffer_size(avctx->pix_fmt, avctx->width,
+                                                  avctx->height, 1);
+
+        av_log(avctx, frame_size > 0 &&
+               max_frames * frame_size > GOP_THREADS_WARN_BUFFERED ?
+               AV_LOG_WARNING : AV_LOG_VERBOSE,
+               "GOP threading buffers up to %"PRId64" input frames (%d threads, "
+               "GOP size %d), use fewer threads or a smaller GOP to reduce "
+               "memory use and latency\n",
+               max_frames, avctx->thread_count, avctx->gop_size);
+
+        c->gop_size = avctx->gop_size;
+        c->reorder  = avctx->max_b_frames > 0;
+        for (unsigned j = 0; j < c->max_tasks; j++) {
+            GOPTask *task = &c->gop_tasks[j];
+
+            task->frames = av_calloc(c->gop_size,     sizeof(*task->frames));
+            task->pkts   = av_calloc(c->gop_size + 1, sizeof(*task->pkts));
+            if (!task->frames || !task->pkts) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+            for (int k = 0; k <= c->gop_size; k++) {
+                if ((k < c->gop_size && !(task->frames[k] = av_frame_alloc())) ||
+                    !(task->pkts[k] = av_packet_alloc())) {
+                    ret = AVERROR(ENOMEM);
+                    goto fail;
+                }
+            }
+        }
+
+        AVRational fps = avctx->framerate.num > 0 && avctx->framerate.den > 0 ?
+                         avctx->framerate : av_inv_q(avctx->time_base);
+
+        if (avctx->bit_rate > 0)
+            c->bits_per_frame = avctx->bit_rate / av_q2d(fps);
+        if (avctx->rc_buffer_size > 0 && avctx->rc_max_rate > 0) {
+            c->vbv          = 1;
+            c->vbv_size     = avctx->rc_buffer_size;
+            c->vbv_max_rate = avctx->rc_max_rate / av_q2d(fps);
+            c->vbv_fullness = avctx->rc_initial_buffer_occupancy ?
+                              avctx->rc_initial_buffer_occupancy :
+                              avctx->rc_buffer_size * 3 / 4;
+            c->initial_vbv_fullness = c->vbv_fullness;
+        }
+    } else {
+        for (unsigned j = 0; j < c->max_tasks; j++) {
+            if (!(c->tasks[j].indata  = av_frame_alloc()) ||
+                !(c->tasks[j].outdata = av_packet_alloc())) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
         }
     }
 
@@ -290,14 +472,177 @@ av_cold void ff_frame_thread_encoder_free(AVCodecContext *avctx)
     }
 
     for (unsigned i = 0; i < c->max_tasks; i++) {
+        GOPTask *task = &c->gop_tasks[i];
+
         av_frame_free(&c->tasks[i].indata);
         av_packet_free(&c->tasks[i].outdata);
+
+        for (int j = 0; j <= c->gop_size; j++) {
+            if (task->frames && j < c->gop_size)
+                av_frame_free(&task->frames[j]);
+            if (task->pkts)
+                av_packet_free(&task->pkts[j]);
+        }
+        av_freep(&task->frames);
+        av_freep(&task->pkts);
     }
 
     ff_pthread_free(c, thread_ctx_offsets);
     av_freep(&avctx->internal->frame_thread_encoder);
 }
 
+/**
+ * Add the packets of all GOPs up to and including gop_number to the rate
+ * control model, in stream order, waiting for them to be encoded.
+ */
+static void account_gops(ThreadContext *c, int64_t gop_number)
+{
+    while (c->nb_accounted_gops <= gop_number) {
+        GOPTask *task = &c->gop_tasks[c->nb_accounted_gops % c->max_tasks];
+
+        pthread_mutex_lock(&c->finished_task_mutex);
+        while (!task->finished)
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        pthread_mutex_unlock(&c->finished_task_mutex);
+
+        if (task->return_code >= 0) {
+            for (int i = 0; i < task->nb_pkts; i++) {
+                int64_t bits = 8LL * task->pkts[i]->size;
+
+                c->accounted_frames++;
+                c->accounted_bits += bits;
+                if (c->vbv) {
+                    c->vbv_fullness = FFMAX(c->vbv_fullness - bits, 0);
+                    c->vbv_fullness = FFMIN(c->vbv_fullness + c->vbv_max_rate,
+                                            c->vbv_size);
+                }
+            }
+        }
+        task->end_frames       = c->accounted_frames;
+        task->end_bits         = c->accounted_bits;
+        task->end_vbv_fullness = c->vbv_fullness;
+        task->accounted        = 1;
+        c->nb_accounted_gops++;
+    }
+}
+
+static void submit_gop(ThreadContext *c)
+{
+    GOPTask *task = &c->gop_tasks[c->task_index];
+    /* The GOPs submitted after this one are not waited for and are assumed
+     * to hit their target rate, i.e. to leave the buffer as full as it is. */
+    int64_t base_gop    = c->nb_gops - (c->max_tasks - 2);
+    int64_t base_frames = 0, base_bits = 0;
+    double base_vbv_fullness = c->initial_vbv_fullness;
+
+    if (base_gop >= 0 && (c->vbv || c->bits_per_frame > 0)) {
+        const GOPTask *base = &c->gop_tasks[base_gop % c->max_tasks];
+
+        account_gops(c, base_gop);
+        base_frames       = base->end_frames;
+        base_bits         = base->end_bits;
+        base_vbv_fullness = base->end_vbv_fullness;
+    }
+
+    task->vbv_fullness = c->vbv ? (int64_t)base_vbv_fullness : -1;
+    task->total_bits   = c->bits_per_frame > 0 ?
+                         base_bits + (int64_t)((c->frame_number - base_frames) *
+                                               c->bits_per_frame) : -1;
+    task->gop_number   = c->nb_gops++;
+    task->frame_number = c->frame_number;
+    task->accounted    = 0;
+    c->frame_number   += task->nb_frames;
+
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    c->task_index = (c->task_index + 1) % c->max_tasks;
+    pthread_cond_signal(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+}
+
+static enum AVPictureType packet_pict_type(const AVPacket *pkt)
+{
+    size_t size;
+    const uint8_t *sd = av_packet_get_side_data(pkt, AV_PKT_DATA_QUALITY_STATS, &size);
+
+    return sd && size >= 5 ? sd[4] : AV_PICTURE_TYPE_NONE;
+}
+
+static void output_gop_packet(ThreadContext *c, GOPTask *task, AVPacket *pkt)
+{
+    av_packet_move_ref(pkt, task->pkts[task->next_pkt++]);
+
+    /* The workers only know the reordering delay within their own GOPs.
+     * As in ff_mpv_encode_picture(), with B-frames every non-B picture is
+     * decoded when the previous non-B picture is presented. */
+    if (c->reorder && packet_pict_type(pkt) != AV_PICTURE_TYPE_B) {
+        if (c->has_reordered_pts)
+            pkt->dts = c->last_reordered_pts;
+        c->last_reordered_pts = pkt->pts;
+        c->has_reordered_pts  = 1;
+    }
+}
+
+static int gop_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
+                            AVFrame *frame, int *got_packet_ptr)
+{
+    ThreadContext *c = avctx->internal->frame_thread_encoder;
+
+    if (frame) {
+        GOPTask *task = &c->gop_tasks[c->task_index];
+        AVFrame *dst  = task->frames[task->nb_frames++];
+
+        av_frame_move_ref(dst, frame);
+        if (task->nb_frames == 1)
+            dst->pict_type = AV_PICTURE_TYPE_I;
+        if (task->nb_frames == c->gop_size)
+            submit_gop(c);
+    } else if (c->gop_tasks[c->task_index].nb_frames) {
+        submit_gop(c);
+    }
+
+    /* The access to task_index in the following code is ok,
+     * because it is only ever changed by the main thread. */
+    while (c->task_index != c->finished_task_index) {
+        GOPTask *outtask = &c->gop_tasks[c->finished_task_index];
+        int ret;
+
+        pthread_mutex_lock(&c->finished_task_mutex);
+        if (frame && !outtask->finished &&
+            (c->task_index - c->finished_task_index + c->max_tasks) % c->max_tasks < atomic_load(&c->nb_threads)) {
+            pthread_mutex_unlock(&c->finished_task_mutex);
+            return 0;
+        }
+        while (!outtask->finished)
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        pthread_mutex_unlock(&c->finished_task_mutex);
+
+        /* The packet sizes must be known before they are handed out. */
+        account_gops(c, outtask->gop_number);
+
+        ret = outtask->return_code;
+        if (ret >= 0 && outtask->next_pkt < outtask->nb_pkts) {
+            output_gop_packet(c, outtask, pkt);
+            *got_packet_ptr = 1;
+            if (outtask->next_pkt < outtask->nb_pkts)
+                return 0;
+        }
+
+        /* We own the task completely once it is finished. */
+        for (int i = outtask->next_pkt; i < outtask->nb_pkts; i++)
+            av_packet_unref(outtask->pkts[i]);
+        for (int i = 0; i < outtask->nb_frames; i++)
+            av_frame_unref(outtask->frames[i]);
+        outtask->nb_frames = outtask->nb_pkts = outtask->next_pkt = 0;
+        outtask->finished  = 0;
+        c->finished_task_index = (c->finished_task_index + 1) % c->max_tasks;
+
+        if (ret < 0 || *got_packet_ptr)
+            return ret;
+    }
+
+    return 0;
+}
+
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                                  AVFrame *frame, int *got_packet_ptr)
 {
@@ -306,6 +651,9 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
 
     av_assert1(!*got_packet_ptr);
 
+    if (c->gop_size)
+        return gop_encode_frame(avctx, pkt, frame, got_packet_ptr);
+
     if(frame){
         av_frame_move_ref(c->tasks[c->task_index].indata, frame);
 
@@ -321,7 +669,7 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
      * because it is only ever changed by the main thread. */
     if (c->task_index == c->finished_task_index ||
         (frame && !outtask->finished &&
-         (c->task_index - c->finished_task_index + c->max_tasks) % c->max_tasks <= avctx->thread_count)) {
+         (c->task_index - c->finished_task_index + c->max_tasks) % c->max_tasks <= atomic_load(&c->nb_threads))) {
             pthread_mutex_unlock(&c->finished_task_mutex);
             return 0;
         }
@@ -338,3 +686,17 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
 
     return outtask->return_code;
 }
+
+int ff_frame_thread_encoder_set_count(AVCodecContext *avctx, int thread_count)
+{
+    ThreadContext *c = avctx->internal->frame_thread_encoder;
+
+    thread_count = av_clip(thread_count, 1, avctx->thread_count);
+
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    atomic_store(&c->nb_threads, thread_count);
+    pthread_cond_broadcast(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+
+    return thread_count;
+}
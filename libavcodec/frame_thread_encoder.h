@@ -32,4 +32,11 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx);
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                                  AVFrame *frame, int *got_packet_ptr);
 
+/**
+ * Limit the number of frames encoded at once to thread_count, clipped to
+ * the number of threads started at init.
+ * @return the number of threads that will be used
+ */
+int ff_frame_thread_encoder_set_count(AVCodecContext *avctx, int thread_count);
+
 #endif /* AVCODEC_FRAME_THREAD_ENCODER_H */
@@ -100,6 +100,7 @@ static int ftr_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_ftr_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_FTR),
     .priv_data_size = sizeof(FTRParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = ftr_parse,
     .close          = ff_parse_close,
 };
@@ -56,6 +56,7 @@ static int g723_1_parse(AVCodecParserContext *s1, AVCodecContext *avctx,
 const FFCodecParser ff_g723_1_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_G723_1),
     .priv_data_size = sizeof(G723_1ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = g723_1_parse,
     .close          = ff_parse_close,
 };
@@ -18,6 +18,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#define _DEFAULT_SOURCE
+
+#include "config.h"
+
+#if HAVE_MADVISE
+#include <sys/mman.h>
+#endif
+
 #include <stdint.h>
 
 #include "libavutil/avassert.h"
@@ -41,6 +49,14 @@ typedef struct FramePool {
      */
     AVBufferPool *pools[4];
 
+    /**
+     * Offsets of the planes in the pools[0] buffers when all the planes of a
+     * video frame share one allocation (AV_CODEC_FLAG2_CONTIGUOUS_FRAMES),
+     * 0 for every plane otherwise.
+     */
+    size_t offset[4];
+    int contiguous;
+
     /*
      * Pool parameters
      */
@@ -62,6 +78,49 @@ static void frame_pool_free(AVRefStructOpaque unused, void *obj)
         av_buffer_pool_uninit(&pool->pools[i]);
 }
 
+#define HUGE_PAGE_SIZE (2 << 20)
+/* Below this, the part of a buffer that can be backed by huge pages is too
+ * small a fraction of it to be worth the alignment. */
+#define HUGE_PAGE_MIN_BUFFER_SIZE (8 * HUGE_PAGE_SIZE)
+
+static void huge_page_buffer_free(void *opaque, uint8_t *data)
+{
+    av_free(opaque);
+}
+
+/**
+ * Allocate a contiguous frame buffer. Large buffers are aligned to the huge
+ * page size and, where supported, advised to be backed by transparent huge
+ * pages, which saves TLB misses when walking all the planes of large frames.
+ * Only the start is aligned, the size is not rounded up; the advice covers
+ * the whole huge pages inside the buffer.
+ */
+static AVBufferRef *contiguous_buffer_alloc(size_t size)
+{
+    AVBufferRef *buf;
+    uint8_t *mem, *data;
+
+    if (!HAVE_MADVISE || size < HUGE_PAGE_MIN_BUFFER_SIZE ||
+        size > SIZE_MAX - HUGE_PAGE_SIZE)
+        return CONFIG_MEMORY_POISONING ? av_buffer_alloc(size) :
+                                         av_buffer_allocz(size);
+
+    mem = av_malloc(size + HUGE_PAGE_SIZE - 1);
+    if (!mem)
+        return NULL;
+    data = (uint8_t *)FFALIGN((uintptr_t)mem, HUGE_PAGE_SIZE);
+#if HAVE_MADVISE && defined(MADV_HUGEPAGE)
+    madvise(data, size & ~(size_t)(HUGE_PAGE_SIZE - 1), MADV_HUGEPAGE);
+#endif
+    if (!CONFIG_MEMORY_POISONING)
+        memset(data, 0, size);
+
+    buf = av_buffer_create(data, size, huge_page_buffer_free, mem, 0);
+    if (!buf)
+        av_free(mem);
+    return buf;
+}
+
 static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
 {
     FramePool *pool = avctx->internal->pool;
@@ -88,7 +147,7 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
         int h = frame->height;
         int unaligned;
         ptrdiff_t linesize1[4];
-        size_t size[4];
+        size_t size[4], total = 0;
 
         avcodec_align_dimensions2(avctx, &w, &h, pool->stride_align);
 
@@ -112,21 +171,38 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
         if (ret < 0)
             goto fail;
 
+        /* With AV_CODEC_FLAG2_CONTIGUOUS_FRAMES, each plane keeps the padding
+         * of a separately allocated one and starts at the alignment of the
+         * buffer itself. */
+        pool->contiguous = !!(avctx->flags2 & AV_CODEC_FLAG2_CONTIGUOUS_FRAMES);
         for (i = 0; i < 4; i++) {
             pool->linesize[i] = linesize[i];
             if (size[i]) {
-                if (size[i] > INT_MAX - (16 + STRIDE_ALIGN - 1)) {
+                if (size[i] > INT_MAX - (16 + STRIDE_ALIGN - 1) - total) {
                     ret = AVERROR(EINVAL);
                     goto fail;
                 }
-                pool->pools[i] = av_buffer_pool_init(size[i] + 16 + STRIDE_ALIGN - 1,
-                                                     CONFIG_MEMORY_POISONING ?
-                                                        NULL :
-                                                        av_buffer_allocz);
-                if (!pool->pools[i]) {
-                    ret = AVERROR(ENOMEM);
-                    goto fail;
+                if (pool->contiguous) {
+                    pool->offset[i] = total;
+                    total += FFALIGN(size[i] + 16 + STRIDE_ALIGN - 1, STRIDE_ALIGN);
+                } else {
+                    pool->pools[i] = av_buffer_pool_init(size[i] + 16 + STRIDE_ALIGN - 1,
+                                                         CONFIG_MEMORY_POISONING ?
+                                                            NULL :
+                                                            av_buffer_allocz);
+                    if (!pool->pools[i]) {
+                        ret = AVERROR(ENOMEM);
+                        goto fail;
+                    }
                 }
+                pool->planes = i + 1;
+            }
+        }
+        if (pool->contiguous) {
+            pool->pools[0] = av_buffer_pool_init(total, contiguous_buffer_alloc);
+            if (!pool->pools[0]) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
             }
         }
         pool->format = frame->format;
@@ -227,9 +303,20 @@ static int video_get_buffer(AVCodecContext *s, AVFrame *pic)
     memset(pic->data, 0, sizeof(pic->data));
     pic->extended_data = pic->data;
 
-    for (i = 0; i < 4 && pool->pools[i]; i++) {
+    if (pool->contiguous) {
+        pic->buf[0] = av_buffer_pool_get(pool->pools[0]);
+        if (!pic->buf[0])
+            goto fail;
+    }
+
+    for (i = 0; i < pool->planes; i++) {
         pic->linesize[i] = pool->linesize[i];
 
+        if (pool->contiguous) {
+            pic->data[i] = pic->buf[0]->data + pool->offset[i];
+            continue;
+        }
+
         pic->buf[i] = av_buffer_pool_get(pool->pools[i]);
         if (!pic->buf[i])
             goto fail;
@@ -204,6 +204,7 @@ static int gif_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_gif_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_GIF),
     .priv_data_size = sizeof(GIFParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = gif_parse,
     .close          = ff_parse_close,
 };
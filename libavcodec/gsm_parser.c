@@ -87,6 +87,7 @@ static int gsm_parse(AVCodecParserContext *s1, AVCodecContext *avctx,
 const FFCodecParser ff_gsm_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_GSM, AV_CODEC_ID_GSM_MS),
     .priv_data_size = sizeof(GSMParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = gsm_parse,
     .close          = ff_parse_close,
 };
@@ -91,6 +91,7 @@ static int h263_parse(AVCodecParserContext *s,
 const FFCodecParser ff_h263_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_H263),
     .priv_data_size = sizeof(ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = h263_parse,
     .close          = ff_parse_close,
 };
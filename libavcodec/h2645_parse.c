@@ -34,6 +34,34 @@
 
 #include "hevc/hevc.h"
 
+/**
+ * Return the offset of the first pair of zero bytes in buf, or size if
+ * there is none. Every start code and emulation prevention sequence begins
+ * with such a pair, and in slice data they are rare, so the search skips
+ * over most of the payload a word at a time. buf[size] and the padding
+ * after it may be read.
+ */
+static av_always_inline int find_zero_pair(const uint8_t *buf, int size)
+{
+    int i = 0;
+
+#if HAVE_FAST_UNALIGNED && HAVE_FAST_64BIT
+    /* Byte k of y is zero iff bytes k and k + 1 of x are, for k < 7;
+     * byte 7 is forced non-zero and rechecked as byte 0 of the next word. */
+    while (i < size) {
+        uint64_t x = AV_RL64(buf + i);
+        uint64_t y = x | (x >> 8) | 0xFF00000000000000ULL;
+        if ((y - 0x0101010101010101ULL) & ~y & 0x8080808080808080ULL)
+            break;
+        i += 7;
+    }
+#endif
+    for (; i < size; i++)
+        if (!buf[i] && !buf[i + 1])
+            break;
+    return FFMIN(i, size);
+}
+
 int ff_h2645_extract_rbsp(const uint8_t *src, int length,
                           H2645RBSP *rbsp, H2645NAL *nal, int small_padding)
 {
@@ -41,51 +69,16 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
     uint8_t *dst;
 
     nal->skipped_bytes = 0;
-#define STARTCODE_TEST                                                  \
-        if (i + 2 < length && src[i + 1] == 0 &&                        \
-           (src[i + 2] == 3 || src[i + 2] == 1)) {                      \
-            if (src[i + 2] == 1) {                                      \
-                /* startcode, so we must be past the end */             \
-                length = i;                                             \
-            }                                                           \
-            break;                                                      \
+    for (i = 0; i + 1 < length; i++) {
+        i += find_zero_pair(src + i, length - 1 - i);
+        if (i + 2 < length && (src[i + 2] == 3 || src[i + 2] == 1)) {
+            if (src[i + 2] == 1) {
+                /* startcode, so we must be past the end */
+                length = i;
+            }
+            break;
         }
-#if HAVE_FAST_UNALIGNED
-#define FIND_FIRST_ZERO                                                 \
-        if (i > 0 && !src[i])                                           \
-            i--;                                                        \
-        while (src[i])                                                  \
-            i++
-#if HAVE_FAST_64BIT
-    for (i = 0; i + 1 < length; i += 9) {
-        if (!((~AV_RN64(src + i) &
-               (AV_RN64(src + i) - 0x0100010001000101ULL)) &
-              0x8000800080008080ULL))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 7;
-    }
-#else
-    for (i = 0; i + 1 < length; i += 5) {
-        if (!((~AV_RN32(src + i) &
-               (AV_RN32(src + i) - 0x01000101U)) &
-              0x80008080U))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 3;
     }
-#endif /* HAVE_FAST_64BIT */
-#else
-    for (i = 0; i + 1 < length; i += 2) {
-        if (src[i])
-            continue;
-        if (i > 0 && src[i - 1] == 0)
-            i--;
-        STARTCODE_TEST;
-    }
-#endif /* HAVE_FAST_UNALIGNED */
 
     if (i >= length - 1 && small_padding) { // no escaped 0
         nal->data     =
@@ -101,36 +94,38 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
     memcpy(dst, src, i);
     si = di = i;
     while (si + 2 < length) {
-        // remove escapes (very rare 1:2^22)
-        if (src[si + 2] > 3) {
-            dst[di++] = src[si++];
-            dst[di++] = src[si++];
-        } else if (src[si] == 0 && src[si + 1] == 0 && src[si + 2] != 0) {
-            if (src[si + 2] == 3) { // escape
-                dst[di++] = 0;
-                dst[di++] = 0;
-                si       += 3;
-
-                if (nal->skipped_bytes_pos) {
-                    nal->skipped_bytes++;
-                    if (nal->skipped_bytes_pos_size < nal->skipped_bytes) {
-                        nal->skipped_bytes_pos_size *= 2;
-                        av_assert0(nal->skipped_bytes_pos_size >= nal->skipped_bytes);
-                        av_reallocp_array(&nal->skipped_bytes_pos,
-                                nal->skipped_bytes_pos_size,
-                                sizeof(*nal->skipped_bytes_pos));
-                        if (!nal->skipped_bytes_pos) {
-                            nal->skipped_bytes_pos_size = 0;
-                            return AVERROR(ENOMEM);
-                        }
+        // copy up to the next 00 00 xx, escapes are very rare (1:2^22)
+        int n = find_zero_pair(src + si, length - 2 - si);
+        memcpy(dst + di, src + si, n);
+        si += n;
+        di += n;
+        if (si + 2 >= length)
+            break;
+
+        if (src[si + 2] == 3) { // escape
+            dst[di++] = 0;
+            dst[di++] = 0;
+            si       += 3;
+
+            if (nal->skipped_bytes_pos) {
+                nal->skipped_bytes++;
+                if (nal->skipped_bytes_pos_size < nal->skipped_bytes) {
+                    nal->skipped_bytes_pos_size *= 2;
+                    av_assert0(nal->skipped_bytes_pos_size >= nal->skipped_bytes);
+                    av_reallocp_array(&nal->skipped_bytes_pos,
+                            nal->skipped_bytes_pos_size,
+                            sizeof(*nal->skipped_bytes_pos));
+                    if (!nal->skipped_bytes_pos) {
+                        nal->skipped_bytes_pos_size = 0;
+                        return AVERROR(ENOMEM);
                     }
-                    if (nal->skipped_bytes_pos)
-                        nal->skipped_bytes_pos[nal->skipped_bytes-1] = di - 1;
                 }
-                continue;
-            } else // next start code
-                goto nsc;
-        }
+                if (nal->skipped_bytes_pos)
+                    nal->skipped_bytes_pos[nal->skipped_bytes-1] = di - 1;
+            }
+            continue;
+        } else if (src[si + 2] < 3 && src[si + 2]) // next start code
+            goto nsc;
 
         dst[di++] = src[si++];
     }
@@ -464,13 +459,14 @@ static int h264_parse_nal_header(H2645NAL *nal, void *logctx)
 
 static int find_next_start_code(const uint8_t *buf, const uint8_t *next_avc)
 {
-    int i = 0;
+    int i = 0, size = next_avc - buf - 3;
 
-    if (buf + 3 >= next_avc)
+    if (size <= 0)
         return next_avc - buf;
 
-    while (buf + i + 3 < next_avc) {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1)
+    while (i < size) {
+        i += find_zero_pair(buf + i, size - i);
+        if (i >= size || buf[i + 2] == 1)
             break;
         i++;
     }
@@ -674,7 +674,7 @@ static av_cold void h264_close(AVCodecParserContext *s)
     H264ParseContext *p = s->priv_data;
     ParseContext *pc = &p->pc;
 
-    av_freep(&pc->buffer);
+    av_buffer_unref(&pc->buf);
 
     ff_h264_sei_uninit(&p->sei);
     ff_h264_ps_uninit(&p->ps);
@@ -693,6 +693,7 @@ static av_cold int init(AVCodecParserContext *s)
 const FFCodecParser ff_h264_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_H264),
     .priv_data_size = sizeof(H264ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = init,
     .parse          = h264_parse,
     .close          = h264_close,
@@ -2442,7 +2442,15 @@ static int fill_filter_caches(const H264Context *h, H264SliceContext *sl, int mb
     return 0;
 }
 
-static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x, int end_x)
+/**
+ * Filter MBs [start_x, end_x) of the MB row sl->mb_y.
+ *
+ * @param backup save the unfiltered bottom borders needed by intra prediction
+ * @param filter apply the deblocking filter
+ */
+static av_always_inline void filter_mb_row(const H264Context *h, H264SliceContext *sl,
+                                           int start_x, int end_x,
+                                           int backup, int filter)
 {
     uint8_t *dest_y, *dest_cb, *dest_cr;
     int linesize, uvlinesize, mb_x, mb_y;
@@ -2451,9 +2459,6 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
     const int pixel_shift    = h->pixel_shift;
     const int block_h        = 16 >> h->chroma_y_shift;
 
-    if (h->postpone_filter)
-        return;
-
     if (sl->deblocking_filter) {
         for (mb_x = start_x; mb_x < end_x; mb_x++)
             for (mb_y = end_mb_y - FRAME_MBAFF(h); mb_y <= end_mb_y; mb_y++) {
@@ -2489,9 +2494,10 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
                     linesize   = sl->mb_linesize   = sl->linesize;
                     uvlinesize = sl->mb_uvlinesize = sl->uvlinesize;
                 }
-                backup_mb_border(h, sl, dest_y, dest_cb, dest_cr, linesize,
-                                 uvlinesize, 0);
-                if (fill_filter_caches(h, sl, mb_type))
+                if (backup)
+                    backup_mb_border(h, sl, dest_y, dest_cb, dest_cr, linesize,
+                                     uvlinesize, 0);
+                if (!filter || fill_filter_caches(h, sl, mb_type))
                     continue;
                 sl->chroma_qp[0] = get_chroma_qp(h->ps.pps, 0, h->cur_pic.qscale_table[mb_xy]);
                 sl->chroma_qp[1] = get_chroma_qp(h->ps.pps, 1, h->cur_pic.qscale_table[mb_xy]);
@@ -2512,6 +2518,22 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
     sl->chroma_qp[1] = get_chroma_qp(h->ps.pps, 1, sl->qscale);
 }
 
+static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x, int end_x)
+{
+    if (h->postpone_filter)
+        return;
+
+    if (sl->deblock_progress) {
+        /* only keep the unfiltered borders for intra prediction here,
+         * the filter itself is applied by deblock_rows() */
+        sl->deblock_end_y = sl->mb_y;
+        sl->deblock_end_x = end_x;
+        filter_mb_row(h, sl, start_x, end_x, 1, 0);
+    } else {
+        filter_mb_row(h, sl, start_x, end_x, 1, 1);
+    }
+}
+
 static void predict_field_decoding_flag(const H264Context *h, H264SliceContext *sl)
 {
     const int mb_xy = sl->mb_x + sl->mb_y * h->mb_stride;
@@ -2668,6 +2690,8 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 sl->mb_x = lf_x_start = 0;
                 decode_finish_row(h, sl);
                 ++sl->mb_y;
+                if (sl->deblock_progress)
+                    ff_thread_progress_report(sl->deblock_progress, sl->mb_y);
                 if (FIELD_OR_MBAFF_PICTURE(h)) {
                     ++sl->mb_y;
                     if (FRAME_MBAFF(h) && sl->mb_y < h->mb_height)
@@ -2725,6 +2749,8 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 sl->mb_x = lf_x_start = 0;
                 decode_finish_row(h, sl);
                 ++sl->mb_y;
+                if (sl->deblock_progress)
+                    ff_thread_progress_report(sl->deblock_progress, sl->mb_y);
                 if (FIELD_OR_MBAFF_PICTURE(h)) {
                     ++sl->mb_y;
                     if (FRAME_MBAFF(h) && sl->mb_y < h->mb_height)
@@ -2775,6 +2801,63 @@ finish:
     return 0;
 }
 
+/**
+ * Apply the loop filter to the MB rows reconstructed by decode_slice() on
+ * slice context 0. Intra prediction of row y + 1 temporarily swaps the
+ * unfiltered bottom line of row y back into the picture, so row y is only
+ * filtered once row y + 1 has been fully reconstructed.
+ */
+static void deblock_rows(H264Context *h, H264SliceContext *sl)
+{
+    const H264SliceContext *src = &h->slice_ctx[0];
+    int mb_y;
+
+    for (mb_y = 0; mb_y < h->mb_height; mb_y++) {
+        ff_thread_progress_await(&h->deblock_progress, mb_y + 2);
+        if (atomic_load_explicit(&h->deblock_done, memory_order_acquire))
+            break;
+        sl->mb_y = mb_y;
+        filter_mb_row(h, sl, 0, h->mb_width, 0, 1);
+    }
+
+    /* decode_slice() has returned, catch up with its last loop_filter() call */
+    for (; mb_y <= src->deblock_end_y; mb_y++) {
+        sl->mb_y = mb_y;
+        filter_mb_row(h, sl, 0, mb_y < src->deblock_end_y ? h->mb_width :
+                                src->deblock_end_x, 0, 1);
+    }
+}
+
+static int decode_slice_deblock_rows(AVCodecContext *avctx, void *arg,
+                                     int jobnr, int threadnr)
+{
+    H264Context *h = arg;
+    H264SliceContext *sl = &h->slice_ctx[jobnr];
+    int ret;
+
+    if (jobnr) {
+        deblock_rows(h, sl);
+        return 0;
+    }
+
+    ret = decode_slice(avctx, sl);
+    atomic_store_explicit(&h->deblock_done, 1, memory_order_release);
+    ff_thread_progress_report(&h->deblock_progress, INT_MAX);
+    return ret;
+}
+
+/**
+ * Check whether the loop filter of a slice covering the whole picture can
+ * run on a second slice thread while the slice is being decoded.
+ */
+static int can_deblock_rows(const H264Context *h, const H264SliceContext *sl)
+{
+    return h->nb_slice_ctx > 1 && sl->deblocking_filter &&
+           !sl->mb_x && !sl->mb_y && h->mb_height > 2 &&
+           h->picture_structure == PICT_FRAME && !FRAME_MBAFF(h) &&
+           !h->avctx->draw_horiz_band;
+}
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2800,7 +2883,38 @@ int ff_h264_execute_decode_slices(H264Context *h)
         h->slice_ctx[0].next_slice_idx = h->mb_width * h->mb_height;
         h->postpone_filter = 0;
 
-        ret = decode_slice(avctx, &h->slice_ctx[0]);
+        if (can_deblock_rows(h, &h->slice_ctx[0])) {
+            const H264SliceContext *sl0 = &h->slice_ctx[0];
+            int rets[2];
+
+            /* copy what the loop filter needs to a second slice context */
+            sl = &h->slice_ctx[1];
+            sl->slice_num             = sl0->slice_num;
+            sl->slice_type            = sl0->slice_type;
+            sl->list_count            = sl0->list_count;
+            sl->qscale                = sl0->qscale;
+            sl->qp_thresh             = sl0->qp_thresh;
+            sl->deblocking_filter     = sl0->deblocking_filter;
+            sl->slice_alpha_c0_offset = sl0->slice_alpha_c0_offset;
+            sl->slice_beta_offset     = sl0->slice_beta_offset;
+            sl->linesize              = h->cur_pic_ptr->f->linesize[0];
+            sl->uvlinesize            = h->cur_pic_ptr->f->linesize[1];
+            sl->mb_mbaff              =
+            sl->mb_field_decoding_flag = 0;
+            sl->deblock_end_y         = -1;
+
+            h->slice_ctx[0].deblock_progress = &h->deblock_progress;
+            h->slice_ctx[0].deblock_end_y    = -1;
+            ff_thread_progress_reset(&h->deblock_progress);
+            atomic_store_explicit(&h->deblock_done, 0, memory_order_relaxed);
+
+            avctx->execute2(avctx, decode_slice_deblock_rows, h, rets, 2);
+
+            h->slice_ctx[0].deblock_progress = NULL;
+            ret = rets[0];
+        } else {
+            ret = decode_slice(avctx, &h->slice_ctx[0]);
+        }
         h->mb_y = h->slice_ctx[0].mb_y;
         if (ret < 0)
             goto finish;
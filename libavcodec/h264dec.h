@@ -28,6 +28,8 @@
 #ifndef AVCODEC_H264DEC_H
 #define AVCODEC_H264DEC_H
 
+#include <stdatomic.h>
+
 #include "libavutil/mem_internal.h"
 
 #include "cabac.h"
@@ -42,6 +44,7 @@
 #include "h264qpel.h"
 #include "mpegutils.h"
 #include "threadframe.h"
+#include "threadprogress.h"
 #include "videodsp.h"
 
 #define H264_MAX_PICTURE_COUNT 36
@@ -287,6 +290,14 @@ typedef struct H264SliceContext {
     int edge_emu_buffer_allocated;
     int top_borders_allocated[2];
 
+    /**
+     * Set if the loop filter of this slice is run by another slice thread,
+     * which is notified of the number of fully reconstructed MB rows.
+     */
+    ThreadProgress *deblock_progress;
+    int deblock_end_y;  ///< MB row of the last loop_filter() call
+    int deblock_end_x;  ///< end MB of the last loop_filter() call
+
     /**
      * non zero coeff count cache.
      * is 64 if not available.
@@ -372,6 +383,11 @@ typedef struct H264Context {
      */
     int postpone_filter;
 
+    /* Single-slice pictures with slice threading: the loop filter runs one MB
+     * row behind reconstruction on a second slice thread. */
+    ThreadProgress deblock_progress;
+    atomic_int deblock_done;
+
     /*
      * Set to 1 when the current picture is IDR, 0 otherwise.
      */
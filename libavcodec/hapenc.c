@@ -46,6 +46,11 @@
 
 #define HAP_MAX_CHUNKS 64
 
+/* The format option takes the section type values of the texture formats.
+ * RGTC1 (0x01) is below the others, so the option uses a value just above
+ * the range instead, which keeps it contiguous. */
+#define HAP_OPT_FMT_RGTC1 (HAP_FMT_YCOCGDXT5 + 1)
+
 enum HapHeaderLength {
     /* Short header: four bytes with a 24 bit size value */
     HAP_HDR_SHORT = 4,
@@ -88,46 +93,64 @@ static void hap_write_section_header(PutByteContext *pbc,
     }
 }
 
+static int hap_compress_chunk(AVCodecContext *avctx, void *arg,
+                              int chunk_nb, int threadnr)
+{
+    HapContext *ctx = avctx->priv_data;
+    HapChunk *chunk = &ctx->chunks[chunk_nb];
+    uint8_t *chunk_src, *chunk_dst;
+    int ret;
+
+    /* Each chunk gets room for its worst case; the chunks are packed
+     * together once all of them are compressed. */
+    chunk->compressed_offset = chunk_nb * ctx->max_snappy;
+    chunk->uncompressed_size = ctx->tex_size / ctx->chunk_count;
+    chunk->uncompressed_offset = chunk_nb * chunk->uncompressed_size;
+    chunk->compressed_size = ctx->max_snappy;
+    chunk_src = ctx->tex_buf + chunk->uncompressed_offset;
+    chunk_dst = (uint8_t *)arg + chunk->compressed_offset;
+
+    /* Compress with snappy too, write directly on packet buffer. */
+    ret = snappy_compress(chunk_src, chunk->uncompressed_size,
+                          chunk_dst, &chunk->compressed_size);
+    if (ret != SNAPPY_OK) {
+        av_log(avctx, AV_LOG_ERROR, "Snappy compress error.\n");
+        return AVERROR_BUG;
+    }
+
+    /* If there is no gain from snappy, just use the raw texture. */
+    if (chunk->compressed_size >= chunk->uncompressed_size) {
+        av_log(avctx, AV_LOG_VERBOSE,
+               "Snappy buffer bigger than uncompressed (%zu >= %zu bytes).\n",
+               chunk->compressed_size, chunk->uncompressed_size);
+        memcpy(chunk_dst, chunk_src, chunk->uncompressed_size);
+        chunk->compressor = HAP_COMP_NONE;
+        chunk->compressed_size = chunk->uncompressed_size;
+    } else {
+        chunk->compressor = HAP_COMP_SNAPPY;
+    }
+
+    return 0;
+}
+
 static int hap_compress_frame(AVCodecContext *avctx, uint8_t *dst)
 {
     HapContext *ctx = avctx->priv_data;
+    int rets[HAP_MAX_CHUNKS];
     int i, final_size = 0;
 
+    avctx->execute2(avctx, hap_compress_chunk, dst, rets, ctx->chunk_count);
+
     for (i = 0; i < ctx->chunk_count; i++) {
         HapChunk *chunk = &ctx->chunks[i];
-        uint8_t *chunk_src, *chunk_dst;
-        int ret;
-
-        if (i == 0) {
-            chunk->compressed_offset = 0;
-        } else {
-            chunk->compressed_offset = ctx->chunks[i-1].compressed_offset
-                                       + ctx->chunks[i-1].compressed_size;
-        }
-        chunk->uncompressed_size = ctx->tex_size / ctx->chunk_count;
-        chunk->uncompressed_offset = i * chunk->uncompressed_size;
-        chunk->compressed_size = ctx->max_snappy;
-        chunk_src = ctx->tex_buf + chunk->uncompressed_offset;
-        chunk_dst = dst + chunk->compressed_offset;
-
-        /* Compress with snappy too, write directly on packet buffer. */
-        ret = snappy_compress(chunk_src, chunk->uncompressed_size,
-                              chunk_dst, &chunk->compressed_size);
-        if (ret != SNAPPY_OK) {
-            av_log(avctx, AV_LOG_ERROR, "Snappy compress error.\n");
-            return AVERROR_BUG;
-        }
 
-        /* If there is no gain from snappy, just use the raw texture. */
-        if (chunk->compressed_size >= chunk->uncompressed_size) {
-            av_log(avctx, AV_LOG_VERBOSE,
-                   "Snappy buffer bigger than uncompressed (%zu >= %zu bytes).\n",
-                   chunk->compressed_size, chunk->uncompressed_size);
-            memcpy(chunk_dst, chunk_src, chunk->uncompressed_size);
-            chunk->compressor = HAP_COMP_NONE;
-            chunk->compressed_size = chunk->uncompressed_size;
-        } else {
-            chunk->compressor = HAP_COMP_SNAPPY;
+        if (rets[i] < 0)
+            return rets[i];
+
+        if (final_size != chunk->compressed_offset) {
+            memmove(dst + final_size, dst + chunk->compressed_offset,
+                    chunk->compressed_size);
+            chunk->compressed_offset = final_size;
         }
 
         final_size += chunk->compressed_size;
@@ -252,6 +275,9 @@ static av_cold int hap_init(AVCodecContext *avctx)
 
     ff_texturedspenc_init(&dxtc);
 
+    if (ctx->opt_tex_fmt == HAP_OPT_FMT_RGTC1)
+        ctx->opt_tex_fmt = HAP_FMT_RGTC1;
+
     switch (ctx->opt_tex_fmt) {
     case HAP_FMT_RGBDXT1:
         ctx->enc.tex_ratio = 8;
@@ -271,6 +297,12 @@ static av_cold int hap_init(AVCodecContext *avctx)
         avctx->bits_per_coded_sample = 24;
         ctx->enc.tex_funct = dxtc.dxt5ys_block;
         break;
+    case HAP_FMT_RGTC1:
+        ctx->enc.tex_ratio = 8;
+        avctx->codec_tag = MKTAG('H', 'a', 'p', 'A');
+        avctx->bits_per_coded_sample = 8;
+        ctx->enc.tex_funct = dxtc.rgtc1u_alpha_block;
+        break;
     default:
         av_log(avctx, AV_LOG_ERROR, "Invalid format %02X\n", ctx->opt_tex_fmt);
         return AVERROR_INVALIDDATA;
@@ -331,10 +363,11 @@ static av_cold int hap_close(AVCodecContext *avctx)
 #define OFFSET(x) offsetof(HapContext, x)
 #define FLAGS     AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_ENCODING_PARAM
 static const AVOption options[] = {
-    { "format", NULL, OFFSET(opt_tex_fmt), AV_OPT_TYPE_INT, { .i64 = HAP_FMT_RGBDXT1 }, HAP_FMT_RGBDXT1, HAP_FMT_YCOCGDXT5, FLAGS, .unit = "format" },
+    { "format", NULL, OFFSET(opt_tex_fmt), AV_OPT_TYPE_INT, { .i64 = HAP_FMT_RGBDXT1 }, HAP_FMT_RGBDXT1, HAP_OPT_FMT_RGTC1, FLAGS, .unit = "format" },
         { "hap",       "Hap 1 (DXT1 textures)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_FMT_RGBDXT1   }, 0, 0, FLAGS, .unit = "format" },
         { "hap_alpha", "Hap Alpha (DXT5 textures)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_FMT_RGBADXT5  }, 0, 0, FLAGS, .unit = "format" },
         { "hap_q",     "Hap Q (DXT5-YCoCg textures)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_FMT_YCOCGDXT5 }, 0, 0, FLAGS, .unit = "format" },
+        { "hap_alpha_only", "Hap Alpha-only (RGTC1 textures of the alpha channel)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_OPT_FMT_RGTC1 }, 0, 0, FLAGS, .unit = "format" },
     { "chunks", "chunk count", OFFSET(opt_chunk_count), AV_OPT_TYPE_INT, {.i64 = 1 }, 1, HAP_MAX_CHUNKS, FLAGS, },
     { "compressor", "second-stage compressor", OFFSET(opt_compressor), AV_OPT_TYPE_INT, { .i64 = HAP_COMP_SNAPPY }, HAP_COMP_NONE, HAP_COMP_SNAPPY, FLAGS, .unit = "compressor" },
         { "none",       "None", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_COMP_NONE }, 0, 0, FLAGS, .unit = "compressor" },
@@ -75,6 +75,7 @@ static int hdr_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_hdr_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_RADIANCE_HDR),
     .priv_data_size = sizeof(HDRParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = hdr_parse,
     .close          = ff_parse_close,
 };
@@ -45,6 +45,7 @@
 #include "libavcodec/cabac_functions.h"
 #include "libavcodec/codec_internal.h"
 #include "libavcodec/decode.h"
+#include "libavcodec/executor.h"
 #include "libavcodec/golomb.h"
 #include "libavcodec/h274.h"
 #include "libavcodec/hwaccel_internal.h"
@@ -2902,6 +2903,68 @@ error:
     return ret;
 }
 
+typedef struct HEVCWPPTask {
+    FFTask task;
+    int    row;
+    int    ret;
+} HEVCWPPTask;
+
+static int hls_wpp_task_run(FFTask *t, void *local_context, void *user_data)
+{
+    HEVCWPPTask *task    = (HEVCWPPTask *)t;
+    HEVCContext *s       = user_data;
+    HEVCLocalContext *lc = local_context;
+    const unsigned nb_rows = s->sh.num_entry_point_offsets + 1;
+
+    lc->logctx             = s->avctx;
+    lc->parent             = s;
+    lc->common_cabac_state = &s->cabac;
+    lc->first_qp_group     = task->row ? 1 : s->local_ctx[0].first_qp_group;
+    lc->qp_y               = s->local_ctx[0].qp_y;
+    lc->tu.cu_qp_offset_cb = 0;
+    lc->tu.cu_qp_offset_cr = 0;
+
+    task->ret = hls_decode_entry_wpp(s->avctx, lc, task->row, 0);
+
+    /* the extra progress entry past the rows signals completion */
+    if (atomic_fetch_sub(&s->wpp_tasks_left, 1) == 1)
+        ff_thread_progress_report(&s->wpp_progress[nb_rows], 1);
+
+    return 0;
+}
+
+/**
+ * Decode the rows on the executor. The tasks are queued in row order with a
+ * single priority, so a row is only started after all rows above it have
+ * been started and the progress waits in hls_decode_entry_wpp() cannot
+ * deadlock.
+ */
+static int hls_wpp_execute(HEVCContext *s, int *ret, unsigned nb_rows)
+{
+    if (nb_rows > s->nb_wpp_tasks) {
+        HEVCWPPTask *tmp = av_realloc_array(s->wpp_tasks, nb_rows, sizeof(*tmp));
+        if (!tmp)
+            return AVERROR(ENOMEM);
+        s->wpp_tasks    = tmp;
+        s->nb_wpp_tasks = nb_rows;
+    }
+
+    atomic_store(&s->wpp_tasks_left, nb_rows);
+    for (unsigned i = 0; i < nb_rows; i++) {
+        HEVCWPPTask *task = &s->wpp_tasks[i];
+
+        memset(task, 0, sizeof(*task));
+        task->row = i;
+        ff_executor_execute(s->wpp_executor, &task->task);
+    }
+    ff_thread_progress_await(&s->wpp_progress[nb_rows], 1);
+
+    for (unsigned i = 0; i < nb_rows; i++)
+        ret[i] = s->wpp_tasks[i].ret;
+
+    return 0;
+}
+
 static int wpp_progress_init(HEVCContext *s, unsigned count)
 {
     if (s->nb_wpp_progress < count) {
@@ -3012,7 +3075,7 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
     }
 
     atomic_store(&s->wpp_err, 0);
-    res = wpp_progress_init(s, s->sh.num_entry_point_offsets + 1);
+    res = wpp_progress_init(s, s->sh.num_entry_point_offsets + 1 + !!s->wpp_executor);
     if (res < 0)
         return res;
 
@@ -3020,8 +3083,16 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
     if (!ret)
         return AVERROR(ENOMEM);
 
-    if (pps->entropy_coding_sync_enabled_flag)
-        s->avctx->execute2(s->avctx, hls_decode_entry_wpp, s->local_ctx, ret, s->sh.num_entry_point_offsets + 1);
+    if (pps->entropy_coding_sync_enabled_flag) {
+        if (s->wpp_executor) {
+            res = hls_wpp_execute(s, ret, s->sh.num_entry_point_offsets + 1);
+            if (res < 0) {
+                av_free(ret);
+                return res;
+            }
+        } else
+            s->avctx->execute2(s->avctx, hls_decode_entry_wpp, s->local_ctx, ret, s->sh.num_entry_point_offsets + 1);
+    }
 
     for (int i = 0; i <= s->sh.num_entry_point_offsets; i++)
         res += ret[i];
@@ -3076,7 +3147,7 @@ static int decode_slice_data(HEVCContext *s, const HEVCLayerContext *l,
     s->local_ctx[0].tu.cu_qp_offset_cb = 0;
     s->local_ctx[0].tu.cu_qp_offset_cr = 0;
 
-    if (s->avctx->active_thread_type == FF_THREAD_SLICE  &&
+    if ((s->avctx->active_thread_type == FF_THREAD_SLICE || s->wpp_executor) &&
         s->sh.num_entry_point_offsets > 0                &&
         pps->num_tile_rows == 1 && pps->num_tile_columns == 1)
         return hls_slice_data_wpp(s, nal);
@@ -3975,6 +4046,9 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
 
     ff_hevc_ps_uninit(&s->ps);
 
+    ff_executor_free(&s->wpp_executor);
+    av_freep(&s->wpp_tasks);
+
     for (int i = 0; i < s->nb_wpp_progress; i++)
         ff_thread_progress_destroy(&s->wpp_progress[i]);
     av_freep(&s->wpp_progress);
@@ -4190,6 +4264,24 @@ static av_cold int hevc_decode_init(AVCodecContext *avctx)
     s->eos = 1;
 
     atomic_init(&s->wpp_err, 0);
+    atomic_init(&s->wpp_tasks_left, 0);
+
+    if (HAVE_THREADS && s->wpp_threads > 1 &&
+        avctx->active_thread_type & FF_THREAD_FRAME) {
+        const FFTaskCallbacks callbacks = {
+            s,
+            sizeof(HEVCLocalContext),
+            1,
+            hls_wpp_task_run,
+        };
+        s->wpp_executor = ff_executor_alloc(&callbacks, s->wpp_threads);
+        if (!s->wpp_executor)
+            return AVERROR(ENOMEM);
+    } else if (s->wpp_threads && !avctx->internal->is_copy) {
+        av_log(avctx, AV_LOG_WARNING, "wpp_threads is ignored: %s\n",
+               s->wpp_threads == 1 ? "it needs at least 2 threads" :
+                                     "it needs frame threading");
+    }
 
     if (!avctx->internal->is_copy) {
         const AVPacketSideData *sd;
@@ -4234,6 +4326,8 @@ static const AVOption options[] = {
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
     { "strict-displaywin", "strictly apply default display window size", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
+    { "wpp_threads", "Number of threads decoding WPP rows inside each frame thread",
+        OFFSET(wpp_threads), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, PAR },
     { "view_ids", "Array of view IDs that should be decoded and output; a single -1 to decode all views",
         .offset = OFFSET(view_ids), .type = AV_OPT_TYPE_INT | AV_OPT_TYPE_FLAG_ARRAY,
         .min = -1, .max = INT_MAX, .flags = PAR },
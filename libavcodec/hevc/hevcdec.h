@@ -548,6 +548,16 @@ typedef struct HEVCContext {
 
     atomic_int wpp_err;
 
+    /**
+     * Executor decoding the WPP rows of a frame when frame threading is
+     * active, so that frame and row parallelism can be combined.
+     */
+    struct FFExecutor  *wpp_executor;
+    struct HEVCWPPTask *wpp_tasks;
+    unsigned         nb_wpp_tasks;
+    atomic_int          wpp_tasks_left;
+    int                 wpp_threads;    ///< AVOption
+
     const uint8_t *data;
 
     H2645Packet pkt;
@@ -351,12 +351,13 @@ static void hevc_parser_close(AVCodecParserContext *s)
     ff_h2645_packet_uninit(&ctx->pkt);
     ff_hevc_reset_sei(&ctx->sei);
 
-    av_freep(&ctx->pc.buffer);
+    av_buffer_unref(&ctx->pc.buf);
 }
 
 const FFCodecParser ff_hevc_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_HEVC),
     .priv_data_size = sizeof(HEVCParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = hevc_parse,
     .close          = hevc_parser_close,
 };
@@ -72,6 +72,12 @@ typedef struct AVCodecInternal {
 
     void *thread_ctx;
 
+    /**
+     * State of the asynchronous decoding worker, if AVCodecContext.async_depth
+     * is used.
+     */
+    struct DecodeAsyncContext *decode_async;
+
     /**
      * This packet is used to hold the packet given to decoders
      * implementing the .decode API; it is unused by the generic
@@ -97,6 +103,17 @@ typedef struct AVCodecInternal {
 
     void *frame_thread_encoder;
 
+    /**
+     * Encoding with GOP threading: set by the frame thread encoder before the
+     * first frame of each GOP, so that the encoder can continue the state of
+     * the stream. Reset by the encoder once applied.
+     */
+    struct {
+        int64_t frame_number; ///< index of the first frame of the GOP, negative if unset
+        int64_t vbv_fullness; ///< VBV fullness in bits at the start of the GOP, negative without a VBV model
+        int64_t total_bits;   ///< estimated size of the stream before the GOP in bits, negative without a bit rate
+    } gop_start;
+
     /**
      * The input frame is stored here for encoders implementing the simple
      * encode API.
@@ -168,6 +185,23 @@ int avpriv_h264_has_num_reorder_frames(AVCodecContext *avctx);
 
 int avpriv_codec_get_cap_skip_frame_fill_param(const AVCodec *codec);
 
+/**
+ * Get a reference to the buffer holding the frame last returned by
+ * av_parser_parse2(), for parsers assembling frames with ff_combine_frame().
+ * The parser gives up the buffer and continues with a new one, so the
+ * frame can be used without copying it. If the buffer is much larger than
+ * the frame, the frame is copied into a buffer of its own instead. In both
+ * cases the frame is followed by AV_INPUT_BUFFER_PADDING_SIZE zero bytes.
+ *
+ * @param data the frame returned by av_parser_parse2(), set to the copy if
+ *             the frame was copied
+ * @param size the size of the frame
+ * @return a reference to a buffer containing *data, or NULL if the frame is
+ *         not in the parser's buffer or on allocation failure
+ */
+AVBufferRef *avpriv_parser_get_buffer(AVCodecParserContext *s,
+                                      uint8_t **data, int size);
+
 /**
  * Check AVFrame for S12M timecode side data and allocate and fill TC SEI message with timecode info
  *
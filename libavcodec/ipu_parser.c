@@ -73,6 +73,7 @@ static int ipu_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_ipu_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_IPU),
     .priv_data_size = sizeof(IPUParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = ipu_parse,
     .close          = ff_parse_close,
 };
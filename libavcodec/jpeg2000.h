@@ -133,6 +133,11 @@ typedef struct Jpeg2000T1Context {
     uint16_t flags[6156];
     MqcState mqc;
     int stride;
+    /* HT block decoder scratch buffers, reused across codeblocks */
+    int32_t *ht_sample_buf;
+    uint8_t *ht_block_states;
+    unsigned ht_sample_buf_size;
+    unsigned ht_block_states_size;
 } Jpeg2000T1Context;
 
 typedef struct Jpeg2000TgtNode {
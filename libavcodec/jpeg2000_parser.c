@@ -215,6 +215,7 @@ static int jpeg2000_parse(AVCodecParserContext *s,
 const FFCodecParser ff_jpeg2000_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_JPEG2000),
     .priv_data_size = sizeof(JPEG2000ParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = jpeg2000_parse,
     .close          = ff_parse_close,
 };
@@ -2118,29 +2118,26 @@ static int decode_cblk(const Jpeg2000DecoderContext *s, Jpeg2000CodingStyle *cod
  * see ISO/IEC 15444-1:2002 A.6.1 */
 
 /* Float dequantization of a codeblock.*/
-static void dequantization_float(int x, int y, Jpeg2000Cblk *cblk,
+static void dequantization_float(const Jpeg2000DecoderContext *s,
+                                 int x, int y, Jpeg2000Cblk *cblk,
                                  Jpeg2000Component *comp,
                                  Jpeg2000T1Context *t1, Jpeg2000Band *band, const int M_b)
 {
-    int i, j;
+    int j;
     int w = cblk->coord[0][1] - cblk->coord[0][0];
     const int downshift = 31 - M_b;
     float fscale = band->f_stepsize;
     fscale /= (float)(1LL << downshift);
     for (j = 0; j < (cblk->coord[1][1] - cblk->coord[1][0]); ++j) {
         float *datap = &comp->f_data[(comp->coord[0][1] - comp->coord[0][0]) * (y + j) + x];
-        int *src = t1->data + j*t1->stride;
-        for (i = 0; i < w; ++i) {
-            int val = src[i];
-            if (val < 0) // Convert sign-magnitude to two's complement
-                val = -(val & INT32_MAX);
-            datap[i] = (float)val * fscale;
-        }
+        const int *src = t1->data + j*t1->stride;
+        s->dsp.dequant_float(datap, src, fscale, w);
     }
 }
 
 /* Integer dequantization of a codeblock.*/
-static void dequantization_int(int x, int y, Jpeg2000Cblk *cblk,
+static void dequantization_int(const Jpeg2000DecoderContext *s,
+                               int x, int y, Jpeg2000Cblk *cblk,
                                Jpeg2000Component *comp,
                                Jpeg2000T1Context *t1, Jpeg2000Band *band, const int M_b)
 {
@@ -2151,14 +2148,7 @@ static void dequantization_int(int x, int y, Jpeg2000Cblk *cblk,
         int32_t *datap = &comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * (y + j) + x];
         int *src = t1->data + j*t1->stride;
         if (band->i_stepsize == 32768) {
-            for (i = 0; i < w; ++i) {
-                int val = src[i];
-                if (val < 0)  // Convert sign-magnitude to two's complement
-                    val = -((val & INT32_MAX) >> downshift);
-                else
-                    val >>= downshift;
-                datap[i] = val;
-            }
+            s->dsp.dequant_int(datap, src, downshift, w);
         } else {
             // This should be VERY uncommon
             for (i = 0; i < w; ++i) {
@@ -2236,7 +2226,12 @@ static inline int tile_codeblocks(const Jpeg2000DecoderContext *s, Jpeg2000Tile
 {
     Jpeg2000T1Context t1;
 
-    int compno, reslevelno, bandno;
+    int compno, reslevelno, bandno, ret;
+
+    t1.ht_sample_buf        = NULL;
+    t1.ht_block_states      = NULL;
+    t1.ht_sample_buf_size   = 0;
+    t1.ht_block_states_size = 0;
 
     /* Loop on tile components */
     for (compno = 0; compno < s->ncomponents; compno++) {
@@ -2268,7 +2263,8 @@ static inline int tile_codeblocks(const Jpeg2000DecoderContext *s, Jpeg2000Tile
 
                 if (M_b > 31) {
                     avpriv_request_sample(s->avctx, "M_b (%d) > 31", M_b);
-                    return AVERROR_PATCHWELCOME;
+                    ret = AVERROR_PATCHWELCOME;
+                    goto end;
                 }
 
                 nb_precincts = rlevel->num_precincts_x * rlevel->num_precincts_y;
@@ -2280,7 +2276,7 @@ static inline int tile_codeblocks(const Jpeg2000DecoderContext *s, Jpeg2000Tile
                     for (cblkno = 0;
                          cblkno < prec->nb_codeblocks_width * prec->nb_codeblocks_height;
                          cblkno++) {
-                        int x, y, ret;
+                        int x, y;
 
                         Jpeg2000Cblk *cblk = prec->cblk + cblkno;
 
@@ -2303,11 +2299,11 @@ static inline int tile_codeblocks(const Jpeg2000DecoderContext *s, Jpeg2000Tile
                         y = cblk->coord[1][0] - band->coord[1][0];
 
                         if (codsty->transform == FF_DWT97)
-                            dequantization_float(x, y, cblk, comp, &t1, band, M_b);
+                            dequantization_float(s, x, y, cblk, comp, &t1, band, M_b);
                         else if (codsty->transform == FF_DWT97_INT)
                             dequantization_int_97(x, y, cblk, comp, &t1, band, M_b);
                         else
-                            dequantization_int(x, y, cblk, comp, &t1, band, M_b);
+                            dequantization_int(s, x, y, cblk, comp, &t1, band, M_b);
                    } /* end cblk */
                 } /*end prec */
             } /* end band */
@@ -2318,7 +2314,11 @@ static inline int tile_codeblocks(const Jpeg2000DecoderContext *s, Jpeg2000Tile
             ff_dwt_decode(&comp->dwt, codsty->transform == FF_DWT97 ? (void*)comp->f_data : (void*)comp->i_data);
 
     } /*end comp */
-    return 0;
+    ret = 0;
+end:
+    av_freep(&t1.ht_sample_buf);
+    av_freep(&t1.ht_block_states);
+    return ret;
 }
 
 #define WRITE_FRAME(D, PIXEL)                                                                     \
@@ -90,11 +90,35 @@ static void rct_int(void *_src0, void *_src1, void *_src2, int csize)
     }
 }
 
+static void dequant_float(float *dst, const int32_t *src, float scale, int w)
+{
+    for (int i = 0; i < w; i++) {
+        int val = src[i];
+        if (val < 0) // Convert sign-magnitude to two's complement
+            val = -(val & INT32_MAX);
+        dst[i] = (float)val * scale;
+    }
+}
+
+static void dequant_int(int32_t *dst, const int32_t *src, int downshift, int w)
+{
+    for (int i = 0; i < w; i++) {
+        int val = src[i];
+        if (val < 0) // Convert sign-magnitude to two's complement
+            val = -((val & INT32_MAX) >> downshift);
+        else
+            val >>= downshift;
+        dst[i] = val;
+    }
+}
+
 av_cold void ff_jpeg2000dsp_init(Jpeg2000DSPContext *c)
 {
     c->mct_decode[FF_DWT97]     = ict_float;
     c->mct_decode[FF_DWT53]     = rct_int;
     c->mct_decode[FF_DWT97_INT] = ict_int;
+    c->dequant_float            = dequant_float;
+    c->dequant_int              = dequant_int;
 
 #if ARCH_RISCV
     ff_jpeg2000dsp_init_riscv(c);
@@ -28,6 +28,17 @@
 
 typedef struct Jpeg2000DSPContext {
     void (*mct_decode[FF_DWT_NB])(void *src0, void *src1, void *src2, int csize);
+    /**
+     * Convert a row of sign-magnitude codeblock samples to two's complement
+     * and scale them, as done for irreversible (9/7 float) bands.
+     */
+    void (*dequant_float)(float *dst, const int32_t *src, float scale, int w);
+    /**
+     * Convert a row of sign-magnitude codeblock samples to two's complement
+     * and shift their magnitude down by downshift bits (0..31), as done for
+     * reversible bands with unit step size.
+     */
+    void (*dequant_int)(int32_t *dst, const int32_t *src, int downshift, int w);
 } Jpeg2000DSPContext;
 
 extern const float ff_jpeg2000_f_ict_params[4];
@@ -1214,9 +1214,9 @@ ff_jpeg2000_decode_htj2k(const Jpeg2000DecoderContext *s, Jpeg2000CodingStyle *c
 
     int ret;
 
-    /* Temporary buffers */
-    int32_t *sample_buf = NULL;
-    uint8_t *block_states = NULL;
+    /* Temporary buffers, owned by t1 and reused across codeblocks */
+    int32_t *sample_buf;
+    uint8_t *block_states;
 
     int32_t n, val;             // Post-processing
     const uint32_t mask  = (int64_t)UINT32_MAX >> (M_b + 1); // bit mask for ROI detection
@@ -1302,13 +1302,19 @@ ff_jpeg2000_decode_htj2k(const Jpeg2000DecoderContext *s, Jpeg2000CodingStyle *c
 
     jpeg2000_init_mel_decoder(&mel_state);
 
-    sample_buf = av_calloc(quad_buf_width * quad_buf_height, sizeof(int32_t));
-    block_states = av_calloc(quad_buf_width * quad_buf_height, sizeof(uint8_t));
+    av_fast_malloc(&t1->ht_sample_buf, &t1->ht_sample_buf_size,
+                   quad_buf_width * quad_buf_height * sizeof(*sample_buf));
+    av_fast_malloc(&t1->ht_block_states, &t1->ht_block_states_size,
+                   quad_buf_width * quad_buf_height * sizeof(*block_states));
+    sample_buf   = t1->ht_sample_buf;
+    block_states = t1->ht_block_states;
 
     if (!sample_buf || !block_states) {
         ret = AVERROR(ENOMEM);
         goto free;
     }
+    memset(sample_buf,   0, quad_buf_width * quad_buf_height * sizeof(*sample_buf));
+    memset(block_states, 0, quad_buf_width * quad_buf_height * sizeof(*block_states));
     if ((ret = jpeg2000_decode_ht_cleanup_segment(s, cblk, t1, &mel_state, &mel, &vlc,
                                                   &mag_sgn, Dcup, Lcup, Pcup, pLSB, width,
                                                   height, quad_buf_width, sample_buf, block_states)) < 0) {
@@ -1325,6 +1331,14 @@ ff_jpeg2000_decode_htj2k(const Jpeg2000DecoderContext *s, Jpeg2000CodingStyle *c
                                        pLSB - 1, sample_buf, block_states);
 
     /* Reconstruct the sample values */
+    if (!roi_shift) {
+        /* Without ROI the samples are already in their final sign-magnitude
+         * form, so each row is a plain copy. */
+        for (int y = 0; y < height; y++)
+            memcpy(&t1->data[y * t1->stride], &sample_buf[y * quad_buf_width],
+                   width * sizeof(*sample_buf));
+        goto free;
+    }
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             int32_t sign;
@@ -1351,8 +1365,6 @@ ff_jpeg2000_decode_htj2k(const Jpeg2000DecoderContext *s, Jpeg2000CodingStyle *c
         }
     }
 free:
-    av_freep(&sample_buf);
-    av_freep(&block_states);
     return ret;
 }
 
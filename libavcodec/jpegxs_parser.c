@@ -240,12 +240,13 @@ static av_cold void jpegxsparse_close(AVCodecParserContext *s)
     JPEGXSParseContext *jpegxs = s->priv_data;
     ParseContext *pc = &jpegxs->pc;
 
-    av_freep(&pc->buffer);
+    av_buffer_unref(&pc->buf);
 }
 
 const FFCodecParser ff_jpegxs_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_JPEGXS),
     .priv_data_size = sizeof(JPEGXSParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = jpegxsvideo_parse,
     .close          = jpegxsparse_close,
 };
@@ -108,6 +108,7 @@ static int latm_parse(AVCodecParserContext *s1, AVCodecContext *avctx,
 const FFCodecParser ff_aac_latm_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_AAC_LATM),
     .priv_data_size = sizeof(LATMParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = latm_parse,
     .close          = ff_parse_close
 };
@@ -242,12 +242,13 @@ static void lcevc_parser_close(AVCodecParserContext *s)
 
     ff_h2645_packet_uninit(&ctx->pkt);
 
-    av_freep(&ctx->pc.buffer);
+    av_buffer_unref(&ctx->pc.buf);
 }
 
 const FFCodecParser ff_lcevc_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_LCEVC),
     .priv_data_size = sizeof(LCEVCParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = lcevc_parse,
     .close          = lcevc_parser_close,
 };
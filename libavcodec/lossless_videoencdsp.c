@@ -97,11 +97,21 @@ static void sub_left_predict_c(uint8_t *dst, const uint8_t *src,
     }
 }
 
+static int sum_abs_s8_c(const uint8_t *src, intptr_t w)
+{
+    int sum = 0;
+
+    for (intptr_t i = 0; i < w; i++)
+        sum += FFABS((int8_t)src[i]);
+    return sum;
+}
+
 av_cold void ff_llvidencdsp_init(LLVidEncDSPContext *c)
 {
     c->diff_bytes      = diff_bytes_c;
     c->sub_median_pred = sub_median_pred_c;
     c->sub_left_predict = sub_left_predict_c;
+    c->sum_abs_s8       = sum_abs_s8_c;
 
 #if ARCH_RISCV
     ff_llvidencdsp_init_riscv(c);
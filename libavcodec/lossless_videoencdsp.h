@@ -36,6 +36,12 @@ typedef struct LLVidEncDSPContext {
 
     void (*sub_left_predict)(uint8_t *dst, const uint8_t *src,
                           ptrdiff_t stride, ptrdiff_t width, int height);
+
+    /**
+     * Sum of the absolute values of w bytes interpreted as signed,
+     * a cheap estimate of how well a prediction residual compresses.
+     */
+    int (*sum_abs_s8)(const uint8_t *src /* align 1 */, intptr_t w);
 } LLVidEncDSPContext;
 
 void ff_llvidencdsp_init(LLVidEncDSPContext *c);
@@ -289,6 +289,20 @@ static inline int pix_abs8_c(MPVEncContext *unused, const uint8_t *pix1, const u
     return s;
 }
 
+static void sad16_x4_c(const uint8_t *blk1, const uint8_t *const blk2[4],
+                       ptrdiff_t stride, int h, int scores[4])
+{
+    for (int i = 0; i < 4; i++)
+        scores[i] = pix_abs16_c(NULL, blk1, blk2[i], stride, h);
+}
+
+static void sad8_x4_c(const uint8_t *blk1, const uint8_t *const blk2[4],
+                      ptrdiff_t stride, int h, int scores[4])
+{
+    for (int i = 0; i < 4; i++)
+        scores[i] = pix_abs8_c(NULL, blk1, blk2[i], stride, h);
+}
+
 static inline int pix_median_abs8_c(MPVEncContext *unused, const uint8_t *pix1, const uint8_t *pix2,
                              ptrdiff_t stride, int h)
 {
@@ -1011,6 +1025,9 @@ av_cold void ff_me_cmp_init(MECmpContext *c, AVCodecContext *avctx)
     c->median_sad[0] = pix_median_abs16_c;
     c->median_sad[1] = pix_median_abs8_c;
 
+    c->sad_x4[0] = sad16_x4_c;
+    c->sad_x4[1] = sad8_x4_c;
+
 #if ARCH_AARCH64
     ff_me_cmp_init_aarch64(c, avctx);
 #elif ARCH_ARM
@@ -1025,4 +1042,10 @@ av_cold void ff_me_cmp_init(MECmpContext *c, AVCodecContext *avctx)
     ff_me_cmp_init_mips(c, avctx);
 #endif
 
+    /* Without a native version, four calls of an optimised sad[] are faster
+     * than the C sad_x4. */
+    if (c->sad[0] != pix_abs16_c && c->sad_x4[0] == sad16_x4_c)
+        c->sad_x4[0] = NULL;
+    if (c->sad[1] != pix_abs8_c && c->sad_x4[1] == sad8_x4_c)
+        c->sad_x4[1] = NULL;
 }
@@ -47,6 +47,12 @@ typedef int (*me_cmp_func)(MPVEncContext *c,
                            const uint8_t *blk2 /* align 1 */, ptrdiff_t stride,
                            int h);
 
+/* Compare one block against four candidate blocks at once and store the
+ * four scores, as if me_cmp_func had been called for every candidate. */
+typedef void (*me_cmp_x4_func)(const uint8_t *blk1 /* align 1 */,
+                               const uint8_t *const blk2[4] /* align 1 */,
+                               ptrdiff_t stride, int h, int scores[4]);
+
 typedef struct MECmpContext {
     int (*sum_abs_dctelem)(const int16_t *block /* align 16 */);
 
@@ -67,6 +73,10 @@ typedef struct MECmpContext {
 
     me_cmp_func pix_abs[2][4];
     me_cmp_func median_sad[6];
+
+    /* [0] 16 wide, [1] 8 wide; NULL if calling an optimised sad[] four
+     * times is faster than the available version */
+    me_cmp_x4_func sad_x4[2];
 } MECmpContext;
 
 void ff_me_cmp_init(MECmpContext *c, AVCodecContext *avctx);
@@ -77,6 +77,7 @@ static int misc4_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_misc4_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_MISC4),
     .priv_data_size = sizeof(MISC4Context),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = misc4_parse,
     .close          = ff_parse_close,
 };
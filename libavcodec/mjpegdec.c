@@ -837,41 +837,43 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     return 0;
 }
 
-static inline int mjpeg_decode_dc(MJpegDecodeContext *s, int dc_index, int *val)
+static inline int mjpeg_decode_dc(MJpegDecodeContext *s, GetBitContext *gb,
+                                  int dc_index, int *val)
 {
     int code;
-    code = get_vlc2(&s->gb, s->vlcs[0][dc_index].table, 9, 2);
+    code = get_vlc2(gb, s->vlcs[0][dc_index].table, 9, 2);
     if (code < 0 || code > 16) {
         av_log(s->avctx, AV_LOG_ERROR,
                "mjpeg_decode_dc: bad vlc: %d\n", dc_index);
         return AVERROR_INVALIDDATA;
     }
 
-    *val = code ? get_xbits(&s->gb, code) : 0;
+    *val = code ? get_xbits(gb, code) : 0;
     return 0;
 }
 
 /* decode block and dequantize */
-static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
+static int decode_block(MJpegDecodeContext *s, GetBitContext *gb, int *last_dc,
+                        int16_t *block, int component,
                         int dc_index, int ac_index, uint16_t *quant_matrix)
 {
     int code, i, j, level, val;
 
     /* DC coef */
-    int ret = mjpeg_decode_dc(s, dc_index, &val);
+    int ret = mjpeg_decode_dc(s, gb, dc_index, &val);
     if (ret < 0)
         return ret;
 
-    val = val * (unsigned)quant_matrix[0] + s->last_dc[component];
-    s->last_dc[component] = val;
+    val = val * (unsigned)quant_matrix[0] + last_dc[component];
+    last_dc[component] = val;
     block[0] = av_clip_int16(val);
     /* AC coefs */
     i = 0;
     {
-        OPEN_READER(re, &s->gb);
+        OPEN_READER(re, gb);
         do {
-            UPDATE_CACHE(re, &s->gb);
-            GET_VLC(code, re, &s->gb, s->vlcs[1][ac_index].table, 9, 2);
+            UPDATE_CACHE(re, gb);
+            GET_VLC(code, re, gb, s->vlcs[1][ac_index].table, 9, 2);
 
             i += ((unsigned)code) >> 4;
             code &= 0xf;
@@ -880,12 +882,12 @@ static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
                 // So we have at least MIN_CACHE_BITS - 9 > 15 bits left here
                 // and don't need to refill the cache.
                 {
-                    int cache = GET_CACHE(re, &s->gb);
+                    int cache = GET_CACHE(re, gb);
                     int sign  = (~cache) >> 31;
                     level     = (NEG_USR32(sign ^ cache,code) ^ sign) - sign;
                 }
 
-                LAST_SKIP_BITS(re, &s->gb, code);
+                LAST_SKIP_BITS(re, gb, code);
 
                 if (i > 63) {
                     av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
@@ -895,7 +897,7 @@ static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
                 block[j] = level * quant_matrix[i];
             }
         } while (i < 63);
-        CLOSE_READER(re, &s->gb);
+        CLOSE_READER(re, gb);
     }
 
     return 0;
@@ -907,7 +909,7 @@ static int decode_dc_progressive(MJpegDecodeContext *s, int16_t *block,
 {
     unsigned val;
     s->bdsp.clear_block(block);
-    int ret = mjpeg_decode_dc(s, dc_index, &val);
+    int ret = mjpeg_decode_dc(s, &s->gb, dc_index, &val);
     if (ret < 0)
         return ret;
 
@@ -1160,7 +1162,7 @@ static int ljpeg_decode_rgb_scan(MJpegDecodeContext *s)
 
                 PREDICT(pred, topleft[i], top[i], left[i], modified_predictor);
 
-                ret = mjpeg_decode_dc(s, s->dc_index[i], &dc);
+                ret = mjpeg_decode_dc(s, &s->gb, s->dc_index[i], &dc);
                 if (ret < 0)
                     return ret;
 
@@ -1289,7 +1291,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s)
                     for (j = 0; j < n; j++) {
                         int pred, dc;
 
-                        ret = mjpeg_decode_dc(s, s->dc_index[i], &dc);
+                        ret = mjpeg_decode_dc(s, &s->gb, s->dc_index[i], &dc);
                         if (ret < 0)
                             return ret;
 
@@ -1361,7 +1363,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s)
                     for (j = 0; j < n; j++) {
                         int pred;
 
-                        ret = mjpeg_decode_dc(s, s->dc_index[i], &dc);
+                        ret = mjpeg_decode_dc(s, &s->gb, s->dc_index[i], &dc);
                         if (ret < 0)
                             return ret;
 
@@ -1427,6 +1429,250 @@ static void shift_output(MJpegDecodeContext *s, uint8_t *ptr, int linesize)
     }
 }
 
+typedef struct MJpegSliceContext {
+    DECLARE_ALIGNED(32, int16_t, block)[64];
+    GetBitContext gb;
+    int last_dc[MAX_COMPONENTS];
+    uint8_t *buffer;
+    unsigned int buffer_size;
+    int error;
+} MJpegSliceContext;
+
+typedef struct MJpegScanThreadArg {
+    uint8_t *data[MAX_COMPONENTS];
+    int linesize[MAX_COMPONENTS];
+    int chroma_width, chroma_height;
+    int nb_intervals;
+    int nb_jobs;
+} MJpegScanThreadArg;
+
+static void free_slice_contexts(MJpegDecodeContext *s)
+{
+    for (int i = 0; i < s->nb_slice_ctx; i++)
+        av_freep(&s->slice_ctx[i].buffer);
+    av_freep(&s->slice_ctx);
+    s->nb_slice_ctx = 0;
+}
+
+/**
+ * Split the entropy-coded data of the current scan at its RSTn markers.
+ *
+ * @return nb_intervals if the scan consists of exactly that many segments,
+ *         in which case gB is advanced past the scan data just like the
+ *         serial decoder would do; 0 if the layout does not match (the
+ *         serial path then handles the scan, including damaged streams);
+ *         a negative error code on allocation failure
+ */
+static int mjpeg_find_restart_intervals(MJpegDecodeContext *s, int nb_intervals)
+{
+    const uint8_t *buf_ptr = s->gB.buffer;
+    const uint8_t *buf_end = buf_ptr + bytestream2_get_bytes_left(&s->gB);
+    const uint8_t *start = buf_ptr;
+    const uint8_t *ptr = buf_ptr;
+    int n = 0;
+
+    av_fast_malloc(&s->restart_intervals, &s->restart_intervals_size,
+                   nb_intervals * sizeof(*s->restart_intervals));
+    if (!s->restart_intervals)
+        return AVERROR(ENOMEM);
+
+    while ((ptr = memchr(ptr, 0xff, buf_end - ptr))) {
+        const uint8_t *marker = ptr++;
+        if (ptr < buf_end) {
+            uint8_t x = *ptr++;
+            /* Discard multiple optional 0xFF fill bytes. */
+            while (x == 0xff && ptr < buf_end)
+                x = *ptr++;
+            if (!x)
+                continue;
+
+            s->restart_intervals[n].start = start;
+            s->restart_intervals[n].end   = marker;
+            n++;
+            if (x < RST0 || x > RST7) {
+                /* Non-restart marker */
+                if (n != nb_intervals)
+                    return 0;
+                bytestream2_skipu(&s->gB, ptr - 2 - buf_ptr);
+                return n;
+            }
+            if (n == nb_intervals) {
+                bytestream2_skipu(&s->gB, ptr - buf_ptr);
+                return n;
+            }
+            start = ptr;
+        }
+    }
+    if (n + 1 != nb_intervals)
+        return 0;
+    s->restart_intervals[n].start = start;
+    s->restart_intervals[n].end   = buf_end;
+    bytestream2_skipu(&s->gB, buf_end - buf_ptr);
+    return nb_intervals;
+}
+
+static int mjpeg_unescape_interval(MJpegSliceContext *sl,
+                                   const MJpegRestartInterval *ri)
+{
+    const uint8_t *src = ri->start;
+    const uint8_t *end = ri->end;
+    const uint8_t *ptr;
+    uint8_t *dst;
+
+    av_fast_padded_malloc(&sl->buffer, &sl->buffer_size, end - src);
+    if (!sl->buffer)
+        return AVERROR(ENOMEM);
+    dst = sl->buffer;
+
+    /* The segment contains no markers, only stuffed zero bytes. */
+    while (src < end && (ptr = memchr(src, 0xff, end - src))) {
+        memcpy(dst, src, ptr + 1 - src);
+        dst += ptr + 1 - src;
+        src  = ptr + 1;
+        while (src < end && *src == 0xff)
+            src++;
+        if (src < end)
+            src++;
+    }
+    memcpy(dst, src, end - src);
+    dst += end - src;
+    memset(dst, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    return init_get_bits8(&sl->gb, sl->buffer, dst - sl->buffer);
+}
+
+static int mjpeg_decode_scan_thread(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    const MJpegScanThreadArg *a = arg;
+    MJpegSliceContext *sl = &s->slice_ctx[threadnr];
+    const int bytes_per_pixel = 1 + (s->bits > 8);
+    const int nb_mbs = s->mb_width * s->mb_height;
+    int first = (int64_t)a->nb_intervals *  jobnr      / a->nb_jobs;
+    int last  = (int64_t)a->nb_intervals * (jobnr + 1) / a->nb_jobs;
+    int ret;
+
+    for (int k = first; k < last; k++) {
+        int mb     = k * s->restart_interval;
+        int mb_end = FFMIN(mb + s->restart_interval, nb_mbs);
+
+        ret = mjpeg_unescape_interval(sl, &s->restart_intervals[k]);
+        if (ret < 0)
+            goto fail;
+
+        for (int i = 0; i < s->nb_components_sos; i++)
+            sl->last_dc[i] = (4 << s->bits);
+
+        for (; mb < mb_end; mb++) {
+            int mb_x = mb % s->mb_width;
+            int mb_y = mb / s->mb_width;
+
+            if (get_bits_left(&sl->gb) < 0) {
+                av_log(avctx, AV_LOG_ERROR, "overread %d\n",
+                       -get_bits_left(&sl->gb));
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
+            for (int i = 0; i < s->nb_components_sos; i++) {
+                int n = s->nb_blocks[i];
+                int c = s->comp_index[i];
+                int h = s->h_scount[i];
+                int v = s->v_scount[i];
+                int x = 0, y = 0;
+                for (int j = 0; j < n; j++) {
+                    int block_offset = (((a->linesize[c] * (v * mb_y + y) * 8) +
+                                         (h * mb_x + x) * 8 * bytes_per_pixel) >> avctx->lowres);
+
+                    if (s->interlaced && s->bottom_field)
+                        block_offset += a->linesize[c] >> 1;
+                    s->bdsp.clear_block(sl->block);
+                    if (decode_block(s, &sl->gb, sl->last_dc, sl->block, i,
+                                     s->dc_index[i], s->ac_index[i],
+                                     s->quant_matrixes[s->quant_sindex[i]]) < 0) {
+                        av_log(avctx, AV_LOG_ERROR,
+                               "error y=%d x=%d\n", mb_y, mb_x);
+                        ret = AVERROR_INVALIDDATA;
+                        goto fail;
+                    }
+                    if (   8 * (h * mb_x + x) < ((c == 1) || (c == 2) ? a->chroma_width  : s->width)
+                        && 8 * (v * mb_y + y) < ((c == 1) || (c == 2) ? a->chroma_height : s->height)
+                        && a->linesize[c]) {
+                        uint8_t *ptr = a->data[c] + block_offset;
+                        s->idsp.idct_put(ptr, a->linesize[c], sl->block);
+                        if (s->bits & 7)
+                            shift_output(s, ptr, a->linesize[c]);
+                    }
+                    if (++x == h) {
+                        x = 0;
+                        y++;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+fail:
+    if (!sl->error)
+        sl->error = ret;
+    return ret;
+}
+
+/**
+ * Decode a sequential scan by distributing its restart intervals over the
+ * slice threads. Each interval starts with reset DC predictors and is
+ * byte-aligned after its RSTn marker, so intervals are independent.
+ *
+ * @return 1 if the scan was decoded, 0 if it has to be decoded serially,
+ *         a negative error code otherwise
+ */
+static int mjpeg_decode_scan_threaded(MJpegDecodeContext *s,
+                                      uint8_t *const data[MAX_COMPONENTS],
+                                      const int linesize[MAX_COMPONENTS],
+                                      int chroma_width, int chroma_height)
+{
+    AVCodecContext *avctx = s->avctx;
+    MJpegScanThreadArg arg;
+    int nb_intervals, ret;
+
+    if (!s->restart_interval)
+        return 0;
+    nb_intervals = (s->mb_width * s->mb_height + s->restart_interval - 1) /
+                   s->restart_interval;
+    if (nb_intervals < 2)
+        return 0;
+
+    ret = mjpeg_find_restart_intervals(s, nb_intervals);
+    if (ret <= 0)
+        return ret;
+
+    if (s->nb_slice_ctx < avctx->thread_count) {
+        free_slice_contexts(s);
+        s->slice_ctx = av_calloc(avctx->thread_count, sizeof(*s->slice_ctx));
+        if (!s->slice_ctx)
+            return AVERROR(ENOMEM);
+        s->nb_slice_ctx = avctx->thread_count;
+    }
+    for (int i = 0; i < s->nb_slice_ctx; i++)
+        s->slice_ctx[i].error = 0;
+
+    for (int i = 0; i < MAX_COMPONENTS; i++) {
+        arg.data[i]     = data[i];
+        arg.linesize[i] = linesize[i];
+    }
+    arg.chroma_width  = chroma_width;
+    arg.chroma_height = chroma_height;
+    arg.nb_intervals  = nb_intervals;
+    arg.nb_jobs       = FFMIN(nb_intervals, 4 * avctx->thread_count);
+
+    avctx->execute2(avctx, mjpeg_decode_scan_thread, &arg, NULL, arg.nb_jobs);
+
+    for (int i = 0; i < s->nb_slice_ctx; i++)
+        if (s->slice_ctx[i].error < 0)
+            return s->slice_ctx[i].error;
+    return 1;
+}
+
 static int mjpeg_decode_scan(MJpegDecodeContext *s)
 {
     int nb_components = s->nb_components_sos;
@@ -1435,9 +1681,9 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s)
     const uint8_t *mb_bitmask = NULL;
     const AVFrame *reference = NULL;
     int i, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
-    uint8_t *data[MAX_COMPONENTS];
+    uint8_t *data[MAX_COMPONENTS] = { NULL };
     const uint8_t *reference_data[MAX_COMPONENTS];
-    int linesize[MAX_COMPONENTS];
+    int linesize[MAX_COMPONENTS] = { 0 };
     GetBitContext mb_bitmask_gb = {0}; // initialize to silence gcc warning
     int bytes_per_pixel = 1 + (s->bits > 8);
     int field_pos = -1;
@@ -1472,6 +1718,17 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s)
 next_field:
     s->restart_count = -1;
 
+    if (!s->progressive && !mb_bitmask &&
+        s->avctx->active_thread_type & FF_THREAD_SLICE &&
+        s->avctx->thread_count > 1) {
+        ret = mjpeg_decode_scan_threaded(s, data, linesize,
+                                         chroma_width, chroma_height);
+        if (ret < 0)
+            return ret;
+        if (ret > 0)
+            goto scan_done;
+    }
+
     for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
         for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
             const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
@@ -1530,7 +1787,7 @@ next_field:
 
                         } else {
                             s->bdsp.clear_block(s->block);
-                            if (decode_block(s, s->block, i,
+                            if (decode_block(s, &s->gb, s->last_dc, s->block, i,
                                              s->dc_index[i], s->ac_index[i],
                                              s->quant_matrixes[s->quant_sindex[i]]) < 0) {
                                 av_log(s->avctx, AV_LOG_ERROR,
@@ -1571,6 +1828,7 @@ next_field:
         }
     }
 
+scan_done:
     if (s->interlaced &&
         bytestream2_get_bytes_left(&s->gB) > 2 &&
         bytestream2_tell(&s->gB) > 2 &&
@@ -2912,6 +3170,8 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     av_frame_free(&s->smv_frame);
 
     av_freep(&s->buffer);
+    av_freep(&s->restart_intervals);
+    free_slice_contexts(s);
     av_freep(&s->stereo3d);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size = 0;
@@ -2973,7 +3233,7 @@ const FFCodec ff_mjpeg_decoder = {
     .close          = ff_mjpeg_decode_end,
     FF_CODEC_DECODE_CB(ff_mjpeg_decode_frame),
     .flush          = decode_flush,
-    .p.capabilities = AV_CODEC_CAP_DR1,
+    .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
     .p.max_lowres   = 3,
     .p.priv_class   = &mjpegdec_class,
     .p.profiles     = NULL_IF_CONFIG_SMALL(ff_mjpeg_profiles),
@@ -52,6 +52,15 @@ typedef struct ICCEntry {
 } ICCEntry;
 
 struct JLSState;
+struct MJpegSliceContext;
+
+/**
+ * Entropy-coded segment of a scan delimited by RSTn markers.
+ */
+typedef struct MJpegRestartInterval {
+    const uint8_t *start; ///< first byte of the (still escaped) segment
+    const uint8_t *end;   ///< one past the last byte of the segment
+} MJpegRestartInterval;
 
 typedef struct MJpegDecodeContext {
     AVClass *class;
@@ -133,6 +142,12 @@ typedef struct MJpegDecodeContext {
     int restart_interval;
     int restart_count;
 
+    /* slice threading over restart intervals */
+    MJpegRestartInterval *restart_intervals;
+    unsigned int restart_intervals_size;
+    struct MJpegSliceContext *slice_ctx;
+    int nb_slice_ctx;
+
     int cs_itu601;
     int interlace_polarity;
     int multiscope;
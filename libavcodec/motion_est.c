@@ -335,6 +335,8 @@ av_cold int ff_me_init(MotionEstContext *c, AVCodecContext *avctx,
 
     c->sse = mecc->sse[0];
     memcpy(c->pix_abs, mecc->pix_abs, sizeof(c->pix_abs));
+    c->me_cmp_x4[0] = avctx->me_cmp == FF_CMP_SAD ? mecc->sad_x4[0] : NULL;
+    c->me_cmp_x4[1] = avctx->me_cmp == FF_CMP_SAD ? mecc->sad_x4[1] : NULL;
 
     c->flags     = get_flags(c, 0, avctx->me_cmp     & FF_CMP_CHROMA);
     c->sub_flags = get_flags(c, 0, avctx->me_sub_cmp & FF_CMP_CHROMA);
@@ -89,6 +89,7 @@ typedef struct MotionEstContext {
     me_cmp_func me_cmp[6];
     me_cmp_func me_sub_cmp[6];
     me_cmp_func mb_cmp[6];
+    me_cmp_x4_func me_cmp_x4[2];    ///< me_cmp[0/1] for four candidates, NULL if unavailable
 
     me_cmp_func pix_abs[2][4];
     me_cmp_func sse;
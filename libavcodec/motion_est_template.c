@@ -419,6 +419,9 @@ static av_always_inline int small_diamond_search(MPVEncContext *const s, int *be
 {
     MotionEstContext *const c = &s->me;
     me_cmp_func cmpf, chroma_cmpf;
+    me_cmp_x4_func cmp_x4 = NULL;
+    const uint8_t *src_y = NULL, *ref_y = NULL;
+    const ptrdiff_t stride = c->stride;
     int next_dir=-1;
     LOAD_COMMON
     LOAD_COMMON2
@@ -426,6 +429,11 @@ static av_always_inline int small_diamond_search(MPVEncContext *const s, int *be
 
     cmpf        = c->me_cmp[size];
     chroma_cmpf = c->me_cmp[size + 1];
+    if (size < 2 && !(flags & (FLAG_DIRECT | FLAG_CHROMA))) {
+        cmp_x4 = c->me_cmp_x4[size];
+        src_y  = c->src[src_index][0];
+        ref_y  = c->ref[ref_index][0];
+    }
 
     { /* ensure that the best point is in the MAP as h/qpel refinement needs it */
         const unsigned key = ((unsigned)best[1]<<ME_MAP_MV_BITS) + best[0] + map_generation;
@@ -443,6 +451,54 @@ static av_always_inline int small_diamond_search(MPVEncContext *const s, int *be
         const int y= best[1];
         next_dir=-1;
 
+        if (cmp_x4) {
+            /* Score all unvisited neighbours with one call. Their map
+             * entries are distinct, so they are updated afterwards in the
+             * same order as by CHECK_MV_DIR, which keeps the result
+             * identical. */
+            static const int8_t dia[4][2] = { { -1, 0 }, { 0, -1 }, { 1, 0 }, { 0, 1 } };
+            const uint8_t *refs[4];
+            int cand[4], scores[4], n = 0;
+
+            for (int i = 0; i < 4; i++) {
+                const int nx = x + dia[i][0];
+                const int ny = y + dia[i][1];
+                const unsigned key = ((unsigned)ny << ME_MAP_MV_BITS) + nx + map_generation;
+                const int index = (((unsigned)ny << ME_MAP_SHIFT) + nx) & (ME_MAP_SIZE - 1);
+
+                if (dir == (i ^ 2) || nx < xmin || nx > xmax || ny < ymin || ny > ymax ||
+                    map[index] == key)
+                    continue;
+                refs[n]   = ref_y + nx + ny * stride;
+                cand[n++] = i;
+            }
+            if (!n)
+                return dmin;
+            for (int i = n; i < 4; i++)
+                refs[i] = refs[0];
+            cmp_x4(src_y, refs, stride, h, scores);
+
+            for (int i = 0; i < n; i++) {
+                const int nx = x + dia[cand[i]][0];
+                const int ny = y + dia[cand[i]][1];
+                const int index = (((unsigned)ny << ME_MAP_SHIFT) + nx) & (ME_MAP_SIZE - 1);
+
+                map[index]       = ((unsigned)ny << ME_MAP_MV_BITS) + nx + map_generation;
+                score_map[index] = scores[i];
+                d = scores[i] + (mv_penalty[(int)((unsigned)nx << shift) - pred_x] +
+                                 mv_penalty[(int)((unsigned)ny << shift) - pred_y]) * penalty_factor;
+                if (d < dmin) {
+                    best[0]  = nx;
+                    best[1]  = ny;
+                    dmin     = d;
+                    next_dir = cand[i];
+                }
+            }
+            if (next_dir == -1)
+                return dmin;
+            continue;
+        }
+
         if(dir!=2 && x>xmin) CHECK_MV_DIR(x-1, y  , 0)
         if(dir!=3 && y>ymin) CHECK_MV_DIR(x  , y-1, 1)
         if(dir!=0 && x<xmax) CHECK_MV_DIR(x+1, y  , 2)
@@ -141,6 +141,7 @@ const FFCodecParser ff_mpegaudio_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_MP1, AV_CODEC_ID_MP2,
                       AV_CODEC_ID_MP3, AV_CODEC_ID_MP3ADU),
     .priv_data_size = sizeof(MpegAudioParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = mpegaudio_parse,
     .close          = ff_parse_close,
 };
@@ -1912,6 +1912,40 @@ int ff_mpv_encode_picture(AVCodecContext *avctx, AVPacket *pkt,
 
     m->vbv_ignore_qmax = 0;
 
+    /* With GOP threading, every GOP continues the picture numbering, the
+     * size and the shared VBV model of the stream rather than where this context left off.
+     * The context has been drained, so the first frame is coded right away. */
+    if (m->gop_threads && avctx->internal->frame_thread_encoder &&
+        avctx->internal->gop_start.frame_number >= 0) {
+        m->input_picture_number =
+        m->coded_picture_number = avctx->internal->gop_start.frame_number;
+        if (avctx->internal->gop_start.vbv_fullness >= 0)
+            m->rc_context.buffer_index = avctx->internal->gop_start.vbv_fullness;
+        if (avctx->internal->gop_start.total_bits >= 0)
+            m->total_bits = avctx->internal->gop_start.total_bits;
+        avctx->internal->gop_start.frame_number = -1;
+
+        /* Anything adapted to the GOP this context coded before would make
+         * the output depend on which thread got which GOP, so the rate
+         * control history and the references start over as for a new stream. */
+        ff_rate_control_reset(&m->rc_context);
+        memset(m->last_lambda_for, 0, sizeof(m->last_lambda_for));
+        m->next_lambda          = 0;
+        m->last_pict_type       =
+        m->last_non_b_pict_type = AV_PICTURE_TYPE_NONE;
+        ff_mpv_unref_picture(&s->c.last_pic);
+        ff_mpv_unref_picture(&s->c.next_pic);
+        for (int i = 0; i < context_count; i++) {
+            MPVEncContext *const slice = s->c.enc_contexts[i];
+
+            slice->f_code = slice->b_code = 1;
+            if (slice->dct_error_sum) {
+                memset(slice->dct_error_sum, 0, 2 * sizeof(*slice->dct_error_sum));
+                slice->dct_count[0] = slice->dct_count[1] = 0;
+            }
+        }
+    }
+
     m->picture_in_gop_number++;
 
     ret = load_input_picture(m, pic_arg);
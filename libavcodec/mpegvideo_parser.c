@@ -303,6 +303,7 @@ static av_cold int mpegvideo_parse_init(AVCodecParserContext *s)
 const FFCodecParser ff_mpegvideo_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_MPEG1VIDEO, AV_CODEC_ID_MPEG2VIDEO),
     .priv_data_size = sizeof(struct MpvParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = mpegvideo_parse_init,
     .parse          = mpegvideo_parse,
     .close          = ff_parse_close,
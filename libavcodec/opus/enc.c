@@ -22,6 +22,7 @@
 #include <float.h>
 
 #include "enc.h"
+#include "enc_dsp.h"
 #include "pvq.h"
 #include "enc_psy.h"
 #include "tab.h"
@@ -44,6 +45,7 @@ typedef struct OpusEncContext {
     AVCodecContext *avctx;
     AudioFrameQueue afq;
     AVFloatDSPContext *dsp;
+    OpusEncDSP encdsp;
     AVTXContext *tx[CELT_BLOCK_NB];
     av_tx_fn tx_fn[CELT_BLOCK_NB];
     CeltPVQ *pvq;
@@ -249,16 +251,17 @@ static void celt_frame_mdct(OpusEncContext *s, CeltFrame *f)
 
     for (int ch = 0; ch < f->channels; ch++) {
         CeltBlock *block = &f->block[ch];
+        float band_ener[CELT_MAX_BANDS];
+
+        s->encdsp.band_energy(band_ener, block->coeffs, f->size);
+
         for (int i = 0; i < CELT_MAX_BANDS; i++) {
-            float ener = 0.0f;
+            float ener;
             int band_offset = ff_celt_freq_bands[i] << f->size;
             int band_size   = ff_celt_freq_range[i] << f->size;
             float *coeffs   = &block->coeffs[band_offset];
 
-            for (int j = 0; j < band_size; j++)
-                ener += coeffs[j]*coeffs[j];
-
-            block->lin_energy[i] = sqrtf(ener) + FLT_EPSILON;
+            block->lin_energy[i] = sqrtf(band_ener[i]) + FLT_EPSILON;
             ener = 1.0f/block->lin_energy[i];
 
             for (int j = 0; j < band_size; j++)
@@ -684,6 +687,8 @@ static av_cold int opus_encode_init(AVCodecContext *avctx)
     if (!(s->dsp = avpriv_float_dsp_alloc(avctx->flags & AV_CODEC_FLAG_BITEXACT)))
         return AVERROR(ENOMEM);
 
+    ff_opus_enc_dsp_init(&s->encdsp);
+
     /* I have no idea why a base scaling factor of 68 works, could be the twiddles */
     for (int i = 0; i < CELT_BLOCK_NB; i++) {
         const float scale = 68 << (CELT_BLOCK_NB - 1 - i);
@@ -750,7 +755,8 @@ const FFCodec ff_opus_encoder = {
     .p.type         = AVMEDIA_TYPE_AUDIO,
     .p.id           = AV_CODEC_ID_OPUS,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_EXPERIMENTAL,
+                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_EXPERIMENTAL |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .defaults       = opusenc_defaults,
     .p.priv_class   = &opusenc_class,
     .priv_data_size = sizeof(OpusEncContext),
@@ -0,0 +1,76 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "celt.h"
+#include "enc_dsp.h"
+#include "tab.h"
+
+static void band_energy_c(float *energy, const float *coeffs, int shift)
+{
+    for (int i = 0; i < CELT_MAX_BANDS; i++) {
+        const int range = ff_celt_freq_range[i] << shift;
+        float ener = 0.0f;
+
+        for (int j = 0; j < range; j++)
+            ener += coeffs[j]*coeffs[j];
+
+        energy[i] = ener;
+        coeffs   += range;
+    }
+}
+
+static void band_tonality_c(float *tone, const float *energy,
+                            const float *coeffs, int shift)
+{
+    for (int i = 0; i < CELT_MAX_BANDS; i++) {
+        const int range = ff_celt_freq_range[i] << shift;
+        const float avg_c_s = energy[i] / range;
+        float dist_dev = 0.0f;
+
+        for (int j = 0; j < range; j++) {
+            const float c_s = coeffs[j]*coeffs[j];
+            dist_dev += (avg_c_s - c_s)*(avg_c_s - c_s);
+        }
+
+        tone[i] = dist_dev;
+        coeffs += range;
+    }
+}
+
+static void band_distance_c(float *dist, const float *a, const float *b, int shift)
+{
+    for (int i = 0; i < CELT_MAX_BANDS; i++) {
+        const int range = ff_celt_freq_range[i] << shift;
+        float d = 0.0f;
+
+        for (int j = 0; j < range; j++)
+            d += (a[j] - b[j])*(a[j] - b[j]);
+
+        dist[i] = d;
+        a += range;
+        b += range;
+    }
+}
+
+av_cold void ff_opus_enc_dsp_init(OpusEncDSP *ctx)
+{
+    ctx->band_energy   = band_energy_c;
+    ctx->band_tonality = band_tonality_c;
+    ctx->band_distance = band_distance_c;
+}
@@ -0,0 +1,36 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_OPUS_ENC_DSP_H
+#define AVCODEC_OPUS_ENC_DSP_H
+
+/* All functions operate on the CELT_MAX_BANDS bands of a block of MDCT
+ * coefficients, band i spanning ff_celt_freq_range[i] << shift values. */
+typedef struct OpusEncDSP {
+    /* energy[i] = sum of c^2 */
+    void (*band_energy)(float *energy, const float *coeffs, int shift);
+    /* tone[i] = sum of (m - c^2)^2, with m = energy[i] / band size */
+    void (*band_tonality)(float *tone, const float *energy,
+                          const float *coeffs, int shift);
+    /* dist[i] = sum of (a - b)^2 */
+    void (*band_distance)(float *dist, const float *a, const float *b, int shift);
+} OpusEncDSP;
+
+void ff_opus_enc_dsp_init(OpusEncDSP *ctx);
+
+#endif /* AVCODEC_OPUS_ENC_DSP_H */
@@ -81,7 +81,7 @@ static float pvq_band_cost(CeltPVQ *pvq, CeltFrame *f, OpusRangeCoder *rc, int b
 /* Populate metrics without taking into consideration neighbouring steps */
 static void step_collect_psy_metrics(OpusPsyContext *s, int index)
 {
-    int silence = 0, ch, i, j;
+    int silence = 0, ch, i;
     /* The MDCT analysis covers 2 * OPUS_BLOCK_SIZE(bsize_analysis) samples.
      * Each bufqueue entry holds avctx->frame_size samples (120 historically,
      * 960 after c3aea7628c for default settings). steps_per_half is how many
@@ -124,38 +124,27 @@ static void step_collect_psy_metrics(OpusPsyContext *s, int index)
     }
 
     for (ch = 0; ch < s->avctx->ch_layout.nb_channels; ch++) {
-        for (i = 0; i < CELT_MAX_BANDS; i++) {
-            float avg_c_s, energy = 0.0f, dist_dev = 0.0f;
-            const int range = ff_celt_freq_range[i] << s->bsize_analysis;
-            const float *coeffs = st->bands[ch][i];
-            for (j = 0; j < range; j++)
-                energy += coeffs[j]*coeffs[j];
-
-            st->energy[ch][i] += sqrtf(energy);
-            silence |= !!st->energy[ch][i];
-            avg_c_s = energy / range;
+        float energy[CELT_MAX_BANDS], tone[CELT_MAX_BANDS];
 
-            for (j = 0; j < range; j++) {
-                const float c_s = coeffs[j]*coeffs[j];
-                dist_dev += (avg_c_s - c_s)*(avg_c_s - c_s);
-            }
+        s->encdsp.band_energy(energy, st->coeffs[ch], s->bsize_analysis);
+        s->encdsp.band_tonality(tone, energy, st->coeffs[ch], s->bsize_analysis);
 
-            st->tone[ch][i] += sqrtf(dist_dev);
+        for (i = 0; i < CELT_MAX_BANDS; i++) {
+            st->energy[ch][i] += sqrtf(energy[i]);
+            silence |= !!st->energy[ch][i];
+            st->tone[ch][i] += sqrtf(tone[i]);
         }
     }
 
     st->silence = !silence;
 
     if (s->avctx->ch_layout.nb_channels > 1) {
-        for (i = 0; i < CELT_MAX_BANDS; i++) {
-            float incompat = 0.0f;
-            const float *coeffs1 = st->bands[0][i];
-            const float *coeffs2 = st->bands[1][i];
-            const int range = ff_celt_freq_range[i] << s->bsize_analysis;
-            for (j = 0; j < range; j++)
-                incompat += (coeffs1[j] - coeffs2[j])*(coeffs1[j] - coeffs2[j]);
-            st->stereo[i] = sqrtf(incompat);
-        }
+        float incompat[CELT_MAX_BANDS];
+
+        s->encdsp.band_distance(incompat, st->coeffs[0], st->coeffs[1], s->bsize_analysis);
+
+        for (i = 0; i < CELT_MAX_BANDS; i++)
+            st->stereo[i] = sqrtf(incompat[i]);
     }
 
     for (ch = 0; ch < s->avctx->ch_layout.nb_channels; ch++) {
@@ -425,20 +414,51 @@ static int bands_dist(OpusPsyContext *s, CeltFrame *f, float *total_dist)
     return 0;
 }
 
+/* Each job evaluates one stereo candidate on its thread's copy of the frame.
+ * Every candidate starts from the same noise seed, so the result does not
+ * depend on how the jobs are spread over the threads. */
+static int rd_search_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    OpusPsyContext *s = arg;
+    const CeltFrame *f = s->rd_ref;
+    CeltFrame *tf = &s->rd_frame[threadnr];
+
+    tf->intensity_stereo = s->rd_dual ? f->intensity_stereo : f->end_band - jobnr;
+    tf->dual_stereo      = s->rd_dual ? jobnr : f->dual_stereo;
+    tf->seed             = f->seed;
+
+    bands_dist(s, tf, &s->rd_dist[jobnr]);
+    /* ff_celt_bitalloc() may lower the intensity band */
+    s->rd_intensity[jobnr] = tf->intensity_stereo;
+
+    return 0;
+}
+
+static void rd_search(OpusPsyContext *s, const CeltFrame *f, int dual, int nb_candidates)
+{
+    for (int i = 0; i < s->nb_rd_threads; i++) {
+        struct CeltPVQ *pvq = s->rd_pvq[i];
+        s->rd_frame[i] = *f;
+        s->rd_frame[i].pvq = pvq;
+    }
+
+    s->rd_ref  = f;
+    s->rd_dual = dual;
+    s->avctx->execute2(s->avctx, rd_search_job, s, NULL, nb_candidates);
+}
+
 static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
 {
-    float td1, td2;
     f->dual_stereo = 0;
 
     if (s->avctx->ch_layout.nb_channels < 2)
         return;
 
-    bands_dist(s, f, &td1);
-    f->dual_stereo = 1;
-    bands_dist(s, f, &td2);
+    rd_search(s, f, 1, 2);
 
-    f->dual_stereo = td2 < td1;
-    s->dual_stereo_used += td2 < td1;
+    f->intensity_stereo = FFMIN(s->rd_intensity[0], s->rd_intensity[1]);
+    f->dual_stereo = s->rd_dist[1] < s->rd_dist[0];
+    s->dual_stereo_used += f->dual_stereo;
 }
 
 static void celt_search_for_intensity(OpusPsyContext *s, CeltFrame *f)
@@ -451,9 +471,10 @@ static void celt_search_for_intensity(OpusPsyContext *s, CeltFrame *f)
     if (s->avctx->ch_layout.nb_channels < 2)
         return;
 
+    rd_search(s, f, 0, f->end_band - (int)end_band + 1);
+
     for (i = f->end_band; i >= end_band; i--) {
-        f->intensity_stereo = i;
-        bands_dist(s, f, &dist);
+        dist = s->rd_dist[f->end_band - i];
         if (best_dist > dist) {
             best_dist = dist;
             best_band = i;
@@ -586,6 +607,8 @@ av_cold int ff_opus_psy_init(OpusPsyContext *s, AVCodecContext *avctx,
         goto fail;
     }
 
+    ff_opus_enc_dsp_init(&s->encdsp);
+
     for (ch = 0; ch < s->avctx->ch_layout.nb_channels; ch++) {
         for (i = 0; i < CELT_MAX_BANDS; i++) {
             bessel_init(&s->bfilter_hi[ch][i], 1.0f, 19.0f, 100.0f, 1);
@@ -601,6 +624,19 @@ av_cold int ff_opus_psy_init(OpusPsyContext *s, AVCodecContext *avctx,
         }
     }
 
+    s->nb_rd_threads = avctx->ch_layout.nb_channels > 1 ? FFMAX(avctx->thread_count, 1) : 0;
+    if (s->nb_rd_threads) {
+        s->rd_frame = av_calloc(s->nb_rd_threads, sizeof(*s->rd_frame));
+        s->rd_pvq   = av_calloc(s->nb_rd_threads, sizeof(*s->rd_pvq));
+        if (!s->rd_frame || !s->rd_pvq) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        for (i = 0; i < s->nb_rd_threads; i++)
+            if ((ret = ff_celt_pvq_init(&s->rd_pvq[i], 1)) < 0)
+                goto fail;
+    }
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         float tmp;
         const int len = OPUS_BLOCK_SIZE(i);
@@ -623,6 +659,11 @@ fail:
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
 
+    for (i = 0; i < s->nb_rd_threads && s->rd_pvq; i++)
+        ff_celt_pvq_uninit(&s->rd_pvq[i]);
+    av_freep(&s->rd_pvq);
+    av_freep(&s->rd_frame);
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         av_tx_uninit(&s->mdct[i]);
         av_freep(&s->window[i]);
@@ -646,6 +687,11 @@ av_cold int ff_opus_psy_end(OpusPsyContext *s)
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
 
+    for (i = 0; i < s->nb_rd_threads && s->rd_pvq; i++)
+        ff_celt_pvq_uninit(&s->rd_pvq[i]);
+    av_freep(&s->rd_pvq);
+    av_freep(&s->rd_frame);
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         av_tx_uninit(&s->mdct[i]);
         av_freep(&s->window[i]);
@@ -26,6 +26,7 @@
 #include "libavutil/mem_internal.h"
 
 #include "enc.h"
+#include "enc_dsp.h"
 #include "celt.h"
 #include "enc_utils.h"
 
@@ -52,6 +53,7 @@ typedef struct OpusBandExcitation {
 typedef struct OpusPsyContext {
     AVCodecContext *avctx;
     AVFloatDSPContext *dsp;
+    OpusEncDSP encdsp;
     struct FFBufQueue *bufqueue;
     OpusEncOptions *options;
 
@@ -69,6 +71,15 @@ typedef struct OpusPsyContext {
 
     DECLARE_ALIGNED(32, float, scratch)[2048];
 
+    /* Stereo RD search, one candidate per job */
+    CeltFrame *rd_frame;          /* Per-thread copy of the frame being searched */
+    struct CeltPVQ **rd_pvq;      /* Per-thread quantiser scratch */
+    int nb_rd_threads;
+    const CeltFrame *rd_ref;      /* Frame being searched */
+    int rd_dual;                  /* Searching dual stereo rather than intensity */
+    float rd_dist[CELT_MAX_BANDS + 1];
+    int rd_intensity[CELT_MAX_BANDS + 1];
+
     /* Stats */
     float avg_is_band;
     int64_t dual_stereo_used;
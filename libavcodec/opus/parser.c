@@ -219,6 +219,7 @@ fail:
 const FFCodecParser ff_opus_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_OPUS),
     .priv_data_size = sizeof(OpusParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = opus_parse,
     .close          = ff_parse_close
 };
@@ -26,9 +26,11 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/avassert.h"
+#include "libavutil/buffer.h"
 #include "libavutil/mem.h"
 
 #include "codec_desc.h"
+#include "internal.h"
 #include "parser.h"
 #include "parser_internal.h"
 
@@ -210,6 +212,26 @@ av_cold void av_parser_close(AVCodecParserContext *s)
     }
 }
 
+/* Same growth policy as av_fast_realloc(), the contents are preserved. */
+static int parse_buffer_grow(ParseContext *pc, size_t size)
+{
+    int ret;
+
+    if (size <= pc->buffer_size)
+        return 0;
+
+    size = FFMAX(size + size / 16 + 32, size);
+    if (size > UINT_MAX)
+        return AVERROR(ENOMEM);
+    ret = av_buffer_realloc(&pc->buf, size);
+    if (ret < 0)
+        return ret;
+    pc->buffer      = pc->buf->data;
+    pc->buffer_size = size;
+
+    return 0;
+}
+
 int ff_combine_frame(ParseContext *pc, int next,
                      const uint8_t **buf, int *buf_size)
 {
@@ -235,16 +257,12 @@ int ff_combine_frame(ParseContext *pc, int next,
 
     /* copy into buffer end return */
     if (next == END_NOT_FOUND) {
-        void *new_buffer = av_fast_realloc(pc->buffer, &pc->buffer_size,
-                                           *buf_size + pc->index +
-                                           AV_INPUT_BUFFER_PADDING_SIZE);
-
-        if (!new_buffer) {
+        if (parse_buffer_grow(pc, *buf_size + pc->index +
+                                  AV_INPUT_BUFFER_PADDING_SIZE) < 0) {
             av_log(NULL, AV_LOG_ERROR, "Failed to reallocate parser buffer to %d\n", *buf_size + pc->index + AV_INPUT_BUFFER_PADDING_SIZE);
             pc->index = 0;
             return AVERROR(ENOMEM);
         }
-        pc->buffer = new_buffer;
         memcpy(&pc->buffer[pc->index], *buf, *buf_size);
         memset(&pc->buffer[pc->index + *buf_size], 0, AV_INPUT_BUFFER_PADDING_SIZE);
         pc->index += *buf_size;
@@ -258,17 +276,14 @@ int ff_combine_frame(ParseContext *pc, int next,
 
     /* append to buffer */
     if (pc->index) {
-        void *new_buffer = av_fast_realloc(pc->buffer, &pc->buffer_size,
-                                           next + pc->index +
-                                           AV_INPUT_BUFFER_PADDING_SIZE);
-        if (!new_buffer) {
+        if (parse_buffer_grow(pc, next + pc->index +
+                                  AV_INPUT_BUFFER_PADDING_SIZE) < 0) {
             av_log(NULL, AV_LOG_ERROR, "Failed to reallocate parser buffer to %d\n", next + pc->index + AV_INPUT_BUFFER_PADDING_SIZE);
             *buf_size =
             pc->overread_index =
             pc->index = 0;
             return AVERROR(ENOMEM);
         }
-        pc->buffer = new_buffer;
         if (next > -AV_INPUT_BUFFER_PADDING_SIZE)
             memcpy(&pc->buffer[pc->index], *buf,
                    next + AV_INPUT_BUFFER_PADDING_SIZE);
@@ -301,5 +316,64 @@ av_cold void ff_parse_close(AVCodecParserContext *s)
 {
     ParseContext *pc = s->priv_data;
 
-    av_freep(&pc->buffer);
+    av_buffer_unref(&pc->buf);
+}
+
+AVBufferRef *avpriv_parser_get_buffer(AVCodecParserContext *s,
+                                      uint8_t **data, int size)
+{
+    ParseContext *pc = s->priv_data;
+    AVBufferRef *buf = NULL, *frame_buf = NULL;
+    size_t need, live, alloc;
+
+    if (!(ffcodecparser(s->parser)->caps_internal & FF_PARSER_CAP_PARSE_CONTEXT) ||
+        !pc->buf || *data < pc->buffer || size < 0 ||
+        size > pc->buffer + pc->buffer_size - *data - AV_INPUT_BUFFER_PADDING_SIZE)
+        return NULL;
+
+    /* A buffer grown for an earlier, larger frame would be kept alive by
+     * the packet mostly unused, so copy the frame in that case. */
+    need = (size_t)size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (pc->buffer_size / 2 > need) {
+        frame_buf = av_buffer_alloc(need);
+        if (!frame_buf)
+            return NULL;
+        memcpy(frame_buf->data, *data, size);
+        memset(frame_buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    }
+
+    /* Continue in a new buffer sized for a frame like this one. Only the
+     * partial frame being assembled and the bytes overread from the next
+     * frame are still needed by the parser; after a frame was returned from
+     * the buffer the former is empty, so this copies at most a few bytes. */
+    live  = FFMIN(pc->index + AV_INPUT_BUFFER_PADDING_SIZE, pc->buffer_size);
+    alloc = FFMIN(need + need / 16 + 32, pc->buffer_size);
+    alloc = FFMAX(alloc, live);
+    if (pc->overread > 0 && pc->overread_index < pc->buffer_size)
+        alloc = FFMAX(alloc, FFMIN(pc->overread_index + pc->overread,
+                                   pc->buffer_size));
+    if (av_buffer_realloc(&buf, alloc) < 0) {
+        av_buffer_unref(&frame_buf);
+        return NULL;
+    }
+
+    memcpy(buf->data, pc->buffer, live);
+    if (pc->overread > 0 && pc->overread_index < pc->buffer_size)
+        memcpy(buf->data + pc->overread_index, pc->buffer + pc->overread_index,
+               FFMIN(pc->overread, pc->buffer_size - pc->overread_index));
+
+    if (frame_buf) {
+        *data = frame_buf->data;
+        av_buffer_unref(&pc->buf);
+    } else {
+        /* ff_combine_frame() fills the padding with the bytes following the
+         * frame; the parser has its own copy of them now. */
+        memset(*data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        frame_buf = pc->buf;
+    }
+    pc->buf         = buf;
+    pc->buffer      = buf->data;
+    pc->buffer_size = alloc;
+
+    return frame_buf;
 }
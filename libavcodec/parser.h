@@ -23,10 +23,13 @@
 #ifndef AVCODEC_PARSER_H
 #define AVCODEC_PARSER_H
 
+#include "libavutil/buffer.h"
+
 #include "avcodec.h"
 
 typedef struct ParseContext{
-    uint8_t *buffer;
+    uint8_t *buffer;            ///< data of buf
+    AVBufferRef *buf;           ///< owns buffer, see avpriv_parser_get_buffer()
     int index;
     int last_index;
     unsigned int buffer_size;
@@ -24,9 +24,22 @@
 #include "libavutil/macros.h"
 #include "avcodec.h"
 
+/**
+ * The private context starts with a ParseContext used with
+ * ff_combine_frame(). Across parse() calls the parser only relies on the
+ * partial frame and the overread bytes in its buffer, and keeps no pointers
+ * into it, so frames assembled there can be returned without a copy, see
+ * avpriv_parser_get_buffer().
+ */
+#define FF_PARSER_CAP_PARSE_CONTEXT (1 << 0)
+
 typedef struct FFCodecParser {
     AVCodecParser p;
     unsigned priv_data_size;
+    /**
+     * Internal parser capabilities FF_PARSER_CAP_*.
+     */
+    unsigned caps_internal;
     int (*init)(AVCodecParserContext *s);
     int (*parse)(AVCodecParserContext *s,
                  AVCodecContext *avctx,
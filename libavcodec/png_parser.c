@@ -114,6 +114,7 @@ flush:
 const FFCodecParser ff_png_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_PNG),
     .priv_data_size = sizeof(PNGParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = png_parse,
     .close          = ff_parse_close,
 };
@@ -52,6 +52,19 @@ typedef struct APNGFctlChunk {
     uint8_t dispose_op, blend_op;
 } APNGFctlChunk;
 
+typedef struct PNGEncSliceContext {
+    FFZStream zstream;           ///< raw deflate stream for this slice's rows
+    uint8_t *crow_base;          ///< filtered row scratch buffer
+    unsigned int crow_size;
+    uint8_t *dict;               ///< filtered rows preceding the slice
+    unsigned int dict_size;
+    uint8_t *out;                ///< compressed data of the slice
+    unsigned int out_size;
+    int out_len;
+    uLong adler;                 ///< Adler-32 of the uncompressed slice data
+    int in_len;
+} PNGEncSliceContext;
+
 typedef struct PNGEncContext {
     AVClass *class;
     LLVidEncDSPContext llvidencdsp;
@@ -64,6 +77,13 @@ typedef struct PNGEncContext {
 
     FFZStream zstream;
     uint8_t buf[IOBUF_SIZE];
+    int compression_level;
+
+    PNGEncSliceContext *slices;
+    int *slice_ret;              ///< return value of each slice job
+    int nb_slices;
+    int nb_slices_allocated;
+
     int dpi;                     ///< Physical pixel density, in dots per inch, if set
     int dpm;                     ///< Physical pixel density, in dots per meter, if set
 
@@ -210,15 +230,12 @@ static uint8_t *png_choose_filter(PNGEncContext *s, uint8_t *dst,
     if (!top && pred)
         pred = PNG_FILTER_VALUE_SUB;
     if (pred == PNG_FILTER_VALUE_MIXED) {
-        int i;
         int cost, bcost = INT_MAX;
         uint8_t *buf1 = dst, *buf2 = dst + size + 16;
         for (pred = 0; pred < 5; pred++) {
             png_filter_row(s, buf1 + 1, pred, src, top, size, bpp);
             buf1[0] = pred;
-            cost = 0;
-            for (i = 0; i <= size; i++)
-                cost += abs((int8_t) buf1[i]);
+            cost = s->llvidencdsp.sum_abs_s8(buf1, size + 1);
             if (cost < bcost) {
                 bcost = cost;
                 FFSWAP(uint8_t *, buf1, buf2);
@@ -518,6 +535,167 @@ static int encode_headers(AVCodecContext *avctx, const AVFrame *pict)
     return 0;
 }
 
+#define PNG_SLICE_MIN_ROWS 16
+
+static int png_encode_slice(AVCodecContext *avctx, void *arg,
+                            int jobnr, int threadnr)
+{
+    PNGEncContext *s       = avctx->priv_data;
+    const AVFrame *pict    = arg;
+    PNGEncSliceContext *sl = &s->slices[jobnr];
+    z_stream *const zstream = &sl->zstream.zstream;
+    const int row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
+    const int bpp      = s->bits_per_pixel >> 3;
+    const int y_start  = pict->height *  jobnr      / s->nb_slices;
+    const int y_end    = pict->height * (jobnr + 1) / s->nb_slices;
+    const int last     = jobnr == s->nb_slices - 1;
+    const uint8_t *top = NULL;
+    uint8_t *crow;
+    uLong bound;
+    int y, ret;
+
+    if (deflateReset(zstream) != Z_OK)
+        return AVERROR_EXTERNAL;
+
+    if (y_start > 0) {
+        /* Seed the window with the filtered rows preceding the slice, so that
+         * matches can still reach back across the slice boundary. */
+        int dict_rows = FFMIN(y_start, 32768 / (row_size + 1) + 1);
+        int dict_len  = dict_rows * (row_size + 1);
+
+        av_fast_malloc(&sl->dict, &sl->dict_size, dict_len);
+        if (!sl->dict)
+            return AVERROR(ENOMEM);
+        for (y = y_start - dict_rows; y < y_start; y++) {
+            const uint8_t *ptr = pict->data[0] + y * pict->linesize[0];
+            top  = y ? ptr - pict->linesize[0] : NULL;
+            crow = png_choose_filter(s, sl->crow_base + 15, ptr, top, row_size, bpp);
+            memcpy(sl->dict + (y - y_start + dict_rows) * (row_size + 1), crow, row_size + 1);
+        }
+        ret = deflateSetDictionary(zstream,
+                                   sl->dict + FFMAX(dict_len - 32768, 0),
+                                   FFMIN(dict_len, 32768));
+        if (ret != Z_OK)
+            return AVERROR_EXTERNAL;
+        top = pict->data[0] + (y_start - 1) * pict->linesize[0];
+    }
+
+    sl->in_len = (y_end - y_start) * (row_size + 1);
+    bound = deflateBound(zstream, sl->in_len) + 64;
+    if (bound > INT_MAX - 6)
+        return AVERROR(ERANGE);
+    /* room for the zlib header in front of the first slice
+     * and the Adler-32 trailer behind the last one */
+    av_fast_malloc(&sl->out, &sl->out_size, bound + 6);
+    if (!sl->out)
+        return AVERROR(ENOMEM);
+    zstream->next_out  = sl->out + 2;
+    zstream->avail_out = bound;
+
+    sl->adler = adler32(0, NULL, 0);
+    for (y = y_start; y < y_end; y++) {
+        const uint8_t *ptr = pict->data[0] + y * pict->linesize[0];
+        crow = png_choose_filter(s, sl->crow_base + 15, ptr, top, row_size, bpp);
+        sl->adler = adler32(sl->adler, crow, row_size + 1);
+        zstream->next_in  = crow;
+        zstream->avail_in = row_size + 1;
+        if (deflate(zstream, Z_NO_FLUSH) != Z_OK || zstream->avail_in)
+            return AVERROR_EXTERNAL;
+        top = ptr;
+    }
+    /* A sync flush ends the slice on a byte boundary without marking the
+     * last block as final, so the slices can simply be concatenated. */
+    ret = deflate(zstream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (ret != (last ? Z_STREAM_END : Z_OK) || !zstream->avail_out)
+        return AVERROR_EXTERNAL;
+    sl->out_len = zstream->next_out - (sl->out + 2);
+
+    return 0;
+}
+
+static int encode_frame_slices(AVCodecContext *avctx, const AVFrame *pict)
+{
+    PNGEncContext *s = avctx->priv_data;
+    const int row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
+    int level_flags, ret;
+    unsigned header;
+    uLong adler;
+
+    if (s->nb_slices > s->nb_slices_allocated) {
+        PNGEncSliceContext *slices;
+        int *slice_ret = av_realloc_array(s->slice_ret, s->nb_slices,
+                                          sizeof(*s->slice_ret));
+        if (!slice_ret)
+            return AVERROR(ENOMEM);
+        s->slice_ret = slice_ret;
+        slices = av_realloc_array(s->slices, s->nb_slices, sizeof(*s->slices));
+        if (!slices)
+            return AVERROR(ENOMEM);
+        memset(slices + s->nb_slices_allocated, 0,
+               (s->nb_slices - s->nb_slices_allocated) * sizeof(*slices));
+        s->slices = slices;
+        for (; s->nb_slices_allocated < s->nb_slices; s->nb_slices_allocated++) {
+            PNGEncSliceContext *sl = &s->slices[s->nb_slices_allocated];
+            ret = ff_deflate_init2(&sl->zstream, s->compression_level,
+                                   -MAX_WBITS, avctx);
+            if (ret < 0)
+                return ret;
+        }
+    }
+    for (int i = 0; i < s->nb_slices; i++) {
+        PNGEncSliceContext *sl = &s->slices[i];
+        av_fast_malloc(&sl->crow_base, &sl->crow_size,
+                       (row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
+        if (!sl->crow_base)
+            return AVERROR(ENOMEM);
+    }
+
+    avctx->execute2(avctx, png_encode_slice, (void *)pict, s->slice_ret, s->nb_slices);
+    for (int i = 0; i < s->nb_slices; i++)
+        if (s->slice_ret[i] < 0)
+            return s->slice_ret[i];
+
+    /* zlib header as written by deflate() for the same parameters */
+    if (s->compression_level >= 0 && s->compression_level < 2)
+        level_flags = 0;
+    else if (s->compression_level >= 2 && s->compression_level < 6)
+        level_flags = 1;
+    else if (s->compression_level == 6 || s->compression_level == Z_DEFAULT_COMPRESSION)
+        level_flags = 2;
+    else
+        level_flags = 3;
+    header  = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8 | level_flags << 6;
+    header += 31 - (header % 31);
+    AV_WB16(s->slices[0].out, header);
+
+    adler = adler32(0, NULL, 0);
+    for (int i = 0; i < s->nb_slices; i++) {
+        PNGEncSliceContext *sl = &s->slices[i];
+        uint8_t *data = sl->out + 2;
+        int len       = sl->out_len;
+
+        adler = adler32_combine(adler, sl->adler, sl->in_len);
+        if (i == 0) {
+            data -= 2;
+            len  += 2;
+        }
+        if (i == s->nb_slices - 1) {
+            AV_WB32(data + len, adler);
+            len += 4;
+        }
+        while (len > 0) {
+            int chunk = FFMIN(len, IOBUF_SIZE);
+            if (s->bytestream_end - s->bytestream <= chunk + 100)
+                return AVERROR_BUG;
+            png_write_image_data(avctx, data, chunk);
+            data += chunk;
+            len  -= chunk;
+        }
+    }
+
+    return 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 {
     PNGEncContext *s       = avctx->priv_data;
@@ -532,6 +710,9 @@ static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 
     row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
 
+    if (s->nb_slices > 1 && !s->is_progressive)
+        return encode_frame_slices(avctx, pict);
+
     crow_base = av_malloc((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
     if (!crow_base) {
         ret = AVERROR(ENOMEM);
@@ -695,6 +876,12 @@ static int encode_png(AVCodecContext *avctx, AVPacket *pkt,
     if (ret < 0)
         return ret;
 
+    s->nb_slices = 1;
+    if (avctx->active_thread_type & FF_THREAD_SLICE)
+        s->nb_slices = av_clip(avctx->height / PNG_SLICE_MIN_ROWS, 1, avctx->thread_count);
+    /* sync flush markers and the extra IDAT chunk at each slice boundary */
+    max_packet_size += s->nb_slices * (64 + 12 + 12);
+
     ret = ff_alloc_packet(avctx, pkt, max_packet_size);
     if (ret < 0)
         return ret;
@@ -1247,6 +1434,7 @@ static av_cold int png_enc_init(AVCodecContext *avctx)
     compression_level = avctx->compression_level == FF_COMPRESSION_DEFAULT
                       ? Z_DEFAULT_COMPRESSION
                       : av_clip(avctx->compression_level, 0, 9);
+    s->compression_level = compression_level;
     return ff_deflate_init(&s->zstream, compression_level, avctx);
 }
 
@@ -1255,6 +1443,16 @@ static av_cold int png_enc_close(AVCodecContext *avctx)
     PNGEncContext *s = avctx->priv_data;
 
     ff_deflate_end(&s->zstream);
+    for (int i = 0; i < s->nb_slices_allocated; i++) {
+        PNGEncSliceContext *sl = &s->slices[i];
+        ff_deflate_end(&sl->zstream);
+        av_freep(&sl->crow_base);
+        av_freep(&sl->dict);
+        av_freep(&sl->out);
+    }
+    av_freep(&s->slices);
+    av_freep(&s->slice_ret);
+    s->nb_slices_allocated = 0;
     av_frame_free(&s->last_frame);
     av_frame_free(&s->prev_frame);
     av_buffer_unref(&s->exif_data);
@@ -1292,6 +1490,7 @@ const FFCodec ff_png_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_PNG,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(PNGEncContext),
     .init           = png_enc_init,
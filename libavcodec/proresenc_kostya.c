@@ -47,6 +47,7 @@ struct TrellisNode {
 
 typedef struct ProresThreadData {
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(16, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16 * 16];
     int16_t custom_q[64];
     int16_t custom_chroma_q[64];
@@ -211,9 +212,8 @@ static void encode_dcs(PutBitContext *pb, int16_t *blocks,
     }
 }
 
-static void encode_acs(PutBitContext *pb, int16_t *blocks,
-                       int blocks_per_slice,
-                       const uint8_t *scan, const int16_t *qmat)
+static void encode_acs(PutBitContext *pb, const int16_t *levels,
+                       int blocks_per_slice, const uint8_t *scan)
 {
     int idx, i;
     int prev_run = 4;
@@ -224,7 +224,7 @@ static void encode_acs(PutBitContext *pb, int16_t *blocks,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level = blocks[idx] / qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 encode_vlc_codeword(pb, ff_prores_run_to_cb[prev_run], run);
@@ -250,7 +250,8 @@ static void encode_slice_plane(ProresContext *ctx, PutBitContext *pb,
     int blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
     encode_dcs(pb, blocks, blocks_per_slice, qmat[0]);
-    encode_acs(pb, blocks, blocks_per_slice, ctx->scantable, qmat);
+    ctx->dsp.quantize(blocks, blocks, qmat, blocks_per_slice);
+    encode_acs(pb, blocks, blocks_per_slice, ctx->scantable);
 }
 
 static void put_alpha_diff(PutBitContext *pb, int cur, int prev, int abits)
@@ -445,8 +446,8 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
     return bits;
 }
 
-static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
-                        const uint8_t *scan, const int16_t *qmat)
+static int estimate_acs(const int16_t *levels, int blocks_per_slice,
+                        const uint8_t *scan)
 {
     int idx, i;
     int prev_run = 4;
@@ -460,8 +461,7 @@ static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level   = blocks[idx] / qmat[scan[i]];
-            *error += FFABS(blocks[idx]) % qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 bits += estimate_vlc(ff_prores_run_to_cb[prev_run], run);
@@ -490,8 +490,10 @@ static int estimate_slice_plane(ProresContext *ctx, int *error, int plane,
 
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
-    bits  = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
-    bits += estimate_acs(error, td->blocks[plane], blocks_per_slice, ctx->scantable, qmat);
+    bits    = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
+    *error += ctx->dsp.quantize(td->levels, td->blocks[plane], qmat,
+                                blocks_per_slice);
+    bits   += estimate_acs(td->levels, blocks_per_slice, ctx->scantable);
 
     return FFALIGN(bits, 8);
 }
@@ -936,6 +938,7 @@ static av_cold int encode_init(AVCodecContext *avctx)
 
     ctx->fdct      = prores_fdct;
     ff_fdctdsp_init(&ctx->fdsp, avctx);
+    ff_prores_encdsp_init(&ctx->dsp);
 
     if (!ctx->force_quant) {
         min_quant = ctx->profile_info->min_quant;
@@ -31,6 +31,7 @@
 #include "libavutil/mem_internal.h"
 #include "libavutil/pixfmt.h"
 #include "fdctdsp.h"
+#include "proresencdsp.h"
 
 FF_VISIBILITY_PUSH_HIDDEN
 
@@ -93,6 +94,7 @@ typedef struct ProresContext {
     void (*fdct)(FDCTDSPContext *fdsp, const uint16_t *src,
                  ptrdiff_t linesize, int16_t *block);
     FDCTDSPContext fdsp;
+    ProresEncDSPContext dsp;
 
     const struct AVFrame *pic;
     int mb_width, mb_height;
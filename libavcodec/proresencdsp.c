@@ -0,0 +1,44 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+
+#include "proresencdsp.h"
+
+static int quantize_c(int16_t *dst, const int16_t *src, const int16_t *qmat,
+                      int nb_blocks)
+{
+    int error = 0;
+
+    for (int b = 0; b < nb_blocks; b++, src += 64, dst += 64) {
+        dst[0] = src[0] / qmat[0];
+        for (int i = 1; i < 64; i++) {
+            int level = src[i];
+            error += FFABS(level) % qmat[i];
+            dst[i] = level / qmat[i];
+        }
+    }
+
+    return error;
+}
+
+av_cold void ff_prores_encdsp_init(ProresEncDSPContext *c)
+{
+    c->quantize = quantize_c;
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PRORESENCDSP_H
+#define AVCODEC_PRORESENCDSP_H
+
+#include <stdint.h>
+
+typedef struct ProresEncDSPContext {
+    /**
+     * Quantise nb_blocks 8x8 blocks of coefficients, dst = src / qmat
+     * rounded towards zero. dst may be equal to src.
+     *
+     * @return the sum of the quantisation remainders |src| % qmat of the
+     *         AC coefficients, the DC ones are coded differentially and
+     *         accounted for separately
+     */
+    int (*quantize)(int16_t *dst /* align 16 */, const int16_t *src /* align 16 */,
+                    const int16_t *qmat, int nb_blocks);
+} ProresEncDSPContext;
+
+void ff_prores_encdsp_init(ProresEncDSPContext *c);
+
+#endif /* AVCODEC_PRORESENCDSP_H */
@@ -29,12 +29,16 @@
  * @see doc/multithreading.txt
  */
 
+#include "config.h"
+
 #include "libavutil/attributes.h"
 #include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "avcodec_internal.h"
 #include "codec_internal.h"
+#include "frame_thread_encoder.h"
+#include "internal.h"
 #include "pthread_internal.h"
 
 /**
@@ -89,6 +93,22 @@ av_cold void ff_thread_free(AVCodecContext *avctx)
         ff_slice_thread_free(avctx);
 }
 
+int ff_thread_set_count(AVCodecContext *avctx, int thread_count)
+{
+    if (thread_count <= 0)
+        thread_count = avctx->thread_count;
+
+#if CONFIG_FRAME_THREAD_ENCODER
+    if (avctx->internal->frame_thread_encoder)
+        return ff_frame_thread_encoder_set_count(avctx, thread_count);
+#endif
+    if (!avctx->internal->thread_ctx)
+        return AVERROR(ENOSYS);
+    if (avctx->active_thread_type&FF_THREAD_FRAME)
+        return ff_frame_thread_set_count(avctx, thread_count);
+    return ff_slice_thread_set_count(avctx, thread_count);
+}
+
 av_cold void ff_pthread_free(void *obj, const unsigned offsets[])
 {
     unsigned cnt = *(unsigned*)((char*)obj + offsets[0]);
@@ -142,6 +142,10 @@ typedef struct FrameThreadContext {
 
     int next_decoding;             ///< The next context to submit a packet to.
     int next_finished;             ///< The next context to return output from.
+    int nb_pending;                ///< Number of packets submitted and not returned yet.
+
+    int        nb_threads;         ///< Number of contexts packets are submitted to.
+    atomic_int nb_threads_req;     ///< Set by ff_frame_thread_set_count().
 
     /* hwaccel state for thread-unsafe hwaccels is temporarily stored here in
      * order to transfer its ownership to the next decoding thread without the
@@ -547,7 +551,8 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     pthread_mutex_unlock(&p->mutex);
 
     fctx->prev_thread = p;
-    fctx->next_decoding = (fctx->next_decoding + 1) % p->avctx->thread_count;
+    fctx->next_decoding = (fctx->next_decoding + 1) % fctx->nb_threads;
+    fctx->nb_pending++;
 
     return 0;
 }
@@ -565,6 +570,16 @@ int ff_thread_receive_frame(AVCodecContext *avctx, AVFrame *frame, unsigned flag
     while (!fctx->df.nb_f && !fctx->result) {
         PerThreadContext *p;
 
+        /* The number of threads can only change once all the packets in
+         * flight have been returned, as they are submitted round-robin. */
+        if (atomic_load_explicit(&fctx->nb_threads_req, memory_order_relaxed) != fctx->nb_threads &&
+            !avctx->internal->draining) {
+            if (fctx->nb_pending)
+                goto wait_for_result;
+            fctx->nb_threads    = atomic_load_explicit(&fctx->nb_threads_req, memory_order_relaxed);
+            fctx->next_decoding = fctx->next_finished = 0;
+        }
+
         if (fctx->next_decoding != fctx->next_finished &&
             (flags & AV_CODEC_RECEIVE_FRAME_FLAG_SYNCHRONOUS))
             goto wait_for_result;
@@ -587,7 +602,8 @@ int ff_thread_receive_frame(AVCodecContext *avctx, AVFrame *frame, unsigned flag
 
     wait_for_result:
         p                   = &fctx->threads[fctx->next_finished];
-        fctx->next_finished = (fctx->next_finished + 1) % avctx->thread_count;
+        fctx->next_finished = (fctx->next_finished + 1) % fctx->nb_threads;
+        fctx->nb_pending--;
 
         if (atomic_load(&p->state) != STATE_INPUT_READY) {
             pthread_mutex_lock(&p->progress_mutex);
@@ -942,6 +958,8 @@ av_cold int ff_frame_thread_init(AVCodecContext *avctx)
         return AVERROR(ENOMEM);
 
     fctx->async_lock = 1;
+    fctx->nb_threads = thread_count;
+    atomic_init(&fctx->nb_threads_req, thread_count);
 
     if (codec->p.type == AVMEDIA_TYPE_VIDEO)
         avctx->delay = avctx->thread_count - 1;
@@ -982,6 +1000,8 @@ av_cold void ff_thread_flush(AVCodecContext *avctx)
     }
 
     fctx->next_decoding = fctx->next_finished = 0;
+    fctx->nb_pending    = 0;
+    fctx->nb_threads    = atomic_load_explicit(&fctx->nb_threads_req, memory_order_relaxed);
     fctx->prev_thread = NULL;
 
     decoded_frames_flush(&fctx->df);
@@ -997,6 +1017,15 @@ av_cold void ff_thread_flush(AVCodecContext *avctx)
     }
 }
 
+int ff_frame_thread_set_count(AVCodecContext *avctx, int thread_count)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+
+    thread_count = av_clip(thread_count, 1, avctx->thread_count);
+    atomic_store_explicit(&fctx->nb_threads_req, thread_count, memory_order_relaxed);
+    return thread_count;
+}
+
 int ff_thread_can_start_frame(AVCodecContext *avctx)
 {
     if ((avctx->active_thread_type & FF_THREAD_FRAME) &&
@@ -31,6 +31,15 @@ void ff_slice_thread_free(AVCodecContext *avctx);
 int ff_frame_thread_init(AVCodecContext *avctx);
 void ff_frame_thread_free(AVCodecContext *avctx, int thread_count);
 
+/**
+ * Request a new number of threads for an open context, clipped to the
+ * number of threads started at init. Used by ff_thread_set_count().
+ *
+ * @return the number of threads that will be used
+ */
+int ff_slice_thread_set_count(AVCodecContext *avctx, int thread_count);
+int ff_frame_thread_set_count(AVCodecContext *avctx, int thread_count);
+
 #define THREAD_SENTINEL 0 // This forbids putting a mutex/condition variable at the front.
 /**
  * Initialize/destroy a list of mutexes/conditions contained in a structure.
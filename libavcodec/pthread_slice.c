@@ -22,6 +22,8 @@
  * @see doc/multithreading.txt
  */
 
+#include <stdatomic.h>
+
 #include "avcodec.h"
 #include "codec_internal.h"
 #include "internal.h"
@@ -46,6 +48,9 @@ typedef struct SliceThreadContext {
     void *args;
     int *rets;
     int job_size;
+
+    int        nb_threads;      ///< number of threads used by the next execution
+    atomic_int nb_threads_req;  ///< set by ff_slice_thread_set_count()
 } SliceThreadContext;
 
 static void main_function(void *priv) {
@@ -85,6 +90,11 @@ static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, i
     if (job_count <= 0)
         return 0;
 
+    if (atomic_load_explicit(&c->nb_threads_req, memory_order_relaxed) != c->nb_threads) {
+        c->nb_threads = atomic_load_explicit(&c->nb_threads_req, memory_order_relaxed);
+        avpriv_slicethread_set_threads(c->thread, c->nb_threads);
+    }
+
     c->job_size = job_size;
     c->args = arg;
     c->func = func;
@@ -144,8 +154,19 @@ av_cold int ff_slice_thread_init(AVCodecContext *avctx)
         return thread_count < 0 ? thread_count : 0;
     }
     avctx->thread_count = thread_count;
+    c->nb_threads       = thread_count;
+    atomic_init(&c->nb_threads_req, thread_count);
 
     avctx->execute = thread_execute;
     avctx->execute2 = thread_execute2;
     return 0;
 }
+
+int ff_slice_thread_set_count(AVCodecContext *avctx, int thread_count)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+
+    thread_count = av_clip(thread_count, 1, avctx->thread_count);
+    atomic_store_explicit(&c->nb_threads_req, thread_count, memory_order_relaxed);
+    return thread_count;
+}
@@ -73,6 +73,7 @@ static int qoi_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_qoi_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_QOI),
     .priv_data_size = sizeof(QOIParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = qoi_parse,
     .close          = ff_parse_close,
 };
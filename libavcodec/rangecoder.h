@@ -84,24 +84,47 @@ static inline int get_rac_count(RangeCoder *c)
     return 8 * x - av_log2(c->range);
 }
 
-static inline void put_rac(RangeCoder *c, uint8_t *const state, int bit)
+/**
+ * Code a bit with the coder state held in *low and *range instead of c.
+ * Meant for sequences of bits, where keeping the state in local variables
+ * avoids reloading it after every store through state, which may alias c.
+ * c->low and c->range are only synchronised around renormalisation.
+ */
+static av_always_inline void put_rac_local(RangeCoder *c, int *low, int *range,
+                                           uint8_t *const state, int bit)
 {
-    int range1 = (c->range * (*state)) >> 8;
+    const int s = *state;
+    int range1  = (*range * s) >> 8;
 
-    av_assert2(*state);
-    av_assert2(range1 < c->range);
+    av_assert2(s);
+    av_assert2(range1 < *range);
     av_assert2(range1 > 0);
     if (!bit) {
-        c->range -= range1;
-        *state    = c->zero_state[*state];
+        *range -= range1;
+        *state  = c->zero_state[s];
     } else {
-        c->low  += c->range - range1;
-        c->range = range1;
-        *state   = c->one_state[*state];
+        *low   += *range - range1;
+        *range  = range1;
+        *state  = c->one_state[s];
     }
 
-    if (c->range < 0x100)
+    if (*range < 0x100) {
+        c->low   = *low;
+        c->range = *range;
         renorm_encoder(c);
+        *low     = c->low;
+        *range   = c->range;
+    }
+}
+
+static inline void put_rac(RangeCoder *c, uint8_t *const state, int bit)
+{
+    int low   = c->low;
+    int range = c->range;
+
+    put_rac_local(c, &low, &range, state, bit);
+    c->low   = low;
+    c->range = range;
 }
 
 static inline void refill(RangeCoder *c)
@@ -493,6 +493,33 @@ static int init_pass2(MPVMainEncContext *const m)
     return 0;
 }
 
+void ff_rate_control_reset(RateControlContext *rcc)
+{
+    for (int i = 0; i < 5; i++) {
+        rcc->pred[i].coeff = FF_QP2LAMBDA * 7.0;
+        rcc->pred[i].count = 1.0;
+        rcc->pred[i].decay = 0.4;
+
+        rcc->i_cplx_sum [i] =
+        rcc->p_cplx_sum [i] =
+        rcc->mv_bits_sum[i] =
+        rcc->qscale_sum [i] =
+        rcc->frame_count[i] = 1; // 1 is better because of 1/0 and such
+
+        rcc->last_qscale_for[i] = FF_QP2LAMBDA * 5;
+    }
+    rcc->short_term_qsum   = 0.001;
+    rcc->short_term_qcount = 0.001;
+
+    rcc->pass1_rc_eq_output_sum = 0.001;
+    rcc->pass1_wanted_bits      = 0.001;
+
+    rcc->last_qscale          = 0;
+    rcc->last_mc_mb_var_sum   = 0;
+    rcc->last_mb_var_sum      = 0;
+    rcc->last_non_b_pict_type = 0;
+}
+
 av_cold int ff_rate_control_init(MPVMainEncContext *const m)
 {
     MPVEncContext  *const s = &m->s;
@@ -549,19 +576,7 @@ av_cold int ff_rate_control_init(MPVMainEncContext *const m)
         return res;
     }
 
-    for (i = 0; i < 5; i++) {
-        rcc->pred[i].coeff = FF_QP2LAMBDA * 7.0;
-        rcc->pred[i].count = 1.0;
-        rcc->pred[i].decay = 0.4;
-
-        rcc->i_cplx_sum [i] =
-        rcc->p_cplx_sum [i] =
-        rcc->mv_bits_sum[i] =
-        rcc->qscale_sum [i] =
-        rcc->frame_count[i] = 1; // 1 is better because of 1/0 and such
-
-        rcc->last_qscale_for[i] = FF_QP2LAMBDA * 5;
-    }
+    ff_rate_control_reset(rcc);
     rcc->buffer_index = avctx->rc_initial_buffer_occupancy;
     if (!rcc->buffer_index)
         rcc->buffer_index = avctx->rc_buffer_size * 3 / 4;
@@ -638,12 +653,6 @@ av_cold int ff_rate_control_init(MPVMainEncContext *const m)
     }
 
     if (!(avctx->flags & AV_CODEC_FLAG_PASS2)) {
-        rcc->short_term_qsum   = 0.001;
-        rcc->short_term_qcount = 0.001;
-
-        rcc->pass1_rc_eq_output_sum = 0.001;
-        rcc->pass1_wanted_bits      = 0.001;
-
         if (avctx->qblur > 1.0) {
             av_log(avctx, AV_LOG_ERROR, "qblur too large\n");
             return -1;
@@ -928,7 +937,7 @@ float ff_rate_estimate_qscale(MPVMainEncContext *const m, int dry_run)
 
     fps = get_fps(s->c.avctx);
     /* update predictors */
-    if (picture_number > 2 && !dry_run) {
+    if (picture_number > 2 && !dry_run && m->last_pict_type) {
         const int64_t last_var =
             m->last_pict_type == AV_PICTURE_TYPE_I ? rcc->last_mb_var_sum
                                                    : rcc->last_mc_mb_var_sum;
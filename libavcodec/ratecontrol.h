@@ -97,6 +97,11 @@ typedef struct MPVMainEncContext MPVMainEncContext;
 
 /* rate control */
 int ff_rate_control_init(MPVMainEncContext *m);
+/**
+ * Reset the adaptive one-pass state (size predictors, complexity sums and
+ * qscale history) to the values it has before the first frame.
+ */
+void ff_rate_control_reset(RateControlContext *rcc);
 float ff_rate_estimate_qscale(MPVMainEncContext *m, int dry_run);
 void ff_write_pass1_stats(MPVMainEncContext *m);
 int ff_vbv_update(MPVMainEncContext *m, int frame_size);
@@ -120,6 +120,7 @@ static int sbc_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_sbc_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_SBC),
     .priv_data_size = sizeof(SBCParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = sbc_parse,
     .close          = ff_parse_close,
 };
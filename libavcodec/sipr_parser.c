@@ -70,6 +70,7 @@ static int sipr_parse(AVCodecParserContext *s1, AVCodecContext *avctx,
 const FFCodecParser ff_sipr_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_SIPR),
     .priv_data_size = sizeof(SiprParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = sipr_parse,
     .close          = ff_parse_close,
 };
@@ -275,6 +275,7 @@ static av_cold int vc1_parse_init(AVCodecParserContext *s)
 const FFCodecParser ff_vc1_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_VC1),
     .priv_data_size = sizeof(VC1ParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = vc1_parse_init,
     .parse          = vc1_parse,
     .close          = ff_parse_close,
@@ -36,6 +36,7 @@
 #include "vorbis.h"
 #include "vorbis_data.h"
 #include "vorbis_enc_data.h"
+#include "vorbisencdsp.h"
 
 #include "audio_frame_queue.h"
 #include "libavfilter/bufferqueue.h"
@@ -58,6 +59,8 @@ typedef struct vorbis_enc_codebook {
     int *quantlist;
     float *dimensions;
     float *pow2;
+    float *dimensions_t;  ///< dimensions transposed for vq_search()
+    int nentries_padded;  ///< row size of dimensions_t and size of pow2
 } vorbis_enc_codebook;
 
 typedef struct vorbis_enc_floor_class {
@@ -87,6 +90,7 @@ typedef struct vorbis_enc_residue {
     int classbook;
     int8_t (*books)[8];
     float (*maxes)[2];
+    int *entries;         ///< chosen codebook entries, per partition and pass
 } vorbis_enc_residue;
 
 typedef struct vorbis_enc_mapping {
@@ -140,6 +144,7 @@ typedef struct vorbis_enc_context {
     int64_t next_pts;
 
     AVFloatDSPContext *fdsp;
+    VorbisEncDSPContext dsp;
 } vorbis_enc_context;
 
 #define MAX_CHANNELS     2
@@ -181,12 +186,14 @@ static int ready_codebook(vorbis_enc_codebook *cb)
     ff_vorbis_len2vlc(cb->lens, cb->codewords, cb->nentries);
 
     if (!cb->lookup) {
-        cb->pow2 = cb->dimensions = NULL;
+        cb->pow2 = cb->dimensions = cb->dimensions_t = NULL;
     } else {
         int vals = cb_lookup_vals(cb->lookup, cb->ndimensions, cb->nentries);
+        cb->nentries_padded = FFALIGN(cb->nentries, 8);
         cb->dimensions = av_malloc_array(cb->nentries, sizeof(float) * cb->ndimensions);
-        cb->pow2 = av_calloc(cb->nentries, sizeof(*cb->pow2));
-        if (!cb->dimensions || !cb->pow2)
+        cb->dimensions_t = av_calloc(cb->nentries_padded, sizeof(float) * cb->ndimensions);
+        cb->pow2 = av_calloc(cb->nentries_padded, sizeof(*cb->pow2));
+        if (!cb->dimensions || !cb->dimensions_t || !cb->pow2)
             return AVERROR(ENOMEM);
         for (i = 0; i < cb->nentries; i++) {
             float last = 0;
@@ -207,6 +214,18 @@ static int ready_codebook(vorbis_enc_codebook *cb)
             }
             cb->pow2[i] /= 2.0;
         }
+
+        /* Unused entries and the padding can never be the closest. */
+        for (i = 0; i < cb->nentries_padded; i++) {
+            int j;
+            if (i >= cb->nentries || !cb->lens[i]) {
+                cb->pow2[i] = INFINITY;
+                continue;
+            }
+            for (j = 0; j < cb->ndimensions; j++)
+                cb->dimensions_t[j * cb->nentries_padded + i] =
+                    cb->dimensions[i * cb->ndimensions + j];
+        }
     }
     return 0;
 }
@@ -216,7 +235,8 @@ static int ready_residue(vorbis_enc_residue *rc, vorbis_enc_context *venc)
     int i;
     av_assert0(rc->type == 2);
     rc->maxes = av_calloc(rc->classifications, sizeof(*rc->maxes));
-    if (!rc->maxes)
+    rc->entries = av_malloc_array((rc->end - rc->begin) * 8, sizeof(*rc->entries));
+    if (!rc->maxes || !rc->entries)
         return AVERROR(ENOMEM);
     for (i = 0; i < rc->classifications; i++) {
         int j;
@@ -259,6 +279,8 @@ static av_cold int dsp_init(AVCodecContext *avctx, vorbis_enc_context *venc)
     if (!venc->fdsp)
         return AVERROR(ENOMEM);
 
+    ff_vorbisenc_dsp_init(&venc->dsp);
+
     // init windows
     venc->win[0] = ff_vorbis_vwin[venc->log2_blocksize[0] - 6];
     venc->win[1] = ff_vorbis_vwin[venc->log2_blocksize[1] - 6];
@@ -892,32 +914,81 @@ static int floor_encode(vorbis_enc_context *venc, vorbis_enc_floor *fc,
     return 0;
 }
 
-static float *put_vector(vorbis_enc_codebook *book, PutBitContext *pb,
-                         float *num)
+typedef struct vorbis_enc_residue_search {
+    vorbis_enc_context *venc;
+    vorbis_enc_residue *rc;
+    float *coeffs;
+    int samples;
+    int real_ch;
+    int partitions;
+    int nb_jobs;
+    const int *classes;
+} vorbis_enc_residue_search;
+
+/**
+ * Quantise all passes of a range of partitions and store the chosen entries
+ * in rc->entries. Every partition only touches its own coefficients, so
+ * partitions can be searched in any order, the codewords are written
+ * afterwards in bitstream order.
+ */
+static int residue_search(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int i, entry = -1;
-    float distance = FLT_MAX;
-    assert(book->dimensions);
-    for (i = 0; i < book->nentries; i++) {
-        float * vec = book->dimensions + i * book->ndimensions, d = book->pow2[i];
-        int j;
-        if (!book->lens[i])
-            continue;
-        for (j = 0; j < book->ndimensions; j++)
-            d -= vec[j] * num[j];
-        if (distance > d) {
-            entry    = i;
-            distance = d;
+    const vorbis_enc_residue_search *rs = arg;
+    vorbis_enc_context *venc = rs->venc;
+    vorbis_enc_residue *rc   = rs->rc;
+    float *coeffs = rs->coeffs;
+    int psize     = rc->partition_size;
+    int samples   = rs->samples;
+    int real_ch   = rs->real_ch;
+    int p_start   = rs->partitions *  jobnr      / rs->nb_jobs;
+    int p_end     = rs->partitions * (jobnr + 1) / rs->nb_jobs;
+
+    for (int p = p_start; p < p_end; p++) {
+        for (int pass = 0; pass < 8; pass++) {
+            int nbook = rc->books[rs->classes[p]][pass];
+            vorbis_enc_codebook *book = &venc->codebooks[nbook];
+            int *entries = rc->entries + (p * 8 + pass) * psize;
+            int s = rc->begin + p * psize, a1, b1, k;
+            if (nbook == -1)
+                continue;
+
+            assert(!(psize % book->ndimensions));
+
+            a1 = (s % real_ch) * samples;
+            b1 =  s / real_ch;
+            s  = real_ch * samples;
+            for (k = 0; k < psize; k += book->ndimensions) {
+                int dim, a2 = a1, b2 = b1, entry;
+                float vec[MAX_CODEBOOK_DIM], *pv = vec;
+                for (dim = book->ndimensions; dim--; ) {
+                    *pv++ = coeffs[a2 + b2];
+                    if ((a2 += samples) == s) {
+                        a2 = 0;
+                        b2++;
+                    }
+                }
+                entry = venc->dsp.vq_search(vec, book->pow2, book->dimensions_t,
+                                            book->nentries_padded, book->ndimensions);
+                *entries++ = entry;
+                if (entry < 0)
+                    break;
+                pv = &book->dimensions[entry * book->ndimensions];
+                for (dim = book->ndimensions; dim--; ) {
+                    coeffs[a1 + b1] -= *pv++;
+                    if ((a1 += samples) == s) {
+                        a1 = 0;
+                        b1++;
+                    }
+                }
+            }
         }
     }
-    if (put_codeword(pb, book, entry))
-        return NULL;
-    return &book->dimensions[entry * book->ndimensions];
+    return 0;
 }
 
-static int residue_encode(vorbis_enc_context *venc, vorbis_enc_residue *rc,
-                          PutBitContext *pb, float *coeffs, int samples,
-                          int real_ch)
+static int residue_encode(AVCodecContext *avctx, vorbis_enc_context *venc,
+                          vorbis_enc_residue *rc, PutBitContext *pb,
+                          float *coeffs, int samples, int real_ch)
 {
     int pass, i, j, p, k;
     int psize      = rc->partition_size;
@@ -925,6 +996,7 @@ static int residue_encode(vorbis_enc_context *venc, vorbis_enc_residue *rc,
     int channels   = (rc->type == 2) ? 1 : real_ch;
     int classes[MAX_CHANNELS][NUM_RESIDUE_PARTITIONS];
     int classwords = venc->codebooks[rc->classbook].ndimensions;
+    vorbis_enc_residue_search rs;
 
     av_assert0(rc->type == 2);
     av_assert0(real_ch == 2);
@@ -942,6 +1014,19 @@ static int residue_encode(vorbis_enc_context *venc, vorbis_enc_residue *rc,
         classes[0][p] = i;
     }
 
+    rs = (vorbis_enc_residue_search) {
+        .venc       = venc,
+        .rc         = rc,
+        .coeffs     = coeffs,
+        .samples    = samples,
+        .real_ch    = real_ch,
+        .partitions = partitions,
+        .nb_jobs    = FFMIN(avctx->thread_count, partitions),
+        .classes    = classes[0],
+    };
+    rs.nb_jobs = FFMAX(rs.nb_jobs, 1);
+    avctx->execute2(avctx, residue_search, &rs, NULL, rs.nb_jobs);
+
     for (pass = 0; pass < 8; pass++) {
         p = 0;
         while (p < partitions) {
@@ -960,48 +1045,14 @@ static int residue_encode(vorbis_enc_context *venc, vorbis_enc_residue *rc,
                 for (j = 0; j < channels; j++) {
                     int nbook = rc->books[classes[j][p]][pass];
                     vorbis_enc_codebook * book = &venc->codebooks[nbook];
-                    float *buf = coeffs + samples*j + rc->begin + p*psize;
+                    const int *entries = rc->entries + (p * 8 + pass) * psize;
                     if (nbook == -1)
                         continue;
 
-                    assert(rc->type == 0 || rc->type == 2);
-                    assert(!(psize % book->ndimensions));
-
-                    if (rc->type == 0) {
-                        for (k = 0; k < psize; k += book->ndimensions) {
-                            int l;
-                            float *a = put_vector(book, pb, &buf[k]);
-                            if (!a)
-                                return AVERROR(EINVAL);
-                            for (l = 0; l < book->ndimensions; l++)
-                                buf[k + l] -= a[l];
-                        }
-                    } else {
-                        int s = rc->begin + p * psize, a1, b1;
-                        a1 = (s % real_ch) * samples;
-                        b1 =  s / real_ch;
-                        s  = real_ch * samples;
-                        for (k = 0; k < psize; k += book->ndimensions) {
-                            int dim, a2 = a1, b2 = b1;
-                            float vec[MAX_CODEBOOK_DIM], *pv = vec;
-                            for (dim = book->ndimensions; dim--; ) {
-                                *pv++ = coeffs[a2 + b2];
-                                if ((a2 += samples) == s) {
-                                    a2 = 0;
-                                    b2++;
-                                }
-                            }
-                            pv = put_vector(book, pb, vec);
-                            if (!pv)
-                                return AVERROR(EINVAL);
-                            for (dim = book->ndimensions; dim--; ) {
-                                coeffs[a1 + b1] -= *pv++;
-                                if ((a1 += samples) == s) {
-                                    a1 = 0;
-                                    b1++;
-                                }
-                            }
-                        }
+                    for (k = 0; k < psize; k += book->ndimensions) {
+                        int entry = *entries++;
+                        if (entry < 0 || put_codeword(pb, book, entry))
+                            return AVERROR(EINVAL);
                     }
                 }
             }
@@ -1187,7 +1238,7 @@ static int vorbis_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
         }
     }
 
-    if (residue_encode(venc, &venc->residues[mapping->residue[mapping->mux[0]]],
+    if (residue_encode(avctx, venc, &venc->residues[mapping->residue[mapping->mux[0]]],
                        &pb, venc->coeffs, frame_size, venc->channels)) {
         av_log(avctx, AV_LOG_ERROR, "output buffer is too small\n");
         return AVERROR(EINVAL);
@@ -1223,6 +1274,7 @@ static av_cold int vorbis_encode_close(AVCodecContext *avctx)
             av_freep(&venc->codebooks[i].codewords);
             av_freep(&venc->codebooks[i].quantlist);
             av_freep(&venc->codebooks[i].dimensions);
+            av_freep(&venc->codebooks[i].dimensions_t);
             av_freep(&venc->codebooks[i].pow2);
         }
     av_freep(&venc->codebooks);
@@ -1243,6 +1295,7 @@ static av_cold int vorbis_encode_close(AVCodecContext *avctx)
         for (i = 0; i < venc->nresidues; i++) {
             av_freep(&venc->residues[i].books);
             av_freep(&venc->residues[i].maxes);
+            av_freep(&venc->residues[i].entries);
         }
     av_freep(&venc->residues);
 
@@ -1311,7 +1364,7 @@ const FFCodec ff_vorbis_encoder = {
     .p.type         = AVMEDIA_TYPE_AUDIO,
     .p.id           = AV_CODEC_ID_VORBIS,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_EXPERIMENTAL,
+                      AV_CODEC_CAP_EXPERIMENTAL | AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(vorbis_enc_context),
     .init           = vorbis_encode_init,
     FF_CODEC_ENCODE_CB(vorbis_encode_frame),
@@ -0,0 +1,46 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <float.h>
+
+#include "libavutil/attributes.h"
+#include "vorbisencdsp.h"
+
+static int vq_search_c(const float *num, const float *pow2, const float *dims,
+                       int nentries, int ndim)
+{
+    float distance = FLT_MAX;
+    int entry = -1;
+
+    for (int i = 0; i < nentries; i++) {
+        float d = pow2[i];
+        for (int j = 0; j < ndim; j++)
+            d -= dims[j * nentries + i] * num[j];
+        if (distance > d) {
+            entry    = i;
+            distance = d;
+        }
+    }
+
+    return entry;
+}
+
+av_cold void ff_vorbisenc_dsp_init(VorbisEncDSPContext *s)
+{
+    s->vq_search = vq_search_c;
+}
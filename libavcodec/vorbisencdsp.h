@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_VORBISENCDSP_H
+#define AVCODEC_VORBISENCDSP_H
+
+typedef struct VorbisEncDSPContext {
+    /**
+     * Find the codebook entry closest to num, i.e. the first entry i
+     * minimising pow2[i] - sum over j of dims[j * nentries + i] * num[j].
+     *
+     * @param num      vector of ndim values to quantise
+     * @param pow2     half the squared norm of each entry, +infinity for
+     *                 unused entries
+     * @param dims     entry values, transposed: ndim rows of nentries values
+     * @param nentries number of entries, a multiple of 8, with pow2 and every
+     *                 row of dims 16-byte aligned
+     * @return the index of the entry, -1 if none is usable
+     */
+    int (*vq_search)(const float *num, const float *pow2, const float *dims,
+                     int nentries, int ndim);
+} VorbisEncDSPContext;
+
+void ff_vorbisenc_dsp_init(VorbisEncDSPContext *s);
+
+#endif /* AVCODEC_VORBISENCDSP_H */
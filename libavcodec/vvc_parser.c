@@ -503,12 +503,13 @@ static av_cold void vvc_parser_close(AVCodecParserContext *s)
     ff_cbs_fragment_free(&ctx->picture_unit);
 
     ff_cbs_close(&ctx->cbc);
-    av_freep(&ctx->pc.buffer);
+    av_buffer_unref(&ctx->pc.buf);
 }
 
 const FFCodecParser ff_vvc_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_VVC),
     .priv_data_size = sizeof(VVCParserContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .init           = vvc_parser_init,
     .close          = vvc_parser_close,
     .parse          = vvc_parser_parse,
@@ -108,6 +108,7 @@ flush:
 const FFCodecParser ff_webp_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_WEBP),
     .priv_data_size = sizeof(WebPParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = webp_parse,
     .close          = ff_parse_close,
 };
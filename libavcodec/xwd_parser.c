@@ -99,6 +99,7 @@ static int xwd_parse(AVCodecParserContext *s, AVCodecContext *avctx,
 const FFCodecParser ff_xwd_parser = {
     PARSER_CODEC_LIST(AV_CODEC_ID_XWD),
     .priv_data_size = sizeof(XWDParseContext),
+    .caps_internal  = FF_PARSER_CAP_PARSE_CONTEXT,
     .parse          = xwd_parse,
     .close          = ff_parse_close,
 };
@@ -1251,20 +1251,26 @@ static int parse_packet(AVFormatContext *s, AVPacket *pkt,
         if (!out_pkt->size)
             continue;
 
-        if (pkt->buf && out_pkt->data == pkt->data) {
-            /* reference pkt->buf only when out_pkt->data is guaranteed to point
-             * to data in it and not in the parser's internal buffer. */
-            /* XXX: Ensure this is the case with all parsers when sti->parser->flags
-             * is PARSER_FLAG_COMPLETE_FRAMES and check for that instead? */
+        if (pkt->buf && out_pkt->data >= pkt->data &&
+            out_pkt->data + out_pkt->size == pkt->data + pkt->size) {
+            /* The frame is the tail of the input packet, so reference pkt->buf
+             * instead of copying it. Frames ending earlier are followed by the
+             * next frame rather than zero padding and have to be copied. */
             out_pkt->buf = av_buffer_ref(pkt->buf);
             if (!out_pkt->buf) {
                 ret = AVERROR(ENOMEM);
                 goto fail;
             }
         } else {
-            ret = av_packet_make_refcounted(out_pkt);
-            if (ret < 0)
-                goto fail;
+            /* Take over the parser's buffer if the frame was assembled in it,
+             * copy it otherwise. */
+            out_pkt->buf = avpriv_parser_get_buffer(sti->parser, &out_pkt->data,
+                                                    out_pkt->size);
+            if (!out_pkt->buf) {
+                ret = av_packet_make_refcounted(out_pkt);
+                if (ret < 0)
+                    goto fail;
+            }
         }
 
         /* set the duration */
@@ -176,6 +176,37 @@ typedef struct MOVIndexRange {
     int64_t end;
 } MOVIndexRange;
 
+/**
+ * Consecutive chunks sharing one stsc entry.
+ */
+typedef struct MOVChunkRun {
+    unsigned int first_chunk;        ///< index of the first chunk
+    unsigned int samples_per_chunk;
+    unsigned int first_sample;       ///< index of the first sample
+} MOVChunkRun;
+
+/**
+ * Sample table kept in run-length form instead of one AVIndexEntry per
+ * sample, see the compact_index option. Sample positions and timestamps are
+ * resolved from the stsc/stsz/stco runs and tts_data when needed.
+ */
+typedef struct MOVCompactIndex {
+    unsigned int nb_samples;
+    MOVChunkRun *chunk_runs;
+    unsigned int nb_chunk_runs;
+    unsigned int *tts_first_sample;  ///< first sample of each tts_data entry
+    int64_t *tts_dts;                ///< dts of the first sample of each tts_data entry
+    int key_off;
+
+    /* last resolved sample, so that sequential reads are O(1) */
+    AVIndexEntry entry;
+    int sample;
+    unsigned int run;
+    unsigned int chunk_sample;       ///< index of the sample within its chunk
+    unsigned int tts_index;
+    unsigned int tts_sample;
+} MOVCompactIndex;
+
 typedef struct MOVStreamContext {
     AVIOContext *pb;
     int refcount;
@@ -220,6 +251,7 @@ typedef struct MOVStreamContext {
     int64_t current_index;
     MOVIndexRange* index_ranges;
     MOVIndexRange* current_index_range;
+    MOVCompactIndex *compact_index;
     unsigned int bytes_per_frame;
     unsigned int samples_per_frame;
     int dv_audio_container;
@@ -389,6 +421,7 @@ typedef struct MOVContext {
     int nb_heif_grid;
     int64_t idat_offset;
     int interleaved_read;
+    int compact_index;
     AVDictionary* decryption_keys;
     unsigned heif_icc_profile_items;
 } MOVContext;
@@ -4397,11 +4397,213 @@ static int add_tts_entry(MOVTimeToSample **tts_data, unsigned int *tts_count, un
     return 0;
 }
 
+static int mov_find_sorted(const unsigned *array, unsigned int count, unsigned int value)
+{
+    unsigned int lo = 0, hi = count;
+
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (array[mid] == value)
+            return 1;
+        if (array[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return 0;
+}
+
+static int mov_compact_index_is_key(const AVStream *st, const MOVStreamContext *sc,
+                                    unsigned int sample)
+{
+    const MOVCompactIndex *ci = sc->compact_index;
+
+    if (!sc->keyframe_absent) {
+        if (!sc->keyframe_count ||
+            mov_find_sorted((const unsigned *)sc->keyframes, sc->keyframe_count,
+                            sample + ci->key_off))
+            return 1;
+    }
+    if (sc->stps_count)
+        return mov_find_sorted(sc->stps_data, sc->stps_count, sample + ci->key_off);
+    if (sc->keyframe_absent)
+        return st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO || !sample;
+    return 0;
+}
+
+/* last tts entry starting at or before sample */
+static unsigned int mov_compact_index_tts_index(const MOVStreamContext *sc,
+                                                unsigned int sample)
+{
+    const MOVCompactIndex *ci = sc->compact_index;
+    unsigned int lo = 0, hi = sc->tts_count;
+
+    while (hi - lo > 1) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (ci->tts_first_sample[mid] <= sample)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int64_t mov_compact_index_dts(const MOVStreamContext *sc, unsigned int sample)
+{
+    const MOVCompactIndex *ci = sc->compact_index;
+    unsigned int i = mov_compact_index_tts_index(sc, sample);
+
+    /* the duration of the last entry also applies to the samples it does not cover */
+    return ci->tts_dts[i] +
+           (int64_t)(sample - ci->tts_first_sample[i]) * sc->tts_data[i].duration;
+}
+
+static unsigned int mov_compact_index_sample_size(const MOVStreamContext *sc,
+                                                  unsigned int sample)
+{
+    return sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[sample];
+}
+
+/**
+ * Resolve a sample of a compact index into its scratch entry. The entry stays
+ * valid until the next call for the same stream.
+ */
+static AVIndexEntry *mov_compact_index_get(const AVStream *st, MOVStreamContext *sc,
+                                           int sample)
+{
+    MOVCompactIndex *ci = sc->compact_index;
+    AVIndexEntry *e = &ci->entry;
+    const MOVChunkRun *run;
+
+    if (sample == ci->sample)
+        return e;
+
+    if (ci->sample >= 0 && sample == ci->sample + 1 &&
+        ci->chunk_sample + 1 < ci->chunk_runs[ci->run].samples_per_chunk) {
+        /* next sample in the same chunk */
+        e->pos += e->size;
+        ci->chunk_sample++;
+    } else {
+        unsigned int lo = 0, hi = ci->nb_chunk_runs;
+        unsigned int chunk, first;
+
+        while (hi - lo > 1) {
+            unsigned int mid = lo + (hi - lo) / 2;
+            if (ci->chunk_runs[mid].first_sample <= sample)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        run   = &ci->chunk_runs[lo];
+        chunk = run->first_chunk + (sample - run->first_sample) / run->samples_per_chunk;
+        first = sample - (sample - run->first_sample) % run->samples_per_chunk;
+
+        ci->run          = lo;
+        ci->chunk_sample = sample - first;
+        e->pos = sc->chunk_offsets[chunk];
+        if (sc->stsz_sample_size > 0) {
+            e->pos += (int64_t)ci->chunk_sample * sc->stsz_sample_size;
+        } else {
+            for (unsigned int i = first; i < sample; i++)
+                e->pos += sc->sample_sizes[i];
+        }
+    }
+
+    if (ci->sample >= 0 && sample == ci->sample + 1) {
+        e->timestamp += sc->tts_data[ci->tts_index].duration;
+        if (ci->tts_index + 1 < sc->tts_count &&
+            ++ci->tts_sample == sc->tts_data[ci->tts_index].count) {
+            ci->tts_index++;
+            ci->tts_sample = 0;
+        }
+    } else {
+        e->timestamp   = mov_compact_index_dts(sc, sample);
+        ci->tts_index  = mov_compact_index_tts_index(sc, sample);
+        ci->tts_sample = sample - ci->tts_first_sample[ci->tts_index];
+    }
+
+    e->size         = mov_compact_index_sample_size(sc, sample);
+    e->flags        = mov_compact_index_is_key(st, sc, sample) ? AVINDEX_KEYFRAME : 0;
+    e->min_distance = 0;
+    ci->sample      = sample;
+
+    return e;
+}
+
+static int mov_nb_samples(const AVStream *st)
+{
+    const MOVStreamContext *sc = st->priv_data;
+
+    if (sc->compact_index)
+        return sc->compact_index->nb_samples;
+    return cffstream(st)->nb_index_entries;
+}
+
+/**
+ * Get the index entry of a sample, which must be below mov_nb_samples().
+ * With a compact index, the returned entry is only valid until the next call
+ * for the same stream.
+ */
+static AVIndexEntry *mov_get_sample(AVStream *st, int sample)
+{
+    MOVStreamContext *sc = st->priv_data;
+
+    if (sc->compact_index)
+        return mov_compact_index_get(st, sc, sample);
+    return &ffstream(st)->index_entries[sample];
+}
+
+static int64_t mov_get_sample_dts(const AVStream *st, int sample)
+{
+    const MOVStreamContext *sc = st->priv_data;
+
+    if (sc->compact_index)
+        return mov_compact_index_dts(sc, sample);
+    return cffstream(st)->index_entries[sample].timestamp;
+}
+
+/**
+ * av_index_search_timestamp() working on compact indexes as well.
+ */
+static int mov_search_timestamp(AVStream *st, int64_t wanted_timestamp, int flags)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int a, b, m, nb_samples;
+
+    if (!sc->compact_index)
+        return av_index_search_timestamp(st, wanted_timestamp, flags);
+
+    nb_samples = sc->compact_index->nb_samples;
+    a = -1;
+    b = nb_samples;
+    if (b && mov_compact_index_dts(sc, b - 1) < wanted_timestamp)
+        a = b - 1;
+
+    while (b - a > 1) {
+        int64_t timestamp;
+
+        m = (a + b) >> 1;
+        timestamp = mov_compact_index_dts(sc, m);
+        if (timestamp >= wanted_timestamp)
+            b = m;
+        if (timestamp <= wanted_timestamp)
+            a = m;
+    }
+    m = (flags & AVSEEK_FLAG_BACKWARD) ? a : b;
+
+    if (!(flags & AVSEEK_FLAG_ANY))
+        while (m >= 0 && m < nb_samples && !mov_compact_index_is_key(st, sc, m))
+            m += (flags & AVSEEK_FLAG_BACKWARD) ? -1 : 1;
+
+    if (m == nb_samples)
+        return -1;
+    return m;
+}
+
 #define MAX_REORDER_DELAY 16
 static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
 {
     MOVStreamContext *msc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int ctts_ind = 0;
     int ctts_sample = 0;
     int64_t pts_buf[MAX_REORDER_DELAY + 1]; // Circular buffer to sort pts.
@@ -4414,14 +4616,14 @@ static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
     if (st->codecpar->video_delay <= 0 && msc->ctts_count &&
         st->codecpar->codec_id == AV_CODEC_ID_H264) {
         st->codecpar->video_delay = 0;
-        for (int ind = 0; ind < sti->nb_index_entries && ctts_ind < msc->tts_count; ++ind) {
+        for (int ind = 0; ind < mov_nb_samples(st) && ctts_ind < msc->tts_count; ++ind) {
             // Point j to the last elem of the buffer and insert the current pts there.
             j = buf_start;
             buf_start = (buf_start + 1);
             if (buf_start == MAX_REORDER_DELAY + 1)
                 buf_start = 0;
 
-            pts_buf[j] = sti->index_entries[ind].timestamp + msc->tts_data[ctts_ind].offset;
+            pts_buf[j] = mov_get_sample(st, ind)->timestamp + msc->tts_data[ctts_ind].offset;
 
             // The timestamps that are already in the sorted buffer, and are greater than the
             // current pts, are exactly the timestamps that need to be buffered to output PTS
@@ -4957,6 +5159,435 @@ static int mov_merge_tts_data(MOVContext *mov, AVStream *st, int flags)
     return 0;
 }
 
+static void mov_free_compact_index(MOVStreamContext *sc)
+{
+    MOVCompactIndex *ci = sc->compact_index;
+
+    if (!ci)
+        return;
+    av_freep(&ci->chunk_runs);
+    av_freep(&ci->tts_first_sample);
+    av_freep(&ci->tts_dts);
+    av_freep(&sc->compact_index);
+}
+
+static int mov_sync_samples_sorted(const unsigned *samples, unsigned int count, int key_off)
+{
+    for (unsigned int i = 0; i < count; i++)
+        if (samples[i] < key_off || samples[i] > INT_MAX ||
+            (i && samples[i] <= samples[i - 1]))
+            return 0;
+    return 1;
+}
+
+static int mov_compact_index_usable(MOVContext *mov, AVStream *st, int key_off)
+{
+    MOVStreamContext *sc = st->priv_data;
+
+    if (!mov->compact_index || sc->iamf || (sc->rap_group_count && sc->rap_group) ||
+        !sc->chunk_count || !sc->stsc_count || !sc->stts_count || !sc->stts_data ||
+        (!sc->stsz_sample_size && !sc->sample_sizes) || sc->sample_count >= INT_MAX)
+        return 0;
+
+    /* all samples must belong to the demuxed sample description */
+    if (sc->pseudo_stream_id != -1)
+        for (unsigned int i = 0; i < sc->stsc_count; i++)
+            if (sc->stsc_data[i].id - 1 != sc->pseudo_stream_id)
+                return 0;
+
+    /* uncompressed audio chunk demuxing */
+    if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+        sc->stts_count == 1 && sc->stts_data[0].duration == 1)
+        return 0;
+
+    /* edit lists other than a single edit, possibly after an empty one, and
+     * presentation order durations rewrite the full index */
+    if (sc->elst_count && !mov->ignore_editlist && mov->advanced_editlist &&
+        (mov->time_scale <= 0 ||
+         sc->elst_count > 2 || sc->elst_data[sc->elst_count - 1].time < 0 ||
+         (sc->elst_count == 2 && sc->elst_data[0].time != -1)))
+        return 0;
+    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO &&
+        sc->ctts_count && sc->stts_count >= 2)
+        return 0;
+
+    /* sync samples are looked up by bisection rather than in sequence */
+    if (!mov_sync_samples_sorted((const unsigned *)sc->keyframes, sc->keyframe_count, key_off) ||
+        !mov_sync_samples_sorted(sc->stps_data, sc->stps_count, key_off))
+        return 0;
+    for (unsigned int i = 0, j = 0; i < sc->keyframe_count && j < sc->stps_count;) {
+        if (sc->keyframes[i] == sc->stps_data[j])
+            return 0;
+        if (sc->keyframes[i] < sc->stps_data[j])
+            i++;
+        else
+            j++;
+    }
+
+    return 1;
+}
+
+/**
+ * Merge stts and ctts into run-length tts_data, with the same per sample
+ * values as mov_merge_tts_data().
+ */
+static MOVTimeToSample *mov_compact_tts_data(const MOVStreamContext *sc,
+                                             unsigned int *tts_count)
+{
+    const unsigned int stts_count = sc->stts_count;
+    const unsigned int ctts_count = sc->ctts_data ? sc->ctts_count : 0;
+    unsigned int si = 0, ss = 0, ci = 0, cs = 0, count = 0, covered = 0;
+    MOVTimeToSample *tts;
+
+    if (stts_count + (uint64_t)ctts_count >= UINT_MAX / sizeof(*tts))
+        return NULL;
+    tts = av_malloc_array(stts_count + ctts_count, sizeof(*tts));
+    if (!tts)
+        return NULL;
+
+    while (covered < sc->sample_count) {
+        unsigned int n = sc->sample_count - covered;
+
+        while (si < stts_count && ss == sc->stts_data[si].count) {
+            si++;
+            ss = 0;
+        }
+        while (ci < ctts_count && cs == sc->ctts_data[ci].count) {
+            ci++;
+            cs = 0;
+        }
+        if (si == stts_count && ci == ctts_count)
+            break;
+
+        if (si < stts_count)
+            n = FFMIN(n, sc->stts_data[si].count - ss);
+        if (ci < ctts_count)
+            n = FFMIN(n, sc->ctts_data[ci].count - cs);
+
+        tts[count].count    = n;
+        tts[count].duration = si < stts_count ? sc->stts_data[si].duration : 0;
+        tts[count].offset   = ci < ctts_count ? sc->ctts_data[ci].offset   : 0;
+        count++;
+
+        if (si < stts_count)
+            ss += n;
+        if (ci < ctts_count)
+            cs += n;
+        covered += n;
+    }
+
+    *tts_count = count;
+    return tts;
+}
+
+/**
+ * Check that mov_fix_index() would keep every sample of a track with a single
+ * edit unchanged but for a constant timestamp offset: no sample is before the
+ * edit, after it, or dropped because the index is cut at the end of the edit.
+ * Returns 1 and the edit if so, 0 otherwise.
+ */
+static int mov_compact_edit_is_offset(MOVContext *mov, const AVStream *st,
+                                      const MOVStreamContext *sc,
+                                      const MOVTimeToSample *tts, unsigned int tts_count,
+                                      unsigned int nb_samples, int64_t *empty_duration,
+                                      int64_t *media_time, int64_t *duration)
+{
+    const int audio = st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO;
+    /* with ctts, video is cut at the second key frame reaching the edit end */
+    const unsigned int max_cuts = !audio && sc->ctts_count;
+    unsigned int first = 0, cuts = 0, edit = 0;
+    int64_t cum = 0, end;
+
+    *empty_duration = 0;
+    if (sc->elst_count == 2 &&
+        !get_edit_list_entry(mov, sc, edit++, media_time, empty_duration, mov->time_scale))
+        return 0;
+    if (!get_edit_list_entry(mov, sc, edit, media_time, duration, mov->time_scale) ||
+        av_sat_add64(av_sat_add64(-sc->dts_shift, *empty_duration), *duration) == INT64_MAX)
+        return 0;
+    end = *media_time + *duration;
+
+    for (unsigned int i = 0; i < tts_count && first < nb_samples; i++) {
+        unsigned int count = i + 1 < tts_count ? FFMIN(tts[i].count, nb_samples - first) :
+                                                 nb_samples - first;
+        unsigned int not_last = FFMIN(count, nb_samples - 1 - first);
+        int64_t dur = tts[i].duration, cts = cum + tts[i].offset, k;
+
+        if (!count)
+            continue;
+        if (dur && (INT64_MAX - cum) / dur < count)
+            return 0;
+
+        /* the first sample starts the edit, every other one is after it */
+        if (!first) {
+            if (cts != *media_time || (count > 1 && !dur) ||
+                !mov_compact_index_is_key(st, sc, 0))
+                return 0;
+        } else if (cts <= *media_time) {
+            return 0;
+        }
+        if (cts + (count - 1) * dur >= end)
+            return 0;
+
+        /* samples ending at or after the edit end, key frames only for video */
+        k = cts + dur >= end ? 0 : dur ? (end - cts - 1) / dur : count;
+        for (; k < not_last && cuts <= max_cuts; k++)
+            cuts += audio || mov_compact_index_is_key(st, sc, first + k);
+        if (cuts > max_cuts)
+            return 0;
+
+        cum   += count * dur;
+        first += count;
+    }
+
+    return 1;
+}
+
+/**
+ * Set up a compact index for a track instead of building its full index.
+ * Returns 1 if the compact index is used, 0 if the full index must be built
+ * and a negative value if no index can be built.
+ */
+static int mov_build_compact_index(MOVContext *mov, AVStream *st, int64_t current_dts)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVCompactIndex *ci;
+    MOVTimeToSample *tts_data;
+    int64_t empty_duration = 0, media_time = 0, edit_duration = 0;
+    const int edit = sc->elst_count && !mov->ignore_editlist && mov->advanced_editlist;
+    const unsigned int stsz_sample_size_orig = sc->stsz_sample_size;
+    unsigned int stsz_sample_size = sc->stsz_sample_size;
+    unsigned int stsc_index = 0, current_sample = 0, tts_count, i;
+    uint64_t stream_size = 0, first_sample = 0;
+    int key_off = (sc->keyframe_count && sc->keyframes[0] > 0) ||
+                  (sc->stps_count && sc->stps_data[0] > 0);
+
+    if (!mov_compact_index_usable(mov, st, key_off))
+        return 0;
+
+    av_assert0(sc->dts_shift >= 0);
+    if (current_dts < INT64_MIN + sc->dts_shift)
+        return AVERROR_INVALIDDATA;
+    current_dts -= sc->dts_shift;
+    if (!sc->sample_count || ffstream(st)->nb_index_entries || sc->tts_count)
+        return AVERROR_INVALIDDATA;
+
+    ci = sc->compact_index = av_mallocz(sizeof(*ci));
+    if (!ci)
+        return AVERROR(ENOMEM);
+    ci->chunk_runs = av_malloc_array(sc->stsc_count, sizeof(*ci->chunk_runs));
+    if (!ci->chunk_runs)
+        goto fail;
+    ci->sample  = -1;
+    ci->key_off = key_off;
+
+    /* Walk the chunks like mov_build_index() does, without visiting the
+     * samples if their size is constant. Anything that would truncate the
+     * index other than the sample count is left to the full index. */
+    for (i = 0; i < sc->chunk_count; i++) {
+        int64_t next_offset = i+1 < sc->chunk_count ? sc->chunk_offsets[i+1] : INT64_MAX;
+        int64_t current_offset = sc->chunk_offsets[i];
+        unsigned int count, valid;
+
+        while (mov_stsc_index_valid(stsc_index, sc->stsc_count) &&
+            i + 1 == sc->stsc_data[stsc_index + 1].first)
+            stsc_index++;
+
+        if (next_offset > current_offset && sc->sample_size>0 && sc->sample_size < sc->stsz_sample_size &&
+            sc->stsc_data[stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - current_offset) {
+            av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too large), ignoring\n", sc->stsz_sample_size);
+            sc->stsz_sample_size = sc->sample_size;
+        }
+        if (sc->stsz_sample_size>0 && sc->stsz_sample_size < sc->sample_size) {
+            av_log(mov->fc, AV_LOG_WARNING, "STSZ sample size %d invalid (too small), ignoring\n", sc->stsz_sample_size);
+            sc->stsz_sample_size = sc->sample_size;
+        }
+        if (sc->stsz_sample_size != stsz_sample_size) {
+            if (current_sample)
+                goto fallback;
+            stsz_sample_size = sc->stsz_sample_size;
+        }
+
+        count = sc->stsc_data[stsc_index].count;
+        if (!ci->nb_chunk_runs ||
+            ci->chunk_runs[ci->nb_chunk_runs - 1].samples_per_chunk != count) {
+            MOVChunkRun *run = &ci->chunk_runs[ci->nb_chunk_runs++];
+            run->first_chunk       = i;
+            run->samples_per_chunk = count;
+            run->first_sample      = current_sample;
+        }
+
+        valid = FFMIN(count, sc->sample_count - current_sample);
+        if (stsz_sample_size > 0) {
+            if (stsz_sample_size > 0x3FFFFFFF ||
+                ((uint64_t)INT64_MAX - current_offset) / stsz_sample_size < valid)
+                goto fallback;
+            stream_size += (uint64_t)valid * stsz_sample_size;
+        } else {
+            for (unsigned int j = 0; j < valid; j++) {
+                unsigned int sample_size = sc->sample_sizes[current_sample + j];
+                if (current_offset > INT64_MAX - sample_size || sample_size > 0x3FFFFFFF)
+                    goto fallback;
+                current_offset += sample_size;
+                stream_size    += sample_size;
+            }
+        }
+        current_sample += valid;
+
+        if (valid < count) {
+            av_log(mov->fc, AV_LOG_ERROR, "wrong sample count\n");
+            break;
+        }
+    }
+    ci->nb_samples = current_sample;
+    if (!ci->nb_samples)
+        goto fallback;
+
+    tts_data = mov_compact_tts_data(sc, &tts_count);
+    if (!tts_data)
+        goto fail;
+    if (!tts_count) {
+        av_free(tts_data);
+        goto fallback;
+    }
+    if (edit) {
+        if (!mov_compact_edit_is_offset(mov, st, sc, tts_data, tts_count, ci->nb_samples,
+                                        &empty_duration, &media_time, &edit_duration)) {
+            av_free(tts_data);
+            goto fallback;
+        }
+        /* mov_fix_index() makes the first video pts zero */
+        current_dts += empty_duration;
+        if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+            current_dts -= media_time;
+    }
+    ci->tts_first_sample = av_malloc_array(tts_count, sizeof(*ci->tts_first_sample));
+    ci->tts_dts          = av_malloc_array(tts_count, sizeof(*ci->tts_dts));
+    if (!ci->tts_first_sample || !ci->tts_dts) {
+        av_free(tts_data);
+        goto fail;
+    }
+    for (i = 0; i < tts_count; i++) {
+        uint64_t count = i + 1 < tts_count ? tts_data[i].count :
+                         FFMAX(ci->nb_samples, first_sample) - first_sample;
+
+        ci->tts_first_sample[i] = first_sample;
+        ci->tts_dts[i]          = current_dts;
+        /* the full index stops after the sample whose end overflows */
+        if (tts_data[i].duration && count &&
+            ((uint64_t)INT64_MAX - current_dts) / tts_data[i].duration < count) {
+            av_free(tts_data);
+            goto fallback;
+        }
+        current_dts  += count * tts_data[i].duration;
+        first_sample += count;
+    }
+
+    av_freep(&sc->tts_data);
+    sc->tts_data           = tts_data;
+    sc->tts_count          = tts_count;
+    sc->tts_allocated_size = tts_count * sizeof(*tts_data);
+    if (!sc->ctts_data)
+        sc->ctts_count = 0;
+    av_freep(&sc->ctts_data);
+    sc->ctts_allocated_size = 0;
+    av_freep(&sc->stts_data);
+    sc->stts_allocated_size = 0;
+
+    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        for (i = 0; i < FFMIN(ci->nb_samples, 99); i++)
+            ff_rfps_add_frame(mov->fc, st, mov_compact_index_dts(sc, i));
+
+    if (st->duration > 0)
+        st->codecpar->bit_rate = stream_size*8*sc->time_scale/st->duration;
+
+    if (edit) {
+        /* as set by mov_fix_index() for this edit list */
+        sc->min_corrected_pts = media_time;
+        st->start_time        = empty_duration;
+        st->duration          = FFMIN(st->duration, empty_duration + edit_duration);
+        if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+            ffstream(st)->skip_samples = 0;
+        st->codecpar->initial_padding = ffstream(st)->skip_samples;
+    }
+
+    av_log(mov->fc, AV_LOG_DEBUG, "Compact index for stream %d: %u samples, "
+           "%u chunk runs, %u time runs\n", st->index, ci->nb_samples,
+           ci->nb_chunk_runs, tts_count);
+
+    return 1;
+fallback:
+    sc->stsz_sample_size = stsz_sample_size_orig;
+    mov_free_compact_index(sc);
+    return 0;
+fail:
+    mov_free_compact_index(sc);
+    return AVERROR(ENOMEM);
+}
+
+/**
+ * Replace the compact index of a stream by its full index and expand
+ * tts_data to one entry per sample, for code that needs the index entries
+ * themselves, like fragments adding samples to them.
+ */
+static int mov_expand_compact_index(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVCompactIndex *ci = sc->compact_index;
+    FFStream *const sti = ffstream(st);
+    unsigned int nb_samples, tts_count = 0, tts_index, distance = 0;
+    MOVTimeToSample *tts_data;
+    AVIndexEntry *entries;
+
+    if (!ci)
+        return 0;
+
+    for (unsigned int i = 0; i < sc->tts_count; i++)
+        tts_count += sc->tts_data[i].count;
+    nb_samples = ci->nb_samples;
+    entries  = av_malloc_array(nb_samples, sizeof(*entries));
+    tts_data = av_malloc_array(tts_count, sizeof(*tts_data));
+    if (!entries || !tts_data) {
+        av_free(entries);
+        av_free(tts_data);
+        return AVERROR(ENOMEM);
+    }
+
+    for (unsigned int i = 0; i < nb_samples; i++) {
+        entries[i] = *mov_compact_index_get(st, sc, i);
+        if (entries[i].flags & AVINDEX_KEYFRAME)
+            distance = 0;
+        entries[i].min_distance = distance++;
+    }
+    for (unsigned int i = 0, idx = 0; i < sc->tts_count; i++)
+        for (unsigned int j = 0; j < sc->tts_data[i].count; j++) {
+            tts_data[idx]       = sc->tts_data[i];
+            tts_data[idx].count = 1;
+            idx++;
+        }
+
+    /* keep the position of a reader */
+    tts_index = sc->tts_index < sc->tts_count ?
+                ci->tts_first_sample[sc->tts_index] + sc->tts_sample : tts_count;
+
+    mov_free_compact_index(sc);
+    av_freep(&sc->chunk_offsets);
+    av_freep(&sc->sample_sizes);
+    av_freep(&sc->keyframes);
+    av_freep(&sc->stps_data);
+    sti->index_entries                = entries;
+    sti->nb_index_entries             = nb_samples;
+    sti->index_entries_allocated_size = nb_samples * sizeof(*entries);
+    av_free(sc->tts_data);
+    sc->tts_data           = tts_data;
+    sc->tts_count          = tts_count;
+    sc->tts_allocated_size = tts_count * sizeof(*tts_data);
+    sc->tts_index          = tts_index;
+    sc->tts_sample         = 0;
+
+    return 0;
+}
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
@@ -5023,8 +5654,14 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
                     (AVRational){1, st->codecpar->sample_rate});
     }
 
+    ret = mov_build_compact_index(mov, st, current_dts);
+    if (ret < 0)
+        return;
+
     /* only use old uncompressed audio chunk demuxing when stts specifies it */
-    if (!(st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+    if (ret > 0) {
+        /* the compact index resolves samples from the sample tables */
+    } else if (!(st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
           sc->stts_count == 1 && sc->stts_data && sc->stts_data[0].duration == 1)) {
         unsigned int current_sample = 0;
         unsigned int stts_sample = 0;
@@ -5263,8 +5900,8 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
     }
 
     // Update start time of the stream.
-    if (st->start_time == AV_NOPTS_VALUE && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && sti->nb_index_entries > 0) {
-        st->start_time = av_sat_add64(sti->index_entries[0].timestamp, sc->dts_shift);
+    if (st->start_time == AV_NOPTS_VALUE && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && mov_nb_samples(st) > 0) {
+        st->start_time = av_sat_add64(mov_get_sample_dts(st, 0), sc->dts_shift);
         if (sc->tts_data) {
             st->start_time = av_sat_add64(st->start_time, sc->tts_data[0].offset);
         }
@@ -5552,6 +6189,27 @@ static int sanity_checks(void *log_obj, MOVStreamContext *sc, int index)
     return 0;
 }
 
+/**
+ * Check whether the samples from first up to skip_last samples before the end
+ * all have the duration of the first sample. tts_data may be run-length.
+ */
+static int mov_tts_duration_constant(const MOVStreamContext *sc,
+                                     unsigned int first, unsigned int skip_last)
+{
+    uint64_t nb_samples = 0, start = 0;
+
+    for (unsigned int i = 0; i < sc->tts_count; i++)
+        nb_samples += sc->tts_data[i].count;
+
+    for (unsigned int i = 0; i < sc->tts_count && start + skip_last < nb_samples; i++) {
+        uint64_t end = start + sc->tts_data[i].count;
+        if (end > first && sc->tts_data[i].duration != sc->tts_data[0].duration)
+            return 0;
+        start = end;
+    }
+    return 1;
+}
+
 static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
@@ -5655,11 +6313,8 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         }
 
 #if FF_API_R_FRAME_RATE
-        for (unsigned int i = 1; sc->stts_count && i + 1 < sc->tts_count; i++) {
-            if (sc->tts_data[i].duration == sc->tts_data[0].duration)
-                continue;
+        if (stts_constant && !mov_tts_duration_constant(sc, 1, 1))
             stts_constant = 0;
-        }
         if (stts_constant)
             av_reduce(&st->r_frame_rate.num, &st->r_frame_rate.den,
                       sc->time_scale, sc->tts_data[0].duration, INT_MAX);
@@ -5686,20 +6341,17 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     // If the duration of the mp3 packets is not constant, then they could need a parser
     if (st->codecpar->codec_id == AV_CODEC_ID_MP3
         && sc->time_scale == st->codecpar->sample_rate) {
-        int stts_constant = 1;
-        for (int i = 1; sc->stts_count && i < sc->tts_count; i++) {
-            if (sc->tts_data[i].duration == sc->tts_data[0].duration)
-                continue;
-            stts_constant = 0;
-        }
+        int stts_constant = !sc->stts_count || mov_tts_duration_constant(sc, 1, 0);
         if (!stts_constant)
             ffstream(st)->need_parsing = AVSTREAM_PARSE_FULL;
     }
-    /* Do not need those anymore. */
-    av_freep(&sc->chunk_offsets);
-    av_freep(&sc->sample_sizes);
-    av_freep(&sc->keyframes);
-    av_freep(&sc->stps_data);
+    /* Do not need those anymore, unless samples are resolved from them. */
+    if (!sc->compact_index) {
+        av_freep(&sc->chunk_offsets);
+        av_freep(&sc->sample_sizes);
+        av_freep(&sc->keyframes);
+        av_freep(&sc->stps_data);
+    }
     av_freep(&sc->elst_data);
     av_freep(&sc->rap_group);
     av_freep(&sc->sync_group);
@@ -6197,7 +6849,7 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     int64_t dts, pts = AV_NOPTS_VALUE;
     int data_offset = 0;
     unsigned entries, first_sample_flags = frag->flags;
-    int flags, distance, i;
+    int flags, distance, i, ret;
     int64_t prev_dts = AV_NOPTS_VALUE;
     int next_frag_index = -1, index_entry_pos;
     size_t requested_size;
@@ -6226,6 +6878,10 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     if (sc->pseudo_stream_id+1 != frag->stsd_id && sc->pseudo_stream_id != -1)
         return 0;
 
+    // Samples from the moov come first in the full index.
+    if ((ret = mov_expand_compact_index(st)) < 0)
+        return ret;
+
     // Find the next frag_index index that has a valid index_entry for
     // the current track_id.
     //
@@ -10342,7 +10998,6 @@ static void mov_read_chapters(AVFormatContext *s)
 
     for (j = 0; j < mov->nb_chapter_tracks; j++) {
         AVStream *st = NULL;
-        FFStream *sti = NULL;
         chapter_track = mov->chapter_tracks[j];
         for (i = 0; i < s->nb_streams; i++) {
             sc = mov->fc->streams[i]->priv_data;
@@ -10355,16 +11010,15 @@ static void mov_read_chapters(AVFormatContext *s)
             av_log(s, AV_LOG_ERROR, "Referenced QT chapter track not found\n");
             continue;
         }
-        sti = ffstream(st);
 
         sc = st->priv_data;
         cur_pos = avio_tell(sc->pb);
 
         if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
             st->disposition |= AV_DISPOSITION_ATTACHED_PIC | AV_DISPOSITION_TIMED_THUMBNAILS;
-            if (!st->attached_pic.data && sti->nb_index_entries) {
+            if (!st->attached_pic.data && mov_nb_samples(st)) {
                 // Retrieve the first frame, if possible
-                AVIndexEntry *sample = &sti->index_entries[0];
+                AVIndexEntry *sample = mov_get_sample(st, 0);
                 if (avio_seek(sc->pb, sample->pos, SEEK_SET) != sample->pos) {
                     av_log(s, AV_LOG_ERROR, "Failed to retrieve first frame\n");
                     goto finish;
@@ -10377,9 +11031,9 @@ static void mov_read_chapters(AVFormatContext *s)
             st->codecpar->codec_type = AVMEDIA_TYPE_DATA;
             st->codecpar->codec_id = AV_CODEC_ID_BIN_DATA;
             st->discard = AVDISCARD_ALL;
-            for (int i = 0; i < sti->nb_index_entries; i++) {
-                AVIndexEntry *sample = &sti->index_entries[i];
-                int64_t end = i+1 < sti->nb_index_entries ? sti->index_entries[i+1].timestamp : st->duration;
+            for (int i = 0; i < mov_nb_samples(st); i++) {
+                AVIndexEntry *sample = mov_get_sample(st, i);
+                int64_t end = i+1 < mov_nb_samples(st) ? mov_get_sample_dts(st, i+1) : st->duration;
                 uint8_t *title;
                 uint16_t ch;
                 int len, title_len;
@@ -10448,15 +11102,14 @@ static int parse_timecode_in_framenum_format(AVFormatContext *s, AVStream *st,
 static int mov_read_rtmd_track(AVFormatContext *s, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     char buf[AV_TIMECODE_STR_SIZE];
     int64_t cur_pos = avio_tell(sc->pb);
     int hh, mm, ss, ff, drop;
 
-    if (!sti->nb_index_entries)
+    if (!mov_nb_samples(st))
         return -1;
 
-    avio_seek(sc->pb, sti->index_entries->pos, SEEK_SET);
+    avio_seek(sc->pb, mov_get_sample(st, 0)->pos, SEEK_SET);
     avio_skip(s->pb, 13);
     hh = avio_r8(s->pb);
     mm = avio_r8(s->pb);
@@ -10474,7 +11127,6 @@ static int mov_read_rtmd_track(AVFormatContext *s, AVStream *st)
 static int mov_read_timecode_track(AVFormatContext *s, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int flags = 0;
     int64_t cur_pos = avio_tell(sc->pb);
     int64_t value;
@@ -10482,13 +11134,13 @@ static int mov_read_timecode_track(AVFormatContext *s, AVStream *st)
     int tmcd_nb_frames = sc->tmcd_nb_frames;
     int rounded_tc_rate;
 
-    if (!sti->nb_index_entries)
+    if (!mov_nb_samples(st))
         return -1;
 
     if (!tc_rate.num || !tc_rate.den || !tmcd_nb_frames)
         return -1;
 
-    avio_seek(sc->pb, sti->index_entries->pos, SEEK_SET);
+    avio_seek(sc->pb, mov_get_sample(st, 0)->pos, SEEK_SET);
     value = avio_rb32(s->pb);
 
     if (sc->tmcd_flags & 0x0001) flags |= AV_TIMECODE_FLAG_DROPFRAME;
@@ -10540,6 +11192,7 @@ static void mov_free_stream_context(AVFormatContext *s, AVStream *st)
     }
 
     av_freep(&sc->tts_data);
+    mov_free_compact_index(sc);
     for (int i = 0; i < sc->drefs_count; i++) {
         av_freep(&sc->drefs[i].path);
         av_freep(&sc->drefs[i].dir);
@@ -11784,6 +12437,15 @@ static int mov_read_header(AVFormatContext *s)
 
     fix_stream_ids(s);
 
+    /* fragments add their samples to the full index */
+    if (mov->trex_data || mov->frag_index.nb_items) {
+        for (i = 0; i < s->nb_streams; i++) {
+            err = mov_expand_compact_index(s->streams[i]);
+            if (err < 0)
+                return err;
+        }
+    }
+
     ff_configure_buffers_for_index(s, AV_TIME_BASE);
 
     for (i = 0; i < mov->frag_index.nb_items; i++)
@@ -11802,10 +12464,9 @@ static AVIndexEntry *mov_find_next_sample(AVFormatContext *s, AVStream **st)
     int no_interleave = !mov->interleaved_read || !(s->pb->seekable & AVIO_SEEKABLE_NORMAL);
     for (i = 0; i < s->nb_streams; i++) {
         AVStream *avst = s->streams[i];
-        FFStream *const avsti = ffstream(avst);
         MOVStreamContext *msc = avst->priv_data;
-        if (msc->pb && msc->current_sample < avsti->nb_index_entries) {
-            AVIndexEntry *current_sample = &avsti->index_entries[msc->current_sample];
+        if (msc->pb && msc->current_sample < mov_nb_samples(avst)) {
+            AVIndexEntry *current_sample = mov_get_sample(avst, msc->current_sample);
             int64_t dts = av_rescale(current_sample->timestamp, AV_TIME_BASE, msc->time_scale);
             uint64_t dtsdiff = best_dts > dts ? best_dts - (uint64_t)dts : ((uint64_t)dts - best_dts);
             av_log(s, AV_LOG_TRACE, "stream %d, sample %d, dts %"PRId64"\n", i, msc->current_sample, dts);
@@ -11976,8 +12637,8 @@ static int mov_finalize_packet(AVFormatContext *s, AVStream *st, AVIndexEntry *s
         pkt->pts = av_sat_add64(pkt->dts, av_sat_add64(sc->dts_shift, sc->tts_data[sc->tts_index].offset));
     } else {
         if (pkt->duration == 0) {
-            int64_t next_dts = (sc->current_sample < ffstream(st)->nb_index_entries) ?
-                ffstream(st)->index_entries[sc->current_sample].timestamp : st->duration;
+            int64_t next_dts = (sc->current_sample < mov_nb_samples(st)) ?
+                mov_get_sample_dts(st, sc->current_sample) : st->duration;
             if (next_dts >= pkt->dts)
                 pkt->duration = next_dts - pkt->dts;
         }
@@ -11985,7 +12646,7 @@ static int mov_finalize_packet(AVFormatContext *s, AVStream *st, AVIndexEntry *s
     }
 
     if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && !mov->fragment.found_tfhd &&
-        sc->current_sample >= ffstream(st)->nb_index_entries) {
+        sc->current_sample >= mov_nb_samples(st)) {
         int64_t pts   = av_rescale_q(pkt->pts,     st->time_base, (AVRational){ 1, st->codecpar->sample_rate });
         int64_t total = av_rescale_q(st->duration, st->time_base, (AVRational){ 1, st->codecpar->sample_rate });
         int64_t duration = pkt->duration;
@@ -12263,7 +12924,6 @@ static int is_open_key_sample(const MOVStreamContext *sc, int sample)
 static int can_seek_to_key_sample(AVStream *st, int sample, int64_t requested_pts)
 {
     MOVStreamContext *sc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int64_t key_sample_dts, key_sample_pts;
 
     if (st->codecpar->codec_id != AV_CODEC_ID_HEVC)
@@ -12273,7 +12933,7 @@ static int can_seek_to_key_sample(AVStream *st, int sample, int64_t requested_pt
         return 1;
 
     av_assert0(sample >= 0);
-    key_sample_dts = sti->index_entries[sample].timestamp;
+    key_sample_dts = mov_get_sample_dts(st, sample);
     key_sample_pts = key_sample_dts + sc->sample_offsets[sample] + sc->dts_shift;
 
     /*
@@ -12290,7 +12950,6 @@ static int can_seek_to_key_sample(AVStream *st, int sample, int64_t requested_pt
 static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp, int flags)
 {
     MOVStreamContext *sc = st->priv_data;
-    FFStream *const sti = ffstream(st);
     int sample, time_sample, ret, requested_sample;
     int64_t next_ts;
     unsigned int i;
@@ -12304,9 +12963,9 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
         return ret;
 
     for (;;) {
-        sample = av_index_search_timestamp(st, timestamp, flags);
+        sample = mov_search_timestamp(st, timestamp, flags);
         av_log(s, AV_LOG_TRACE, "stream %d, timestamp %"PRId64", sample %d\n", st->index, timestamp, sample);
-        if (sample < 0 && sti->nb_index_entries && timestamp < sti->index_entries[0].timestamp)
+        if (sample < 0 && mov_nb_samples(st) && timestamp < mov_get_sample_dts(st, 0))
             sample = 0;
         if (sample < 0) /* not sure what to do */
             return AVERROR_INVALIDDATA;
@@ -12315,7 +12974,7 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
             break;
 
         next_ts = timestamp - FFMAX(sc->min_sample_duration, 1);
-        requested_sample = av_index_search_timestamp(st, next_ts, flags);
+        requested_sample = mov_search_timestamp(st, next_ts, flags);
         if (requested_sample < 0)
             return AVERROR_INVALIDDATA;
 
@@ -12364,9 +13023,8 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
 
 static int64_t mov_get_skip_samples(AVStream *st, int sample)
 {
-    FFStream *const sti = ffstream(st);
-    int64_t first_ts = sti->index_entries[0].timestamp;
-    int64_t ts = sti->index_entries[sample].timestamp;
+    int64_t first_ts = mov_get_sample_dts(st, 0);
+    int64_t ts = mov_get_sample_dts(st, sample);
     int64_t off;
 
     if (st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
@@ -12397,7 +13055,7 @@ static int mov_read_seek(AVFormatContext *s, int stream_index, int64_t sample_ti
 
     if (mc->seek_individually) {
         /* adjust seek timestamp to found sample timestamp */
-        int64_t seek_timestamp = sti->index_entries[sample].timestamp;
+        int64_t seek_timestamp = mov_get_sample_dts(st, sample);
         sti->skip_samples = mov_get_skip_samples(st, sample);
 
         for (i = 0; i < s->nb_streams; i++) {
@@ -12486,6 +13144,7 @@ static const AVOption mov_options[] = {
         {.i64 = 0}, 0, 1, FLAGS },
     { "max_stts_delta", "treat offsets above this value as invalid", OFFSET(max_stts_delta), AV_OPT_TYPE_INT, {.i64 = UINT_MAX-48000*10 }, 0, UINT_MAX, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "interleaved_read", "Interleave packets from multiple tracks at demuxer level", OFFSET(interleaved_read), AV_OPT_TYPE_BOOL, {.i64 = 1 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
+    { "compact_index", "Resolve samples from the sample tables instead of building the stream index", OFFSET(compact_index), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
 
     { NULL },
 };
@@ -115,6 +115,8 @@ static const AVOption options[] = {
       { "write_gama", "Write deprecated gama atom", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_WRITE_GAMA}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, .unit = "movflags" },
       { "hybrid_fragmented", "For recoverability, write a fragmented file that is converted to non-fragmented at the end.", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_HYBRID_FRAGMENTED}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, .unit = "movflags" },
     { "min_frag_duration", "Minimum fragment duration", offsetof(MOVMuxContext, min_fragment_duration), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM},
+    { "moov_reserve_duration", "Reserve space for the moov atom at the beginning of the file for up to this duration", offsetof(MOVMuxContext, moov_reserve_duration), AV_OPT_TYPE_DURATION, {.i64 = 0}, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM},
+    { "moov_reserve_samples", "Reserve space for the moov atom at the beginning of the file for up to this many samples per track", offsetof(MOVMuxContext, moov_reserve_samples), AV_OPT_TYPE_INT64, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM},
     { "mov_gamma", "gamma value for gama atom", offsetof(MOVMuxContext, gamma), AV_OPT_TYPE_FLOAT, {.dbl = 0.0 }, 0.0, 10, AV_OPT_FLAG_ENCODING_PARAM},
     { "movie_timescale", "set movie timescale", offsetof(MOVMuxContext, movie_timescale), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM},
     FF_RTP_FLAG_OPTS(MOVMuxContext, rtp_flags),
@@ -8744,6 +8746,65 @@ static int mov_init(AVFormatContext *s)
     return 0;
 }
 
+/*
+ * Upper bound of the moov size for the declared maximum duration or number
+ * of samples per track, assuming every sample gets its own stts, ctts and
+ * stss entries. Chunk offsets and stsc entries take at most 14 bytes per
+ * sample, as stsc only has an entry where the samples per chunk change.
+ */
+static int64_t estimate_moov_size(AVFormatContext *s)
+{
+    MOVMuxContext *mov = s->priv_data;
+    const AVDictionaryEntry *t = NULL;
+    int64_t size = 4096 + mov->nb_tracks * 1024LL;
+
+    while ((t = av_dict_iterate(s->metadata, t)))
+        size += strlen(t->key) + strlen(t->value) + 32;
+    size += s->nb_chapters * (256LL + 12 + 8 + 12 + 8);
+
+    for (int i = 0; i < mov->nb_streams; i++) {
+        MOVTrack *track = &mov->tracks[i];
+        AVStream *st = track->st;
+        AVCodecParameters *par = track->par;
+        int64_t nb_samples = mov->moov_reserve_samples;
+        /* stsz, stts, co64 and stsc entries */
+        int entry_size = 4 + 8 + 14;
+
+        if (!nb_samples) {
+            AVRational rate = { 1, 1 };
+
+            if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate > 0) {
+                rate = (AVRational){ par->sample_rate,
+                                     par->frame_size > 0 ? par->frame_size : 1024 };
+            } else if (st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0) {
+                rate = st->avg_frame_rate;
+            } else if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+                rate = st->r_frame_rate.num > 0 && st->r_frame_rate.den > 0 ?
+                       st->r_frame_rate : (AVRational){ 60, 1 };
+            }
+            nb_samples = av_rescale_rnd(mov->moov_reserve_duration, rate.num,
+                                        rate.den * (int64_t)AV_TIME_BASE, AV_ROUND_UP);
+        }
+        /* a constant sample size and duration take no per sample entries,
+         * but each packet may start a chunk with a new samples per chunk */
+        if (par->codec_type == AVMEDIA_TYPE_AUDIO && !track->audio_vbr)
+            entry_size = 8 + 12;
+        /* ctts, stss and sdtp entries, see mov_write_stbl_tag() */
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO)
+            entry_size += 8 + 4 + 1;
+        else if (par->codec_id == AV_CODEC_ID_TRUEHD ||
+                 par->codec_id == AV_CODEC_ID_MPEGH_3D_AUDIO ||
+                 (par->codec_id == AV_CODEC_ID_AAC && par->profile == AV_PROFILE_AAC_USAC))
+            entry_size += 4;
+
+        while ((t = av_dict_iterate(st->metadata, t)))
+            size += strlen(t->key) + strlen(t->value) + 32;
+        size += 1024 + par->extradata_size + FFMIN(nb_samples, INT_MAX) * entry_size;
+    }
+
+    return size;
+}
+
 static int mov_write_header(AVFormatContext *s)
 {
     AVIOContext *pb = s->pb;
@@ -8828,6 +8889,19 @@ static int mov_write_header(AVFormatContext *s)
             return ret;
     }
 
+    if ((mov->moov_reserve_duration || mov->moov_reserve_samples) &&
+        mov->reserved_moov_size <= 0 && mov->mode != MODE_AVIF &&
+        !(mov->flags & FF_MOV_FLAG_FRAGMENT)) {
+        int64_t size = estimate_moov_size(s);
+        if (size > INT_MAX) {
+            av_log(s, AV_LOG_WARNING, "Estimated moov size %"PRId64" is too large, "
+                   "not reserving space for it\n", size);
+        } else {
+            av_log(s, AV_LOG_VERBOSE, "Reserving %"PRId64" bytes for the moov atom\n", size);
+            mov->reserved_moov_size = size;
+        }
+    }
+
     if (mov->reserved_moov_size){
         mov->reserved_header_pos = avio_tell(pb);
         if (mov->reserved_moov_size > 0)
@@ -8861,7 +8935,7 @@ static int mov_write_header(AVFormatContext *s)
             update_size(pb, mov->mdat_pos);
         }
     } else if (mov->mode != MODE_AVIF) {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -9112,9 +9186,31 @@ static int mov_write_trailer(AVFormatContext *s)
         if (!(mov->flags & FF_MOV_FLAG_HYBRID_FRAGMENTED))
             mov_write_mdat_size(s);
 
+        if (mov->reserved_moov_size > 0) {
+            int needed;
+            if ((res = get_moov_size(s)) < 0)
+                return res;
+            needed = res + 8 - mov->reserved_moov_size;
+            if (needed > 0) {
+                if (mov->reserved_moov_size < 8) {
+                    av_log(s, AV_LOG_ERROR, "reserved_moov_size is too small, needed %d additional\n", needed);
+                    return AVERROR(EINVAL);
+                }
+                /* Keep the reserved space as a free atom and put the moov
+                 * after the data, or move it to the front in a second pass. */
+                av_log(s, AV_LOG_WARNING, "reserved_moov_size is too small, needed %d additional, %s\n", needed,
+                       mov->flags & FF_MOV_FLAG_FASTSTART ? "falling back to a second pass" :
+                                                            "writing the moov atom at the end of the file");
+                avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+                avio_wb32(pb, mov->reserved_moov_size);
+                ffio_wfourcc(pb, "free");
+                mov->reserved_moov_size = mov->flags & FF_MOV_FLAG_FASTSTART ? -1 : 0;
+            }
+        }
+
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (mov->reserved_moov_size < 0) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res < 0)
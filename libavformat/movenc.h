@@ -240,6 +240,8 @@ typedef struct MOVMuxContext {
 
     int reserved_moov_size; ///< 0 for disabled, -1 for automatic, size otherwise
     int64_t reserved_header_pos;
+    int64_t moov_reserve_duration; ///< declared maximum duration to reserve moov space for
+    int64_t moov_reserve_samples;  ///< declared maximum sample count per track
 
     char *major_brand;
 
@@ -75,6 +75,10 @@ static int force_iobuf_size;
 static int do_interleave;
 static int fake_pkt_duration;
 
+static int seekable;
+static uint8_t *mem_buf;
+static int64_t mem_size, mem_pos, mem_allocated;
+
 static int num_warnings;
 
 static int check_faults;
@@ -136,6 +140,56 @@ static int io_write_data_type(void *opaque, const uint8_t *buf, int size,
     return io_write(opaque, buf, size);
 }
 
+static int mem_write(void *opaque, const uint8_t *buf, int size)
+{
+    if (mem_pos + size > mem_allocated) {
+        int64_t new_size = FFMAX(mem_pos + size, 2 * mem_allocated);
+        uint8_t *new_buf = av_realloc(mem_buf, new_size);
+        if (!new_buf)
+            return AVERROR(ENOMEM);
+        mem_buf       = new_buf;
+        mem_allocated = new_size;
+    }
+    if (mem_pos > mem_size)
+        memset(mem_buf + mem_size, 0, mem_pos - mem_size);
+    memcpy(mem_buf + mem_pos, buf, size);
+    mem_pos += size;
+    mem_size = FFMAX(mem_size, mem_pos);
+    return size;
+}
+
+static int64_t mem_seek(void *opaque, int64_t offset, int whence)
+{
+    switch (whence) {
+    case SEEK_SET: break;
+    case SEEK_CUR: offset += mem_pos;  break;
+    case SEEK_END: offset += mem_size; break;
+    case AVSEEK_SIZE: return mem_size;
+    default: return AVERROR(EINVAL);
+    }
+    if (offset < 0)
+        return AVERROR(EINVAL);
+    return mem_pos = offset;
+}
+
+// Offset of the first top level atom of the given type in the output
+// written with seekable set, or -1 if there is none.
+static int64_t find_atom(const char *type)
+{
+    int64_t pos = 0;
+    while (pos + 8 <= mem_size) {
+        uint64_t size = AV_RB32(mem_buf + pos);
+        if (!memcmp(mem_buf + pos + 4, type, 4))
+            return pos;
+        if (size == 1 && pos + 16 <= mem_size)
+            size = AV_RB64(mem_buf + pos + 8);
+        if (size < 8)
+            break;
+        pos += size;
+    }
+    return -1;
+}
+
 static void init_out(const char *name)
 {
     char buf[100];
@@ -149,11 +203,18 @@ static void init_out(const char *name)
             perror(buf);
     }
     out_size = 0;
+    mem_size = mem_pos = 0;
 }
 
 static void close_out(void)
 {
     int i;
+    if (seekable) {
+        av_md5_update(md5, mem_buf, mem_size);
+        out_size = mem_size;
+        if (out)
+            fwrite(mem_buf, 1, mem_size, out);
+    }
     av_md5_final(md5, hash);
     for (i = 0; i < HASH_SIZE; i++)
         printf("%02x", hash[i]);
@@ -187,10 +248,13 @@ static void init_fps(int bf, int audio_preroll, int fps, int id3)
     ctx->oformat = av_guess_format(format, NULL, NULL);
     if (!ctx->oformat)
         exit(1);
-    ctx->pb = avio_alloc_context(iobuf, iobuf_size, 1, NULL, NULL, io_write, NULL);
+    ctx->pb = avio_alloc_context(iobuf, iobuf_size, 1, NULL, NULL,
+                                 seekable ? mem_write : io_write,
+                                 seekable ? mem_seek  : NULL);
     if (!ctx->pb)
         exit(1);
-    ctx->pb->write_data_type = io_write_data_type;
+    if (!seekable)
+        ctx->pb->write_data_type = io_write_data_type;
     ctx->flags |= AVFMT_FLAG_BITEXACT;
 
     st = avformat_new_stream(ctx, NULL);
@@ -836,7 +900,48 @@ int main(int argc, char **argv)
     finish();
     close_out();
 
+    // Write a non-fragmented file into a seekable output, reserving space
+    // for the moov atom from a declared maximum number of samples per
+    // track. The moov atom is written into the reserved space, followed by
+    // a free atom for the rest of it, before the mdat.
+    seekable = 1;
+    init_out("moov-reserve-samples");
+    av_dict_set(&opts, "moov_reserve_samples", "200", 0);
+    init(1, 1);
+    mux_gops(2);
+    finish();
+    check(find_atom("moov") >= 0 && find_atom("moov") < find_atom("free") &&
+          find_atom("free") < find_atom("mdat"), "moov not written into the reserved space");
+    close_out();
+
+    // Same, with the space sized from a declared maximum duration.
+    init_out("moov-reserve-duration");
+    av_dict_set(&opts, "moov_reserve_duration", "3", 0);
+    init(1, 1);
+    mux_gops(2);
+    finish();
+    check(find_atom("moov") >= 0 && find_atom("moov") < find_atom("free") &&
+          find_atom("free") < find_atom("mdat"), "moov not written into the reserved space");
+    close_out();
+
+    // Write more samples than were declared, so that the moov atom doesn't
+    // fit into the reserved space. The space is kept as a free atom and the
+    // moov atom is written after the mdat instead.
+    init_out("moov-reserve-fallback");
+    av_dict_set(&opts, "moov_reserve_samples", "1", 0);
+    init_count_warnings();
+    init(1, 1);
+    mux_gops(30);
+    finish();
+    reset_count_warnings();
+    check(num_warnings > 0, "No warnings printed for the too small reserved space");
+    check(find_atom("free") >= 0 && find_atom("free") < find_atom("mdat") &&
+          find_atom("mdat") < find_atom("moov"), "moov not written after the mdat");
+    close_out();
+    seekable = 0;
+
     av_free(md5);
+    av_free(mem_buf);
     av_packet_free(&pkt);
 
     return check_faults > 0 ? 1 : 0;
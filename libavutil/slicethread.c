@@ -17,6 +17,7 @@
  */
 
 #include <stdatomic.h>
+#include "common.h"
 #include "cpu.h"
 #include "internal.h"
 #include "slicethread.h"
@@ -39,6 +40,7 @@ typedef struct WorkerContext {
 struct AVSliceThread {
     WorkerContext   *workers;
     int             nb_threads;
+    int             nb_used_threads;
     int             nb_active_threads;
     int             nb_jobs;
 
@@ -131,6 +133,7 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     ctx->worker_func = worker_func;
     ctx->main_func   = main_func;
     ctx->nb_threads  = nb_threads;
+    ctx->nb_used_threads   = nb_threads;
     ctx->nb_active_threads = 0;
     ctx->nb_jobs     = 0;
     ctx->finished    = 0;
@@ -193,7 +196,7 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
 
     av_assert0(nb_jobs > 0);
     ctx->nb_jobs           = nb_jobs;
-    ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
+    ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_used_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
     atomic_store_explicit(&ctx->current_job, ctx->nb_active_threads, memory_order_relaxed);
     nb_workers             = ctx->nb_active_threads;
@@ -222,6 +225,12 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     }
 }
 
+int avpriv_slicethread_set_threads(AVSliceThread *ctx, int nb_threads)
+{
+    ctx->nb_used_threads = av_clip(nb_threads, 1, ctx->nb_threads);
+    return ctx->nb_used_threads;
+}
+
 av_cold void avpriv_slicethread_free(AVSliceThread **pctx)
 {
     AVSliceThread *ctx = *pctx;
@@ -272,6 +281,12 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     av_assert0(0);
 }
 
+int avpriv_slicethread_set_threads(AVSliceThread *ctx, int nb_threads)
+{
+    av_assert0(0);
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_free(AVSliceThread **pctx)
 {
     av_assert0(!pctx || !*pctx);
@@ -43,6 +43,16 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
  */
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main);
 
+/**
+ * Change the number of threads used by subsequent executions.
+ * Must not be called while avpriv_slicethread_execute() is running.
+ * @param ctx slice threading context
+ * @param nb_threads number of threads, clipped to the range from 1 to the
+ *                   number of threads the context was created with
+ * @return number of threads that will be used
+ */
+int avpriv_slicethread_set_threads(AVSliceThread *ctx, int nb_threads);
+
 /**
  * Destroy slice threading context.
  * @param pctx pointer to context
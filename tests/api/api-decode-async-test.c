@@ -0,0 +1,306 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Asynchronous decoding test.
+ * Encodes a few closed GOPs with MPEG-4, decodes them synchronously and with
+ * AVCodecContext.async_depth set, and compares the decoded frames. The
+ * asynchronous decoder is also flushed in the middle of a GOP and restarted
+ * from an earlier keyframe, as a seek would do, after which it must return
+ * exactly the frames of the synchronous decode from that keyframe on.
+ */
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/adler32.h"
+#include "libavutil/common.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#define WIDTH      176
+#define HEIGHT     144
+#define NB_FRAMES  60
+#define GOP_SIZE   12
+
+typedef struct DecodedFrame {
+    int64_t  pts;
+    uint32_t crc;
+} DecodedFrame;
+
+static AVPacket *pkts[2 * NB_FRAMES];
+static int nb_pkts;
+
+static void fill_frame(AVFrame *frame, int n)
+{
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            frame->data[0][y * frame->linesize[0] + x] = x + y + 3 * n + ((x ^ y) & 16);
+    for (int y = 0; y < HEIGHT / 2; y++) {
+        for (int x = 0; x < WIDTH / 2; x++) {
+            frame->data[1][y * frame->linesize[1] + x] = 128 + y + 2 * n;
+            frame->data[2][y * frame->linesize[2] + x] =  64 + x - n;
+        }
+    }
+}
+
+static uint32_t frame_crc(const AVFrame *frame)
+{
+    uint32_t crc = 1;
+
+    for (int p = 0; p < 3; p++) {
+        int w = p ? WIDTH  / 2 : WIDTH;
+        int h = p ? HEIGHT / 2 : HEIGHT;
+        for (int y = 0; y < h; y++)
+            crc = av_adler32_update(crc, frame->data[p] + y * frame->linesize[p], w);
+    }
+    return crc;
+}
+
+static int add_packets(AVCodecContext *enc, AVPacket *pkt)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_packet(enc, pkt)) >= 0) {
+        if (nb_pkts == FF_ARRAY_ELEMS(pkts))
+            return AVERROR_BUG;
+        pkts[nb_pkts] = av_packet_alloc();
+        if (!pkts[nb_pkts])
+            return AVERROR(ENOMEM);
+        av_packet_move_ref(pkts[nb_pkts++], pkt);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int encode_input(void)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    AVCodecContext *enc  = avcodec_alloc_context3(codec);
+    AVFrame *frame       = av_frame_alloc();
+    AVPacket *pkt        = av_packet_alloc();
+    int ret;
+
+    if (!enc || !frame || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    enc->width        = WIDTH;
+    enc->height       = HEIGHT;
+    enc->pix_fmt      = AV_PIX_FMT_YUV420P;
+    enc->time_base    = (AVRational){ 1, 25 };
+    enc->gop_size     = GOP_SIZE;
+    enc->max_b_frames = 2;
+    enc->flags       |= AV_CODEC_FLAG_CLOSED_GOP | AV_CODEC_FLAG_BITEXACT;
+    ret = av_opt_set_int(enc, "sc_threshold", 1000000000, AV_OPT_SEARCH_CHILDREN);
+    if (ret >= 0)
+        ret = avcodec_open2(enc, codec, NULL);
+    if (ret < 0)
+        goto end;
+
+    frame->format = enc->pix_fmt;
+    frame->width  = enc->width;
+    frame->height = enc->height;
+    ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0)
+        goto end;
+
+    for (int i = 0; i <= NB_FRAMES; i++) {
+        if (i < NB_FRAMES) {
+            ret = av_frame_make_writable(frame);
+            if (ret < 0)
+                goto end;
+            fill_frame(frame, i);
+            frame->pts = i;
+        }
+        ret = avcodec_send_frame(enc, i < NB_FRAMES ? frame : NULL);
+        if (ret < 0)
+            goto end;
+        ret = add_packets(enc, pkt);
+        if (ret < 0)
+            goto end;
+    }
+
+end:
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+static AVCodecContext *open_decoder(int async_depth, int thread_count)
+{
+    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_MPEG4);
+    AVCodecContext *dec  = avcodec_alloc_context3(codec);
+
+    if (!dec)
+        return NULL;
+    dec->async_depth  = async_depth;
+    dec->thread_count = thread_count;
+    dec->thread_type  = FF_THREAD_FRAME;
+    dec->flags       |= AV_CODEC_FLAG_BITEXACT;
+    if (avcodec_open2(dec, codec, NULL) < 0)
+        avcodec_free_context(&dec);
+    return dec;
+}
+
+static int receive_frames(AVCodecContext *dec, AVFrame *frame,
+                          DecodedFrame *out, int *nb_out)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_frame(dec, frame)) >= 0) {
+        if (*nb_out == NB_FRAMES) {
+            av_log(NULL, AV_LOG_ERROR, "Too many frames decoded\n");
+            return AVERROR_BUG;
+        }
+        out[*nb_out].pts = frame->pts;
+        out[*nb_out].crc = frame_crc(frame);
+        (*nb_out)++;
+        av_frame_unref(frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+/* Decode pkts[start] to pkts[end - 1], then drain the decoder if asked to. */
+static int decode_packets(AVCodecContext *dec, int start, int end, int drain,
+                          DecodedFrame *out, int *nb_out)
+{
+    AVFrame *frame = av_frame_alloc();
+    int ret = 0;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    for (int i = start; i < end + drain; i++) {
+        while ((ret = avcodec_send_packet(dec, i < end ? pkts[i] : NULL)) == AVERROR(EAGAIN)) {
+            ret = receive_frames(dec, frame, out, nb_out);
+            if (ret < 0)
+                goto end;
+        }
+        if (ret < 0)
+            goto end;
+        ret = receive_frames(dec, frame, out, nb_out);
+        if (ret < 0)
+            goto end;
+    }
+
+end:
+    av_frame_free(&frame);
+    return ret;
+}
+
+static int compare_frames(const char *name, const DecodedFrame *ref, int nb_ref,
+                          const DecodedFrame *out, int nb_out)
+{
+    if (nb_out != nb_ref) {
+        av_log(NULL, AV_LOG_ERROR, "%s: got %d frames instead of %d\n",
+               name, nb_out, nb_ref);
+        return 1;
+    }
+    for (int i = 0; i < nb_out; i++) {
+        if (out[i].pts != ref[i].pts || out[i].crc != ref[i].crc) {
+            av_log(NULL, AV_LOG_ERROR, "%s: frame %d differs: pts %"PRId64
+                   " crc 0x%08"PRIx32", expected pts %"PRId64" crc 0x%08"PRIx32"\n",
+                   name, i, out[i].pts, out[i].crc, ref[i].pts, ref[i].crc);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int run_test(int thread_count, const DecodedFrame *ref, int nb_ref)
+{
+    DecodedFrame out[NB_FRAMES];
+    AVCodecContext *dec;
+    int nb_out = 0, key, cut, first;
+    int ret;
+
+    /* Straight decode. */
+    dec = open_decoder(4, thread_count);
+    if (!dec)
+        return 1;
+    ret = decode_packets(dec, 0, nb_pkts, 1, out, &nb_out);
+    avcodec_free_context(&dec);
+    if (ret < 0 || compare_frames("async decode", ref, nb_ref, out, nb_out))
+        return 1;
+
+    /* Flush in the middle of the third GOP and restart from the second. */
+    for (key = 1; key < nb_pkts && !(pkts[key]->flags & AV_PKT_FLAG_KEY); key++)
+        ;
+    cut = FFMIN(key + GOP_SIZE + GOP_SIZE / 2, nb_pkts);
+
+    dec = open_decoder(4, thread_count);
+    if (!dec)
+        return 1;
+    nb_out = 0;
+    ret = decode_packets(dec, 0, cut, 0, out, &nb_out);
+    if (ret >= 0) {
+        avcodec_flush_buffers(dec);
+        nb_out = 0;
+        ret = decode_packets(dec, key, nb_pkts, 1, out, &nb_out);
+    }
+    avcodec_free_context(&dec);
+    if (ret < 0)
+        return 1;
+
+    for (first = 0; first < nb_ref && ref[first].pts < pkts[key]->pts; first++)
+        ;
+    return compare_frames("async decode after flush", ref + first, nb_ref - first,
+                          out, nb_out);
+}
+
+int main(void)
+{
+    DecodedFrame ref[NB_FRAMES];
+    AVCodecContext *dec;
+    int nb_ref = 0, ret;
+
+    if (!avcodec_find_encoder(AV_CODEC_ID_MPEG4) ||
+        !avcodec_find_decoder(AV_CODEC_ID_MPEG4)) {
+        av_log(NULL, AV_LOG_ERROR, "MPEG-4 codec not found\n");
+        return 1;
+    }
+
+    ret = encode_input();
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Encoding failed\n");
+        goto end;
+    }
+
+    dec = open_decoder(0, 1);
+    if (!dec) {
+        ret = 1;
+        goto end;
+    }
+    ret = decode_packets(dec, 0, nb_pkts, 1, ref, &nb_ref);
+    avcodec_free_context(&dec);
+    if (ret < 0 || nb_ref != NB_FRAMES) {
+        av_log(NULL, AV_LOG_ERROR, "Synchronous decoding failed\n");
+        ret = 1;
+        goto end;
+    }
+
+    ret = run_test(1, ref, nb_ref) || run_test(3, ref, nb_ref);
+
+end:
+    for (int i = 0; i < nb_pkts; i++)
+        av_packet_free(&pkts[i]);
+    return !!ret;
+}
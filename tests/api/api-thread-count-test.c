@@ -0,0 +1,282 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * avcodec_set_thread_count() test.
+ * Usage: api-thread-count-test codec_name frame|slice
+ *
+ * Encodes a short clip with the named codec, decodes it with a single thread
+ * and then with four threads of the given type while changing the number of
+ * threads in use between packets. The decoded frames must be identical.
+ */
+
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/adler32.h"
+#include "libavutil/common.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+
+#define WIDTH      352
+#define HEIGHT     288
+#define NB_FRAMES  40
+#define THREADS    4
+
+typedef struct DecodedFrame {
+    int64_t  pts;
+    uint32_t crc;
+} DecodedFrame;
+
+static AVPacket *pkts[2 * NB_FRAMES];
+static int nb_pkts;
+
+/* Thread counts to switch to, one per packet in turn; 0 means all. */
+static const int counts[] = { 2, 2, 1, 1, 1, 3, 4, 1, 0, 2, 3 };
+
+static void fill_frame(AVFrame *frame, int n)
+{
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            frame->data[0][y * frame->linesize[0] + x] = x + y + 3 * n + ((x ^ y) & 16);
+    for (int y = 0; y < HEIGHT / 2; y++) {
+        for (int x = 0; x < WIDTH / 2; x++) {
+            frame->data[1][y * frame->linesize[1] + x] = 128 + y + 2 * n;
+            frame->data[2][y * frame->linesize[2] + x] =  64 + x - n;
+        }
+    }
+}
+
+static uint32_t frame_crc(const AVFrame *frame)
+{
+    uint32_t crc = 1;
+
+    for (int p = 0; p < 3; p++) {
+        int w = p ? WIDTH  / 2 : WIDTH;
+        int h = p ? HEIGHT / 2 : HEIGHT;
+        for (int y = 0; y < h; y++)
+            crc = av_adler32_update(crc, frame->data[p] + y * frame->linesize[p], w);
+    }
+    return crc;
+}
+
+static int add_packets(AVCodecContext *enc, AVPacket *pkt)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_packet(enc, pkt)) >= 0) {
+        if (nb_pkts == FF_ARRAY_ELEMS(pkts))
+            return AVERROR_BUG;
+        pkts[nb_pkts] = av_packet_alloc();
+        if (!pkts[nb_pkts])
+            return AVERROR(ENOMEM);
+        av_packet_move_ref(pkts[nb_pkts++], pkt);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int encode_input(const AVCodec *codec)
+{
+    AVCodecContext *enc = avcodec_alloc_context3(codec);
+    AVFrame *frame      = av_frame_alloc();
+    AVPacket *pkt       = av_packet_alloc();
+    int ret;
+
+    if (!enc || !frame || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    enc->width        = WIDTH;
+    enc->height       = HEIGHT;
+    enc->pix_fmt      = AV_PIX_FMT_YUV420P;
+    enc->time_base    = (AVRational){ 1, 25 };
+    enc->gop_size     = 12;
+    enc->max_b_frames = 2;
+    enc->flags       |= AV_CODEC_FLAG_BITEXACT;
+    ret = avcodec_open2(enc, codec, NULL);
+    if (ret < 0)
+        goto end;
+
+    frame->format = enc->pix_fmt;
+    frame->width  = enc->width;
+    frame->height = enc->height;
+    ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0)
+        goto end;
+
+    for (int i = 0; i <= NB_FRAMES; i++) {
+        if (i < NB_FRAMES) {
+            ret = av_frame_make_writable(frame);
+            if (ret < 0)
+                goto end;
+            fill_frame(frame, i);
+            frame->pts = i;
+        }
+        ret = avcodec_send_frame(enc, i < NB_FRAMES ? frame : NULL);
+        if (ret < 0)
+            goto end;
+        ret = add_packets(enc, pkt);
+        if (ret < 0)
+            goto end;
+    }
+
+end:
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+static int receive_frames(AVCodecContext *dec, AVFrame *frame,
+                          DecodedFrame *out, int *nb_out)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_frame(dec, frame)) >= 0) {
+        if (*nb_out == NB_FRAMES) {
+            av_log(NULL, AV_LOG_ERROR, "Too many frames decoded\n");
+            return AVERROR_BUG;
+        }
+        out[*nb_out].pts = frame->pts;
+        out[*nb_out].crc = frame_crc(frame);
+        (*nb_out)++;
+        av_frame_unref(frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+/* Decode all packets; if change is set, switch the number of threads in use
+ * before every packet. */
+static int decode(const AVCodec *codec, int thread_count, int thread_type,
+                  int change, DecodedFrame *out, int *nb_out)
+{
+    AVCodecContext *dec = avcodec_alloc_context3(codec);
+    AVFrame *frame      = av_frame_alloc();
+    int ret;
+
+    if (!dec || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    dec->thread_count = thread_count;
+    dec->thread_type  = thread_type;
+    dec->flags       |= AV_CODEC_FLAG_BITEXACT;
+    ret = avcodec_open2(dec, codec, NULL);
+    if (ret < 0)
+        goto end;
+    if (change && !(dec->active_thread_type & thread_type)) {
+        av_log(NULL, AV_LOG_ERROR, "Threading not enabled\n");
+        ret = AVERROR_BUG;
+        goto end;
+    }
+
+    for (int i = 0; i <= nb_pkts; i++) {
+        if (change && i < nb_pkts) {
+            int count    = counts[i % FF_ARRAY_ELEMS(counts)];
+            int expected = count ? count : THREADS;
+
+            ret = avcodec_set_thread_count(dec, count);
+            if (ret != expected) {
+                av_log(NULL, AV_LOG_ERROR, "Setting %d threads returned %d\n",
+                       count, ret);
+                ret = AVERROR_BUG;
+                goto end;
+            }
+        }
+        ret = avcodec_send_packet(dec, i < nb_pkts ? pkts[i] : NULL);
+        if (ret < 0)
+            goto end;
+        ret = receive_frames(dec, frame, out, nb_out);
+        if (ret < 0)
+            goto end;
+    }
+
+    /* More threads than were started cannot be requested. */
+    if (change && avcodec_set_thread_count(dec, THREADS + 1) != THREADS) {
+        av_log(NULL, AV_LOG_ERROR, "Thread count not limited to %d\n", THREADS);
+        ret = AVERROR_BUG;
+    }
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&dec);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    DecodedFrame ref[NB_FRAMES], out[NB_FRAMES];
+    const AVCodec *enc, *dec;
+    int nb_ref = 0, nb_out = 0, thread_type, ret;
+
+    if (argc < 3) {
+        av_log(NULL, AV_LOG_ERROR, "Usage: %s codec_name frame|slice\n", argv[0]);
+        return 1;
+    }
+
+    enc = avcodec_find_encoder_by_name(argv[1]);
+    dec = avcodec_find_decoder_by_name(argv[1]);
+    if (!enc || !dec) {
+        av_log(NULL, AV_LOG_ERROR, "Codec %s not found\n", argv[1]);
+        return 1;
+    }
+    thread_type = !strcmp(argv[2], "slice") ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+
+    ret = encode_input(enc);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Encoding failed\n");
+        goto end;
+    }
+
+    ret = decode(dec, 1, thread_type, 0, ref, &nb_ref);
+    if (ret < 0 || nb_ref != NB_FRAMES) {
+        av_log(NULL, AV_LOG_ERROR, "Single-threaded decoding failed\n");
+        ret = 1;
+        goto end;
+    }
+
+    ret = decode(dec, THREADS, thread_type, 1, out, &nb_out);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Decoding failed\n");
+        goto end;
+    }
+
+    if (nb_out != nb_ref) {
+        av_log(NULL, AV_LOG_ERROR, "Got %d frames instead of %d\n", nb_out, nb_ref);
+        ret = 1;
+        goto end;
+    }
+    for (int i = 0; i < nb_out; i++) {
+        if (out[i].pts != ref[i].pts || out[i].crc != ref[i].crc) {
+            av_log(NULL, AV_LOG_ERROR, "Frame %d differs: pts %"PRId64
+                   " crc 0x%08"PRIx32", expected pts %"PRId64" crc 0x%08"PRIx32"\n",
+                   i, out[i].pts, out[i].crc, ref[i].pts, ref[i].crc);
+            ret = 1;
+            goto end;
+        }
+    }
+
+end:
+    for (int i = 0; i < nb_pkts; i++)
+        av_packet_free(&pkts[i]);
+    return !!ret;
+}
@@ -94,7 +94,7 @@ static const CheckasmTest tests[] = {
     #if CONFIG_DIRAC_DECODER
         { "diracdsp", checkasm_check_diracdsp },
     #endif
-    #if CONFIG_EXR_DECODER
+    #if CONFIG_EXR_DECODER || CONFIG_EXR_ENCODER
         { "exrdsp", checkasm_check_exrdsp },
     #endif
     #if CONFIG_FDCTDSP
@@ -103,6 +103,9 @@ static const CheckasmTest tests[] = {
     #if CONFIG_FLAC_DECODER
         { "flacdsp", checkasm_check_flacdsp },
     #endif
+    #if CONFIG_FLAC_ENCODER
+        { "flacencdsp", checkasm_check_flacencdsp },
+    #endif
     #if CONFIG_FMTCONVERT
         { "fmtconvert", checkasm_check_fmtconvert },
     #endif
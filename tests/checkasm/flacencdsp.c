@@ -0,0 +1,103 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/flacencdsp.h"
+#include "libavcodec/mathops.h"
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+
+#define BUF_SIZE 256
+#define PADDING  32
+
+/* With saturate set, the samples are near full scale with one sign and the
+ * coefficients are positive, so the prediction exceeds the int32 range and
+ * is clipped, while the residual itself still fits. */
+static void check_lpc_encode(int order, int bps, int precision, int shift,
+                             int saturate)
+{
+    LOCAL_ALIGNED_32(int32_t, coefs, [32]);
+    LOCAL_ALIGNED_32(int32_t, smp,  [BUF_SIZE + PADDING]);
+    LOCAL_ALIGNED_32(int32_t, res0, [BUF_SIZE + PADDING]);
+    LOCAL_ALIGNED_32(int32_t, res1, [BUF_SIZE + PADDING]);
+
+    declare_func(void, int32_t *res, const int32_t *smp, int len, int order,
+                 const int32_t coefs[32], int shift);
+
+    if (saturate) {
+        int neg = rnd() & 1;
+        for (int i = 0; i < 32; i++)
+            coefs[i] = (1 << (precision - 2)) + rnd() % (1 << (precision - 2));
+        for (int i = 0; i < BUF_SIZE + PADDING; i++) {
+            int32_t v = (1 << 30) + (rnd() & ((1 << 30) - 1));
+            smp[i] = neg ? -v : v;
+        }
+    } else {
+        for (int i = 0; i < 32; i++)
+            coefs[i] = sign_extend(rnd(), precision);
+        for (int i = 0; i < BUF_SIZE + PADDING; i++)
+            smp[i] = sign_extend(rnd(), bps);
+    }
+
+    const int test_lens[] = {
+        order + 1,
+        order + 9,
+        BUF_SIZE - 7,
+        BUF_SIZE,
+    };
+
+    for (int k = 0; k < FF_ARRAY_ELEMS(test_lens); k++) {
+        int len = test_lens[k];
+
+        memset(res0, 0, (BUF_SIZE + PADDING) * sizeof(*res0));
+        memset(res1, 0, (BUF_SIZE + PADDING) * sizeof(*res1));
+        call_ref(res0, smp, len, order, coefs, shift);
+        call_new(res1, smp, len, order, coefs, shift);
+        if (memcmp(res0, res1, len * sizeof(*res0)))
+            fail();
+    }
+    bench_new(res1, smp, BUF_SIZE, order, coefs, shift);
+}
+
+void checkasm_check_flacencdsp(void)
+{
+    static const int orders[] = { 1, 4, 8, 12, 31, 32 };
+    FLACEncDSPContext c;
+
+    /* the sums must not overflow in the C reference, which bounds the
+     * precision for lpc16 and the shift for lpc32 */
+
+    ff_flacencdsp_init(&c);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(orders); i++) {
+        int order = orders[i];
+        if (check_func(c.lpc16_encode, "flac_lpc_encode_16_%d", order))
+            check_lpc_encode(order, 16, 32 - 16 - av_log2(order), rnd() % 16, 0);
+    }
+    report("lpc16_encode");
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(orders); i++) {
+        int order = orders[i];
+        if (check_func(c.lpc32_encode, "flac_lpc_encode_32_%d", order)) {
+            check_lpc_encode(order, 24, 15, 12 + rnd() % 4, 0);
+            check_lpc_encode(order, 32, 15, rnd() % 4, 1);
+        }
+    }
+    report("lpc32_encode");
+}
@@ -87,6 +87,68 @@ static void test_motion(const char *name, me_cmp_func test_func)
     }
 }
 
+static int sad_ref(const uint8_t *pix1, const uint8_t *pix2, ptrdiff_t stride,
+                   int w, int h)
+{
+    int sum = 0;
+
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            sum += abs(pix1[y * stride + x] - pix2[y * stride + x]);
+    return sum;
+}
+
+static void test_sad_x4(const MECmpContext *me_ctx)
+{
+    /* motion estimation can look up to 17 bytes ahead */
+    static const int look_ahead = 17;
+
+    LOCAL_ALIGNED_16(uint8_t, img1, [WIDTH * HEIGHT]);
+    LOCAL_ALIGNED_16(uint8_t, img2, [WIDTH * HEIGHT]);
+
+    declare_func(void, const uint8_t *blk1, const uint8_t *const blk2[4],
+                 ptrdiff_t stride, int h, int scores[4]);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(me_ctx->sad_x4); i++) {
+        const int w = 16 >> i;
+        const uint8_t *src, *refs[4];
+        int scores0[4], scores1[4];
+
+        if (!check_func(me_ctx->sad_x4[i], "sad_x4_%d", i))
+            continue;
+
+        fill_random(img1, WIDTH * HEIGHT);
+        fill_random(img2, WIDTH * HEIGHT);
+
+        for (int n = 0; n < ITERATIONS; n++) {
+            // Pick a random h between 4 and 16; pick an even value.
+            const int h = 4 + ((rnd() % (16 + 1 - 4)) & ~1);
+
+            src = img1 + rnd() % (HEIGHT - look_ahead) * WIDTH + rnd() % (WIDTH - look_ahead);
+            for (int j = 0; j < 4; j++)
+                refs[j] = img2 + rnd() % (HEIGHT - look_ahead) * WIDTH +
+                                 rnd() % (WIDTH - look_ahead);
+
+            call_ref(src, refs, WIDTH, h, scores0);
+            call_new(src, refs, WIDTH, h, scores1);
+            for (int j = 0; j < 4; j++) {
+                if (scores0[j] != scores1[j] ||
+                    scores0[j] != sad_ref(src, refs[j], WIDTH, w, h)) {
+                    fail();
+                    printf("func: sad_x4_%d, candidate %d h=%d, error: asm=%d c=%d\n",
+                           i, j, h, scores1[j], scores0[j]);
+                    break;
+                }
+            }
+        }
+        // Test with fixed offsets, for benchmark stability
+        src = img1 + 3 * WIDTH + 3;
+        for (int j = 0; j < 4; j++)
+            refs[j] = img2 + (2 + (j >> 1)) * WIDTH + 2 + (j & 1);
+        bench_new(src, refs, WIDTH, 16, scores1);
+    }
+}
+
 #define ME_CMP_1D_ARRAYS(XX)                                                   \
     XX(sad)                                                                    \
     XX(sse)                                                                    \
@@ -134,6 +196,9 @@ static void check_motion(void)
     }
     ME_CMP_1D_ARRAYS(XX)
 #undef XX
+
+    test_sad_x4(&me_ctx);
+    report("sad_x4");
 }
 
 void checkasm_check_motion(void)
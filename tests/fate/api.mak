@@ -3,6 +3,11 @@ fate-api-flac: $(APITESTSDIR)/api-flac-test$(EXESUF)
 fate-api-flac: CMD = run $(APITESTSDIR)/api-flac-test$(EXESUF)
 fate-api-flac: CMP = null
 
+FATE_API_LIBAVCODEC-$(call ALLYES, MPEG4_ENCODER MPEG4_DECODER) += fate-api-decode-async
+fate-api-decode-async: $(APITESTSDIR)/api-decode-async-test$(EXESUF)
+fate-api-decode-async: CMD = run $(APITESTSDIR)/api-decode-async-test$(EXESUF)
+fate-api-decode-async: CMP = null
+
 FATE_API_LIBAVCODEC-$(call ALLYES, H261_ENCODER H261_PARSER) += fate-api-enc-parser fate-api-enc-parser-cif
 fate-api-enc-parser: $(APITESTSDIR)/api-enc-parser-test$(EXESUF)
 fate-api-enc-parser: CMD = run $(APITESTSDIR)/api-enc-parser-test$(EXESUF) h261 176 144
@@ -34,6 +39,14 @@ fate-api-threadmessage: $(APITESTSDIR)/api-threadmessage-test$(EXESUF)
 fate-api-threadmessage: CMD = run $(APITESTSDIR)/api-threadmessage-test$(EXESUF) 3 10 30 50 2 20 40
 fate-api-threadmessage: CMP = null
 
+FATE_API_THREAD_COUNT-$(call ALLYES, MPEG4_ENCODER MPEG4_DECODER) += fate-api-thread-count-frame
+fate-api-thread-count-frame: CMD = run $(APITESTSDIR)/api-thread-count-test$(EXESUF) mpeg4 frame
+FATE_API_THREAD_COUNT-$(call ALLYES, MPEG2VIDEO_ENCODER MPEG2VIDEO_DECODER) += fate-api-thread-count-slice
+fate-api-thread-count-slice: CMD = run $(APITESTSDIR)/api-thread-count-test$(EXESUF) mpeg2video slice
+$(FATE_API_THREAD_COUNT-yes): $(APITESTSDIR)/api-thread-count-test$(EXESUF)
+$(FATE_API_THREAD_COUNT-yes): CMP = null
+FATE_API_LIBAVCODEC-$(HAVE_THREADS) += $(FATE_API_THREAD_COUNT-yes)
+
 FATE_API_SAMPLES-$(CONFIG_AVFORMAT) += $(FATE_API_SAMPLES_LIBAVFORMAT-yes)
 
 ifdef SAMPLES
@@ -1,6 +1,11 @@
 # Read/write tests: By default, this uses the codec metadata filters - with no
 # arguments, it decomposes the stream fully and then recomposes it
-# without making any changes.
+# without making any changes.  The filters which only decompose the units
+# they modify are asked to decompose everything.
+
+FATE_CBS_OPTS_av1  = =full_decompose=1
+FATE_CBS_OPTS_h264 = =full_decompose=1
+FATE_CBS_OPTS_hevc = =full_decompose=1
 
 fate-cbs: fate-cbs-apv fate-cbs-av1 fate-cbs-h264 fate-cbs-hevc fate-cbs-mpeg2 fate-cbs-vp9 fate-cbs-vvc
 
@@ -10,13 +15,20 @@ FATE_CBS_NO_DEC_DEPS = $(call ALLYES, $(1)_DEMUXER $(1)_PARSER $(1)_METADATA_BSF
 define FATE_CBS_TEST
 # (codec, test_name, sample_file, output_format)
 FATE_CBS_$(1) += fate-cbs-$(1)-$(2)
-fate-cbs-$(1)-$(2): CMD = md5 -c:v $(3) -i $(TARGET_SAMPLES)/$(4) -c:v copy -y -bsf:v $(1)_metadata -f $(5)
+fate-cbs-$(1)-$(2): CMD = md5 -c:v $(3) -i $(TARGET_SAMPLES)/$(4) -c:v copy -y -bsf:v $(1)_metadata$(FATE_CBS_OPTS_$(1)) -f $(5)
 endef
 
 define FATE_CBS_NO_DEC_TEST
 # (codec, test_name, sample_file, output_format)
 FATE_CBS_$(1) += fate-cbs-$(1)-$(2)
-fate-cbs-$(1)-$(2): CMD = md5 -i $(TARGET_SAMPLES)/$(3) -c:v copy -y -bsf:v $(1)_metadata -f $(4)
+fate-cbs-$(1)-$(2): CMD = md5 -i $(TARGET_SAMPLES)/$(3) -c:v copy -y -bsf:v $(1)_metadata$(FATE_CBS_OPTS_$(1)) -f $(4)
+endef
+
+define FATE_CBS_PASSTHROUGH_TEST
+# (codec, test_name, sample_file, output_format)
+FATE_CBS_$(1)_PASSTHROUGH += fate-cbs-$(1)-passthrough-$(2)
+fate-cbs-$(1)-passthrough-$(2): CMD = md5 -c:v $(1) -i $(TARGET_SAMPLES)/$(3) -c:v copy -y -bsf:v $(1)_metadata -f $(4)
+fate-cbs-$(1)-passthrough-$(2): REF = $(SRC_PATH)/tests/ref/fate/cbs-$(1)-$(2)
 endef
 
 define FATE_CBS_DISCARD_TEST
@@ -92,6 +104,21 @@ $(foreach N,$(FATE_CBS_H264_SAMPLES),$(eval $(call FATE_CBS_TEST,h264,$(basename
 
 FATE_CBS_H264-$(call FATE_CBS_DEPS, H264, H264, H264, H264, H264) = $(FATE_CBS_h264)
 
+# Pass-through tests: by default only the parameter sets are decomposed and
+# all other units are copied, which must give the same output as the full
+# decomposition above.
+
+FATE_CBS_H264_PASSTHROUGH_SAMPLES = \
+    SVA_Base_B.264        \
+    CVFC1_Sony_C.jsv      \
+    Sharp_MP_PAFF_1r2.jvt \
+    CABACI3_Sony_B.jsv
+
+$(foreach N,$(FATE_CBS_H264_PASSTHROUGH_SAMPLES),$(eval $(call FATE_CBS_PASSTHROUGH_TEST,h264,$(basename $(N)),h264-conformance/$(N),h264)))
+$(eval $(call FATE_CBS_PASSTHROUGH_TEST,h264,sei-1,h264/sei-1.h264,h264))
+
+FATE_CBS_H264-$(call FATE_CBS_DEPS, H264, H264, H264, H264, H264) += $(FATE_CBS_h264_PASSTHROUGH)
+
 FATE_CBS_DISCARD_TYPES = \
     nonref   \
     bidir    \
@@ -133,6 +160,16 @@ $(foreach N,$(FATE_CBS_HEVC_SAMPLES),$(eval $(call FATE_CBS_TEST,hevc,$(basename
 
 FATE_CBS_HEVC-$(call FATE_CBS_DEPS, HEVC, HEVC, HEVC, HEVC, HEVC) = $(FATE_CBS_hevc)
 
+FATE_CBS_HEVC_PASSTHROUGH_SAMPLES = \
+    STRUCT_A_Samsung_5.bit    \
+    WPP_A_ericsson_MAIN_2.bit \
+    NUT_A_ericsson_5.bit      \
+    HRD_A_Fujitsu_2.bit
+
+$(foreach N,$(FATE_CBS_HEVC_PASSTHROUGH_SAMPLES),$(eval $(call FATE_CBS_PASSTHROUGH_TEST,hevc,$(basename $(N)),hevc-conformance/$(N),hevc)))
+
+FATE_CBS_HEVC-$(call FATE_CBS_DEPS, HEVC, HEVC, HEVC, HEVC, HEVC) += $(FATE_CBS_hevc_PASSTHROUGH)
+
 $(foreach N,$(FATE_CBS_DISCARD_TYPES),$(eval $(call FATE_CBS_DISCARD_TEST,hevc,$(N),hevc-conformance/WPP_A_ericsson_MAIN10_2.bit,hevc)))
 
 FATE_CBS_HEVC-$(call ALLYES, HEVC_DEMUXER HEVC_MUXER HEVC_PARSER FILTER_UNITS_BSF HEVC_METADATA_BSF) += $(FATE_CBS_hevc_DISCARD)
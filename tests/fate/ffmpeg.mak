@@ -173,6 +173,16 @@ fate-copy-apng: fate-lavf-apng
 fate-lavf-apng: KEEP_FILES ?= 1
 fate-copy-apng: CMD = transcode apng tests/data/lavf/lavf.apng apng "-c:v copy"
 
+# Decoding ahead with -async_depth must not change the decoded frames.
+ifneq (,$(filter fate-lavf-mkv,$(FATE_LAVF_CONTAINER)))
+FATE_FFMPEG-$(call FRAMECRC, MATROSKA, MPEG4 MP2, ARESAMPLE_FILTER) += fate-ffmpeg-decode-sync fate-ffmpeg-decode-async
+endif
+fate-ffmpeg-decode-sync fate-ffmpeg-decode-async: fate-lavf-mkv
+fate-lavf-mkv: KEEP_FILES ?= 1
+fate-ffmpeg-decode-sync:  CMD = framecrc -auto_conversion_filters -i $(TARGET_PATH)/tests/data/lavf/lavf.mkv
+fate-ffmpeg-decode-async: CMD = framecrc -auto_conversion_filters -async_depth 4 -i $(TARGET_PATH)/tests/data/lavf/lavf.mkv
+fate-ffmpeg-decode-sync fate-ffmpeg-decode-async: REF = $(SRC_PATH)/tests/ref/fate/ffmpeg-decode-sync
+
 FATE_STREAMCOPY-$(call DEMMUX, OGG, OGG) += fate-limited_input_seek fate-limited_input_seek-copyts
 fate-limited_input_seek: CMD = md5 -ss 1.5 -t 1.3 -i $(TARGET_SAMPLES)/vorbis/moog_small.ogg -c:a copy -fflags +bitexact -f ogg
 fate-limited_input_seek-copyts: CMD = md5 -ss 1.5 -t 1.3 -i $(TARGET_SAMPLES)/vorbis/moog_small.ogg -c:a copy -copyts -fflags +bitexact -f ogg
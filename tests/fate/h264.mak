@@ -203,6 +203,18 @@ FATE_H264  := $(FATE_H264:%=fate-h264-conformance-%)                    \
 FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER SCALE_FILTER) += $(FATE_H264_REINIT_TESTS:%=fate-h264-reinit-%)
 FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER) += $(FATE_H264)
 FATE_H264-$(call FRAMEMD5, H264, H264, H264_PARSER) += fate-h264-extreme-plane-pred
+
+# single-slice pictures decoded with slice threads, deblocking one macroblock
+# row behind reconstruction on a second thread; must match the serial decode
+FATE_H264_DEBLOCK_THREAD := ba1_sony_d caba1_sony_d frext-frext1_panasonic_c
+FATE_H264_DEBLOCK_THREAD := $(FATE_H264_DEBLOCK_THREAD:%=fate-h264-deblock-thread-%)
+fate-h264-deblock-thread-ba1_sony_d:               CMD = framecrc -i $(TARGET_SAMPLES)/h264-conformance/BA1_Sony_D.jsv
+fate-h264-deblock-thread-caba1_sony_d:             CMD = framecrc -i $(TARGET_SAMPLES)/h264-conformance/CABA1_Sony_D.jsv
+fate-h264-deblock-thread-frext-frext1_panasonic_c: CMD = framecrc -i $(TARGET_SAMPLES)/h264-conformance/FRext/FRExt1_Panasonic.avc
+$(FATE_H264_DEBLOCK_THREAD): THREADS = 3
+$(FATE_H264_DEBLOCK_THREAD): THREAD_TYPE = slice
+$(FATE_H264_DEBLOCK_THREAD): REF = $(SRC_PATH)/tests/ref/fate/$(@:fate-h264-deblock-thread-%=h264-conformance-%)
+FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER) += $(FATE_H264_DEBLOCK_THREAD)
 FATE_H264-$(call FRAMEMD5, MOV,  H264) += fate-h264-crop-to-container
 FATE_H264-$(call DEMDEC,   H264, H264, H264_PARSER)   += fate-h264-encparams
 
@@ -221,6 +221,20 @@ FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER SCALE_FILTER) +=         \
 
 FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER SCALE_FILTER SETPTS_FILTER) += $(HEVC_TESTS_MULTIVIEW)
 
+# entropy_coding_sync (WPP) rows decoded with slice threads, and with row
+# threads inside each frame thread; the output must match the serial decode
+fate-hevc-wpp-slice-threads: CMD = framecrc -i $(TARGET_SAMPLES)/hevc-conformance/WPP_B_ericsson_MAIN_2.bit -pix_fmt yuv420p
+fate-hevc-wpp-slice-threads: THREADS = 4
+fate-hevc-wpp-slice-threads: THREAD_TYPE = slice
+fate-hevc-wpp-slice-threads: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-WPP_B_ericsson_MAIN_2
+
+fate-hevc-wpp-frame-row-threads: CMD = framecrc -wpp_threads 3 -i $(TARGET_SAMPLES)/hevc-conformance/WPP_E_ericsson_MAIN_2.bit -pix_fmt yuv420p
+fate-hevc-wpp-frame-row-threads: THREADS = 2
+fate-hevc-wpp-frame-row-threads: THREAD_TYPE = frame
+fate-hevc-wpp-frame-row-threads: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-WPP_E_ericsson_MAIN_2
+
+FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER) += fate-hevc-wpp-slice-threads fate-hevc-wpp-frame-row-threads
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -fps_mode passthrough -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER SCALE_FILTER LARGE_TESTS) += fate-hevc-paramchange-yuv420p-yuv420p10
 
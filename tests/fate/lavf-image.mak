@@ -19,8 +19,12 @@ FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip1.grayf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip1.gbrpf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip1.gbrapf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip16.grayf32le.exr
+FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += piz.grayf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip16.gbrpf32le.exr
+FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += piz.gbrpf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += zip16.gbrapf32le.exr
+FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += piz.gbrapf32le.exr
+FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         EXR) += piz_half.gbrapf32le.exr
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,       MJPEG) += jpg
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         PAM) += pam
 FATE_LAVF_IMAGES-$(call LAVF_IMAGES,         PAM) += rgba.pam
@@ -64,14 +68,18 @@ fate-lavf-none.grayf32le.exr:   CMD = lavf_image "-compression none  -pix_fmt gr
 fate-lavf-rle.grayf32le.exr:    CMD = lavf_image "-compression rle   -pix_fmt grayf32le" "" "no_file_checksums"
 fate-lavf-zip1.grayf32le.exr:   CMD = lavf_image "-compression zip1  -pix_fmt grayf32le" "" "no_file_checksums"
 fate-lavf-zip16.grayf32le.exr:  CMD = lavf_image "-compression zip16 -pix_fmt grayf32le" "" "no_file_checksums"
+fate-lavf-piz.grayf32le.exr:    CMD = lavf_image "-compression piz   -pix_fmt grayf32le" "" "no_file_checksums"
 fate-lavf-none.gbrpf32le.exr:   CMD = lavf_image "-compression none  -pix_fmt gbrpf32le" "" "no_file_checksums"
 fate-lavf-rle.gbrpf32le.exr:    CMD = lavf_image "-compression rle   -pix_fmt gbrpf32le" "" "no_file_checksums"
 fate-lavf-zip1.gbrpf32le.exr:   CMD = lavf_image "-compression zip1  -pix_fmt gbrpf32le" "" "no_file_checksums"
 fate-lavf-zip16.gbrpf32le.exr:  CMD = lavf_image "-compression zip16 -pix_fmt gbrpf32le" "" "no_file_checksums"
+fate-lavf-piz.gbrpf32le.exr:    CMD = lavf_image "-compression piz   -pix_fmt gbrpf32le" "" "no_file_checksums"
 fate-lavf-none.gbrapf32le.exr:  CMD = lavf_image "-compression none  -pix_fmt gbrapf32le" "" "no_file_checksums"
 fate-lavf-rle.gbrapf32le.exr:   CMD = lavf_image "-compression rle   -pix_fmt gbrapf32le" "" "no_file_checksums"
 fate-lavf-zip1.gbrapf32le.exr:  CMD = lavf_image "-compression zip1  -pix_fmt gbrapf32le" "" "no_file_checksums"
 fate-lavf-zip16.gbrapf32le.exr: CMD = lavf_image "-compression zip16 -pix_fmt gbrapf32le" "" "no_file_checksums"
+fate-lavf-piz.gbrapf32le.exr:   CMD = lavf_image "-compression piz   -pix_fmt gbrapf32le" "" "no_file_checksums"
+fate-lavf-piz_half.gbrapf32le.exr: CMD = lavf_image "-compression piz -format half -pix_fmt gbrapf32le" "" "no_file_checksums"
 fate-lavf-jpg: CMD = lavf_image "-pix_fmt yuvj420p"
 fate-lavf-tiff: CMD = lavf_image "-pix_fmt rgb24"
 fate-lavf-gbrp10le.dpx: CMD = lavf_image "-pix_fmt gbrp10le" "-pix_fmt gbrp10le"
@@ -90,6 +90,23 @@ fate-mov-2elist-elist1-ends-bframe: CMD = framemd5 -i $(TARGET_SAMPLES)/mov/mov-
 # Makes sure that if edit list ends on a B-frame but before the I-frame, then we output the B-frame but discard the I-frame.
 fate-mov-elst-ends-betn-b-and-i: CMD = framemd5 -i $(TARGET_SAMPLES)/mov/elst_ends_betn_b_and_i.mp4
 
+# The compact index must not change the output, whether it is used for a
+# track with an edit list or the edit list makes the track fall back to the
+# full index.
+FATE_MOV-$(call FRAMEMD5, MOV, H264) += fate-mov-1elist-noctts-compact-index \
+                                        fate-mov-1elist-1ctts-compact-index \
+                                        fate-mov-1elist-ends-last-bframe-compact-index \
+                                        fate-mov-3elist-compact-index \
+
+fate-mov-1elist-noctts-compact-index: CMD = framemd5 -compact_index 1 -i $(TARGET_SAMPLES)/mov/mov-1elist-noctts.mov
+fate-mov-1elist-noctts-compact-index: REF = $(SRC_PATH)/tests/ref/fate/mov-1elist-noctts
+fate-mov-1elist-1ctts-compact-index: CMD = framemd5 -compact_index 1 -i $(TARGET_SAMPLES)/mov/mov-1elist-1ctts.mov
+fate-mov-1elist-1ctts-compact-index: REF = $(SRC_PATH)/tests/ref/fate/mov-1elist-1ctts
+fate-mov-1elist-ends-last-bframe-compact-index: CMD = framemd5 -compact_index 1 -i $(TARGET_SAMPLES)/mov/mov-1elist-ends-last-bframe.mov
+fate-mov-1elist-ends-last-bframe-compact-index: REF = $(SRC_PATH)/tests/ref/fate/mov-1elist-ends-last-bframe
+fate-mov-3elist-compact-index: CMD = framemd5 -compact_index 1 -i $(TARGET_SAMPLES)/mov/mov-3elist.mov
+fate-mov-3elist-compact-index: REF = $(SRC_PATH)/tests/ref/fate/mov-3elist
+
 # Makes sure that we handle edit lists and start padding correctly.
 FATE_MOV_FFMPEG_SAMPLES-$(call FRAMEMD5, MOV, AAC, ARESAMPLE_FILTER) \
                             += fate-mov-440hz-10ms
@@ -108,6 +125,17 @@ fate-mov-ibi-elst-starts-b: CMD = framemd5 -flags +bitexact -i $(TARGET_SAMPLES)
 # Makes sure that we handle overlapping framgments
 fate-mov-frag-overlap: CMD = framemd5 -i $(TARGET_SAMPLES)/mov/frag_overlap.mp4
 
+# Demuxing and seeking with the compact index, which the video track of
+# lavf.mov uses despite its edit list, must match the full index.
+ifneq (,$(filter fate-lavf-mov,$(FATE_LAVF_CONTAINER)))
+FATE_MOV_FFMPEG-$(call FRAMECRC, MOV) += fate-mov-full-index fate-mov-compact-index
+endif
+fate-mov-full-index fate-mov-compact-index: fate-lavf-mov
+fate-lavf-mov: KEEP_FILES ?= 1
+fate-mov-full-index:    CMD = framecrc -ss 0.3 -i $(TARGET_PATH)/tests/data/lavf/lavf.mov -c copy
+fate-mov-compact-index: CMD = framecrc -compact_index 1 -ss 0.3 -i $(TARGET_PATH)/tests/data/lavf/lavf.mov -c copy
+fate-mov-full-index fate-mov-compact-index: REF = $(SRC_PATH)/tests/ref/fate/mov-full-index
+
 fate-mov-mp4-frag-flush: CMD = md5 -f lavfi -i color=blue,format=rgb24,trim=duration=0.04 -f lavfi -i anullsrc,aformat=s16,atrim=duration=2 -c:v png -c:a pcm_s16le -movflags +empty_moov+hybrid_fragmented -frag_duration 1000000 -frag_interleave 1 -bitexact -f mp4
 fate-mov-mp4-frag-flush: CMP = oneline
 fate-mov-mp4-frag-flush: REF = 46f748faa3b8b59ebeeb789bee75008a
@@ -6,7 +6,7 @@ fate-vsynth%: CODEC = $(word 3, $(subst -, ,$(@)))
 fate-vsynth%: FMT = avi
 fate-vsynth%: DEFAULT_SIZE = -s 352x288
 fate-vsynth3-%: DEFAULT_SIZE = -s $(FATEW)x$(FATEH)
-fate-vsynth%: CMD = enc_dec "rawvideo $(DEFAULT_SIZE) -color_range mpeg -pix_fmt yuv420p $(RAWDECOPTS)" $(SRC) $(FMT) "-c $(CODEC) $(ENCOPTS)" rawvideo "-pix_fmt yuv420p -color_range mpeg -fps_mode passthrough $(DECOPTS)" "" "" ${TWOPASS}
+fate-vsynth%: CMD = enc_dec "rawvideo $(DEFAULT_SIZE) -color_range mpeg -pix_fmt yuv420p $(RAWDECOPTS)" $(SRC) $(FMT) "-c $(CODEC) $(ENCOPTS)" rawvideo "-pix_fmt yuv420p -color_range mpeg -fps_mode passthrough $(DECOPTS)" "$(DECINOPTS)" "" ${TWOPASS}
 fate-vsynth%: CMP_UNIT = 1
 fate-vsynth%: REF = $(SRC_PATH)/tests/ref/vsynth/$(@:fate-%=%)
 
@@ -245,8 +245,11 @@ fate-vsynth3-magicyuv:                ENCOPTS = -pix_fmt yuv444p -pred median \
 fate-vsynth_lena-magicyuv:            ENCOPTS = -slices 3 -pix_fmt gray -pred left
 fate-vsynth%-magicyuv:                DECOPTS = -sws_flags neighbor+bitexact
 
-FATE_VCODEC_SCALE-$(call ENCDEC, MJPEG, AVI) += mjpeg mjpeg-422 mjpeg-444 mjpeg-trell mjpeg-huffman mjpeg-trell-huffman
+FATE_VCODEC_SCALE-$(call ENCDEC, MJPEG, AVI) += mjpeg mjpeg-slice-thread mjpeg-422 mjpeg-444 mjpeg-trell mjpeg-huffman mjpeg-trell-huffman
 fate-vsynth%-mjpeg:                   ENCOPTS = -qscale 9 -pix_fmt yuvj420p -huffman default -threads 5 -thread_type slice
+fate-vsynth%-mjpeg-slice-thread:      ENCOPTS = -qscale 9 -pix_fmt yuvj420p -huffman default -threads 5 -thread_type slice
+fate-vsynth%-mjpeg-slice-thread:      THREADS = 4
+fate-vsynth%-mjpeg-slice-thread:      THREAD_TYPE = slice
 fate-vsynth%-mjpeg-422:               ENCOPTS = -qscale 9 -pix_fmt yuvj422p
 fate-vsynth%-mjpeg-444:               ENCOPTS = -qscale 9 -pix_fmt yuvj444p
 fate-vsynth%-mjpeg-trell:             ENCOPTS = -qscale 9 -pix_fmt yuvj420p -trellis 1 -huffman default
@@ -268,7 +271,9 @@ FATE_MPEG2 := mpeg2                                                     \
              mpeg2-ilace                                                \
              mpeg2-ivlc-qprd                                            \
              mpeg2-thread                                               \
-             mpeg2-thread-ivlc
+             mpeg2-thread-ivlc                                          \
+             mpeg2-gop-threads                                          \
+             mpeg2-gop-threads-rc
 
 FATE_VCODEC-$(call ENCDEC, MPEG2VIDEO, MPEG2VIDEO MPEGVIDEO) += $(FATE_MPEG2)
 
@@ -297,8 +302,13 @@ fate-vsynth%-mpeg2-thread:       ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
                                            -threads 2 -slices 2
 fate-vsynth%-mpeg2-thread-ivlc:  ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
                                            -intra_vlc 1 -threads 2 -slices 2
+fate-vsynth%-mpeg2-gop-threads:  ENCOPTS = -qscale 10 -bf 2 -g 12        \
+                                           -threads 2 -gop_threads 1
+fate-vsynth%-mpeg2-gop-threads-rc: ENCOPTS = -b 600k -maxrate 1000k      \
+                                           -bufsize 1000k -bf 2 -g 12    \
+                                           -threads 3 -gop_threads 1
 
-FATE_MPEG4_MP4 = mpeg4
+FATE_MPEG4_MP4 = mpeg4 mpeg4-contiguous
 FATE_MPEG4_AVI = mpeg4-rc                                               \
                  mpeg4-adv                                              \
                  mpeg4-qprd                                             \
@@ -315,6 +325,10 @@ FATE_VCODEC-$(call ENCDEC, MPEG4, AVI)     += $(FATE_MPEG4_AVI)
 fate-vsynth%-mpeg4:              ENCOPTS = -qscale 10 -flags +mv4 -mbd bits
 fate-vsynth%-mpeg4:              FMT     = mp4
 
+fate-vsynth%-mpeg4-contiguous:   ENCOPTS = -qscale 10 -flags +mv4 -mbd bits
+fate-vsynth%-mpeg4-contiguous:   FMT     = mp4
+fate-vsynth%-mpeg4-contiguous:   DECINOPTS = -flags2 +contiguous
+
 fate-vsynth%-mpeg4-adap:         ENCOPTS = -b 550k -bf 2 -flags +mv4     \
                                            -trellis 1 -cmp 1 -subcmp 2   \
                                            -mbd rd -scplx_mask 0.3       \
@@ -359,8 +373,10 @@ fate-vsynth%-msmpeg4v2:          ENCOPTS = -qscale 10
 FATE_VCODEC_SCALE-$(call ENCDEC, MSRLE, AVI) += msrle
 fate-vsynth%-msrle:              CODEC   = msrle
 
-FATE_VCODEC_SCALE-$(call ENCDEC, PNG, AVI) += mpng
+FATE_VCODEC_SCALE-$(call ENCDEC, PNG, AVI) += mpng mpng-slice-thread
 fate-vsynth%-mpng:               CODEC   = png
+fate-vsynth%-mpng-slice-thread:  CODEC   = png
+fate-vsynth%-mpng-slice-thread:  ENCOPTS = -pred mixed -threads 4 -thread_type slice
 
 FATE_VCODEC_SCALE-$(call ENCDEC, MSVIDEO1, AVI) += msvideo1
 
@@ -505,7 +521,9 @@ FATE_VCODEC += $(FATE_VCODEC-yes)
 FATE_VCODEC := $(if $(call ENCDEC, RAWVIDEO, RAWVIDEO),$(FATE_VCODEC))
 FATE_VSYNTH1 = $(FATE_VCODEC:%=fate-vsynth1-%)
 FATE_VSYNTH2 = $(FATE_VCODEC:%=fate-vsynth2-%)
-FATE_VSYNTH_LENA = $(FATE_VCODEC:%=fate-vsynth_lena-%)
+# No vsynth_lena reference has been generated for these yet
+VSYNTH_LENA_OFF = mpeg2-gop-threads mpeg2-gop-threads-rc mpng-slice-thread
+FATE_VSYNTH_LENA = $(filter-out $(VSYNTH_LENA_OFF:%=fate-vsynth_lena-%),$(FATE_VCODEC:%=fate-vsynth_lena-%))
 # Redundant tests because they just resize the input
 RESIZE_OFF   = dnxhd-720p dnxhd-720p-rd dnxhd-720p-10bit dnxhd-1080i \
                dv dv-411 dv-50 avui snow snow-hpel snow-ll vc2-420p \
@@ -0,0 +1,294 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Audio encoder speed benchmark: encodes the same stereo signal at a list of
+ * bitrates and reports the speed as a multiple of realtime. The signal is
+ * decoded from a file, or synthesized when none is given, and is held in
+ * memory so that only the encoder is timed. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decode_simple.h"
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/avcodec.h"
+#include "libavcodec/codec.h"
+
+#include "libswresample/swresample.h"
+
+#define SYNTH_SECONDS 30
+
+typedef struct Signal {
+    float   *data[2];
+    int      nb_samples;
+    int      allocated;
+    int      sample_rate;
+
+    SwrContext *swr;
+} Signal;
+
+static int signal_grow(Signal *sig, int nb_samples)
+{
+    if (sig->nb_samples + nb_samples <= sig->allocated)
+        return 0;
+
+    sig->allocated = FFMAX(sig->allocated * 2, sig->nb_samples + nb_samples);
+    for (int ch = 0; ch < 2; ch++) {
+        float *tmp = av_realloc_array(sig->data[ch], sig->allocated, sizeof(float));
+        if (!tmp)
+            return AVERROR(ENOMEM);
+        sig->data[ch] = tmp;
+    }
+    return 0;
+}
+
+static int process_frame(DecodeContext *dc, AVFrame *frame)
+{
+    static const AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    Signal *sig = dc->opaque;
+    int nb_samples, ret;
+
+    if (!sig->swr) {
+        if (!frame)
+            return 0;
+        ret = swr_alloc_set_opts2(&sig->swr, &stereo, AV_SAMPLE_FMT_FLTP, sig->sample_rate,
+                                  &frame->ch_layout, frame->format, frame->sample_rate,
+                                  0, NULL);
+        if (ret < 0 || (ret = swr_init(sig->swr)) < 0)
+            return ret;
+    }
+
+    nb_samples = swr_get_out_samples(sig->swr, frame ? frame->nb_samples : 0);
+    ret = signal_grow(sig, nb_samples);
+    if (ret < 0)
+        return ret;
+
+    ret = swr_convert(sig->swr,
+                      (uint8_t *[]){ (uint8_t *)(sig->data[0] + sig->nb_samples),
+                                     (uint8_t *)(sig->data[1] + sig->nb_samples) },
+                      nb_samples,
+                      frame ? (const uint8_t * const *)frame->extended_data : NULL,
+                      frame ? frame->nb_samples : 0);
+    if (ret < 0)
+        return ret;
+    sig->nb_samples += ret;
+
+    return 0;
+}
+
+/* A few slowly gliding partials with some noise, different in both
+ * channels so the stereo tools have something to decide. */
+static int synthesize(Signal *sig)
+{
+    AVLFG lfg;
+    int ret;
+
+    ret = signal_grow(sig, SYNTH_SECONDS * sig->sample_rate);
+    if (ret < 0)
+        return ret;
+
+    av_lfg_init(&lfg, 0x5eed);
+    for (int i = 0; i < SYNTH_SECONDS * sig->sample_rate; i++) {
+        double t = (double)i / sig->sample_rate;
+        double f = 220.0 * (1.0 + 0.5 * sin(2 * M_PI * 0.05 * t));
+        double s = 0.0;
+
+        for (int k = 1; k <= 6; k++)
+            s += sin(2 * M_PI * f * k * t) / (k * 4.0);
+
+        for (int ch = 0; ch < 2; ch++) {
+            double noise = (av_lfg_get(&lfg) / (double)UINT32_MAX - 0.5) * 0.05;
+            double pan   = ch ? 0.8 + 0.2 * sin(2 * M_PI * 0.3 * t) : 1.0;
+            sig->data[ch][i] = s * pan + noise;
+        }
+    }
+    sig->nb_samples = SYNTH_SECONDS * sig->sample_rate;
+
+    return 0;
+}
+
+static int encode_run(const AVCodec *codec, const Signal *sig, int kbps, int threads)
+{
+    static const AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    AVCodecContext *enc = NULL;
+    AVFrame *frame = NULL;
+    AVPacket *pkt = NULL;
+    int64_t bytes = 0, t0, t1;
+    int frame_size, pos = 0, ret;
+
+    enc   = avcodec_alloc_context3(codec);
+    frame = av_frame_alloc();
+    pkt   = av_packet_alloc();
+    if (!enc || !frame || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    enc->sample_fmt            = AV_SAMPLE_FMT_FLTP;
+    enc->sample_rate           = sig->sample_rate;
+    enc->time_base             = (AVRational){ 1, sig->sample_rate };
+    enc->bit_rate              = kbps * 1000LL;
+    enc->thread_count          = threads;
+    enc->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+    ret = av_channel_layout_copy(&enc->ch_layout, &stereo);
+    if (ret < 0)
+        goto end;
+
+    ret = avcodec_open2(enc, codec, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Error opening the encoder: %s\n", av_err2str(ret));
+        goto end;
+    }
+    frame_size = enc->frame_size ? enc->frame_size : 1024;
+
+    t0 = av_gettime_relative();
+    while (1) {
+        const AVFrame *in = NULL;
+
+        if (pos < sig->nb_samples) {
+            frame->nb_samples  = FFMIN(frame_size, sig->nb_samples - pos);
+            frame->format      = enc->sample_fmt;
+            frame->sample_rate = enc->sample_rate;
+            frame->pts         = pos;
+            ret = av_channel_layout_copy(&frame->ch_layout, &enc->ch_layout);
+            if (ret < 0 || (ret = av_frame_get_buffer(frame, 0)) < 0)
+                goto end;
+            for (int ch = 0; ch < 2; ch++)
+                memcpy(frame->extended_data[ch], sig->data[ch] + pos,
+                       frame->nb_samples * sizeof(float));
+            pos += frame->nb_samples;
+            in = frame;
+        }
+
+        ret = avcodec_send_frame(enc, in);
+        av_frame_unref(frame);
+        if (ret < 0)
+            goto end;
+
+        while ((ret = avcodec_receive_packet(enc, pkt)) >= 0) {
+            bytes += pkt->size;
+            av_packet_unref(pkt);
+        }
+        if (ret == AVERROR_EOF)
+            break;
+        if (ret != AVERROR(EAGAIN))
+            goto end;
+    }
+    t1 = av_gettime_relative();
+
+    printf("%-10s %4d kbps %3d threads %8.2fx realtime %8.1f kbps actual\n",
+           codec->name, kbps, enc->thread_count,
+           (double)sig->nb_samples / sig->sample_rate / ((t1 - t0) / 1000000.0),
+           bytes * 8.0 / 1000.0 / ((double)sig->nb_samples / sig->sample_rate));
+    ret = 0;
+
+end:
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const AVCodec *codec;
+    const int *rates = NULL;
+    const char *bitrates;
+    Signal sig = { 0 };
+    int threads = 0, ret = 0, nb_rates = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <encoder> <kbps>[,<kbps>...] [<thread count> "
+                "[<input file> <stream index>]]\n", argv[0]);
+        return 0;
+    }
+
+    codec = avcodec_find_encoder_by_name(argv[1]);
+    if (!codec || codec->type != AVMEDIA_TYPE_AUDIO) {
+        fprintf(stderr, "Unknown audio encoder '%s'\n", argv[1]);
+        return 1;
+    }
+    bitrates = argv[2];
+    if (argc > 3)
+        threads = strtol(argv[3], NULL, 0);
+
+    ret = avcodec_get_supported_config(NULL, codec, AV_CODEC_CONFIG_SAMPLE_RATE, 0,
+                                       (const void **)&rates, &nb_rates);
+    if (ret < 0)
+        return 1;
+    sig.sample_rate = 48000;
+    if (rates && nb_rates) {
+        int i;
+        for (i = 0; i < nb_rates && rates[i] != 48000; i++)
+            ;
+        if (i == nb_rates)
+            sig.sample_rate = rates[0];
+    }
+
+    if (argc > 5) {
+        DecodeContext dc;
+
+        ret = ds_open(&dc, argv[4], strtol(argv[5], NULL, 0));
+        if (ret >= 0) {
+            dc.process_frame = process_frame;
+            dc.opaque        = &sig;
+            ret = ds_run(&dc);
+        }
+        ds_free(&dc);
+        swr_free(&sig.swr);
+    } else {
+        ret = synthesize(&sig);
+    }
+    if (ret < 0 || !sig.nb_samples) {
+        fprintf(stderr, "Error preparing the input signal\n");
+        ret = 1;
+        goto end;
+    }
+
+    while (*bitrates) {
+        char *next;
+        int kbps = strtol(bitrates, &next, 10);
+
+        if (next == bitrates || kbps <= 0) {
+            fprintf(stderr, "Invalid bitrate list '%s'\n", argv[2]);
+            ret = 1;
+            break;
+        }
+        ret = encode_run(codec, &sig, kbps, threads);
+        if (ret < 0) {
+            ret = 1;
+            break;
+        }
+        bitrates = next + (*next == ',');
+    }
+
+end:
+    av_freep(&sig.data[0]);
+    av_freep(&sig.data[1]);
+    return ret;
+}
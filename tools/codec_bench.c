@@ -0,0 +1,718 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Decoder throughput benchmark over a corpus of files.
+ *
+ * Every file (directories are walked recursively) is demuxed into memory
+ * first, so that only the codecs are timed, then decoded once for each of
+ * the requested thread counts, optionally re-encoding the decoded frames.
+ * The results are printed as a table, CSV or JSON. */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+#if HAVE_SYS_RESOURCE_H
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+
+#include "libavcodec/avcodec.h"
+
+#include "libavutil/avstring.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#define MAX_THREAD_CONFIGS 16
+
+enum OutputFormat {
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_JSON,
+};
+
+typedef struct BenchOptions {
+    int                 thread_counts[MAX_THREAD_CONFIGS];
+    int                 nb_thread_counts;
+    int                 thread_type;
+    enum AVMediaType    media_type;
+    const char         *encoder;
+    int                 max_frames;
+    enum OutputFormat   format;
+} BenchOptions;
+
+typedef struct BenchResult {
+    const char *file;
+    const char *decoder;
+    const char *encoder;
+    int         threads;
+
+    int64_t     frames;
+    int64_t     wall_us;        ///< whole run
+    int64_t     decode_us;      ///< inside the decoder calls
+    int64_t     encode_us;      ///< inside the encoder calls
+    int64_t     cpu_us;         ///< user + system time of the process
+    int64_t     latency_us[4];  ///< p50, p90, p99, max
+    int64_t     peak_rss;       ///< bytes, 0 if unknown
+    int64_t     nb_buffers;     ///< get_buffer2() calls
+    int64_t     buffer_bytes;   ///< size of the buffers returned by them
+} BenchResult;
+
+typedef struct BenchContext {
+    AVCodecContext *dec;
+    AVCodecContext *enc;
+    AVFrame        *frame;
+    AVPacket       *enc_pkt;
+
+    /* time each packet was sent to the decoder, indexed like the packets */
+    int64_t        *send_time;
+    int64_t        *latency;
+    int64_t         nb_latency;
+    int64_t         latency_allocated;
+
+    atomic_int_least64_t nb_buffers;
+    atomic_int_least64_t buffer_bytes;
+} BenchContext;
+
+static int64_t get_cpu_time(void)
+{
+#if HAVE_GETRUSAGE
+    struct rusage rusage;
+
+    getrusage(RUSAGE_SELF, &rusage);
+    return (rusage.ru_utime.tv_sec + rusage.ru_stime.tv_sec) * 1000000LL +
+            rusage.ru_utime.tv_usec + rusage.ru_stime.tv_usec;
+#else
+    return 0;
+#endif
+}
+
+/* On Linux the high water mark can be reset between runs, elsewhere the
+ * peak is that of the whole process so far. */
+static void reset_peak_rss(void)
+{
+#if defined(__linux__)
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+static int64_t get_peak_rss(void)
+{
+#if defined(__linux__)
+    char line[128];
+    int64_t kb = -1;
+    FILE *f = fopen("/proc/self/status", "r");
+
+    if (f) {
+        while (fgets(line, sizeof(line), f))
+            if (sscanf(line, "VmHWM: %"SCNd64, &kb) == 1)
+                break;
+        fclose(f);
+        if (kb >= 0)
+            return kb * 1024;
+    }
+#endif
+#if HAVE_GETRUSAGE && HAVE_STRUCT_RUSAGE_RU_MAXRSS
+    {
+        struct rusage rusage;
+        getrusage(RUSAGE_SELF, &rusage);
+        return (int64_t)rusage.ru_maxrss * 1024;
+    }
+#else
+    return 0;
+#endif
+}
+
+static int get_buffer(AVCodecContext *avctx, AVFrame *frame, int flags)
+{
+    BenchContext *bc = avctx->opaque;
+    int ret = avcodec_default_get_buffer2(avctx, frame, flags);
+
+    if (ret >= 0) {
+        size_t size = 0;
+        for (int i = 0; i < FF_ARRAY_ELEMS(frame->buf) && frame->buf[i]; i++)
+            size += frame->buf[i]->size;
+        for (int i = 0; i < frame->nb_extended_buf; i++)
+            size += frame->extended_buf[i]->size;
+
+        atomic_fetch_add_explicit(&bc->nb_buffers, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&bc->buffer_bytes, size, memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    int64_t va = *(const int64_t *)a, vb = *(const int64_t *)b;
+    return FFDIFFSIGN(va, vb);
+}
+
+static int encode(BenchContext *bc, const BenchOptions *opts, AVFrame *frame,
+                  BenchResult *res)
+{
+    int64_t t0 = av_gettime_relative();
+    int ret;
+
+    if (!bc->enc) {
+        const AVCodec *codec;
+
+        if (!frame)
+            return 0;
+
+        codec = avcodec_find_encoder_by_name(opts->encoder);
+        if (!codec || codec->type != AVMEDIA_TYPE_VIDEO) {
+            fprintf(stderr, "Unknown video encoder '%s'\n", opts->encoder);
+            return AVERROR_ENCODER_NOT_FOUND;
+        }
+
+        bc->enc = avcodec_alloc_context3(codec);
+        if (!bc->enc)
+            return AVERROR(ENOMEM);
+
+        bc->enc->width                  = frame->width;
+        bc->enc->height                 = frame->height;
+        bc->enc->pix_fmt                = frame->format;
+        bc->enc->sample_aspect_ratio    = frame->sample_aspect_ratio;
+        bc->enc->color_range            = frame->color_range;
+        bc->enc->time_base              = bc->dec->pkt_timebase.num ?
+                                          bc->dec->pkt_timebase : (AVRational){ 1, 25 };
+        bc->enc->framerate              = bc->dec->framerate;
+        bc->enc->thread_count           = bc->dec->thread_count;
+        bc->enc->strict_std_compliance  = FF_COMPLIANCE_EXPERIMENTAL;
+
+        ret = avcodec_open2(bc->enc, codec, NULL);
+        if (ret < 0) {
+            fprintf(stderr, "Error opening encoder %s: %s\n",
+                    opts->encoder, av_err2str(ret));
+            return ret;
+        }
+        res->encoder = codec->name;
+        t0 = av_gettime_relative();
+    }
+
+    ret = avcodec_send_frame(bc->enc, frame);
+    while (ret >= 0) {
+        ret = avcodec_receive_packet(bc->enc, bc->enc_pkt);
+        av_packet_unref(bc->enc_pkt);
+    }
+    res->encode_us += av_gettime_relative() - t0;
+
+    return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : ret;
+}
+
+static int receive_frames(BenchContext *bc, const BenchOptions *opts,
+                          BenchResult *res)
+{
+    while (1) {
+        int64_t t0 = av_gettime_relative(), t1;
+        int ret = avcodec_receive_frame(bc->dec, bc->frame);
+
+        t1 = av_gettime_relative();
+        res->decode_us += t1 - t0;
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            return 0;
+        if (ret < 0)
+            return ret;
+
+        /* the packet index was stored in opaque, offset by one so that
+         * frames without an associated packet can be told apart */
+        if (bc->frame->opaque) {
+            int64_t idx = (intptr_t)bc->frame->opaque - 1;
+
+            if (bc->nb_latency == bc->latency_allocated) {
+                bc->latency_allocated = FFMAX(2 * bc->latency_allocated, 256);
+                ret = av_reallocp_array(&bc->latency, bc->latency_allocated,
+                                        sizeof(*bc->latency));
+                if (ret < 0)
+                    return ret;
+            }
+            bc->latency[bc->nb_latency++] = t1 - bc->send_time[idx];
+        }
+        res->frames++;
+
+        if (opts->encoder) {
+            ret = encode(bc, opts, bc->frame, res);
+            if (ret < 0)
+                return ret;
+        }
+        av_frame_unref(bc->frame);
+    }
+}
+
+static int run_one(const AVCodecParameters *par, AVRational time_base,
+                   AVPacket **pkts, int nb_pkts, const BenchOptions *opts,
+                   BenchResult *res)
+{
+    BenchContext bc = { 0 };
+    const AVCodec *codec;
+    int64_t wall0, cpu0;
+    int ret;
+
+    codec = avcodec_find_decoder(par->codec_id);
+    if (!codec)
+        return AVERROR_DECODER_NOT_FOUND;
+    res->decoder = codec->name;
+
+    bc.dec       = avcodec_alloc_context3(codec);
+    bc.frame     = av_frame_alloc();
+    bc.enc_pkt   = av_packet_alloc();
+    bc.send_time = av_calloc(nb_pkts, sizeof(*bc.send_time));
+    if (!bc.dec || !bc.frame || !bc.enc_pkt || !bc.send_time) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    atomic_init(&bc.nb_buffers,   0);
+    atomic_init(&bc.buffer_bytes, 0);
+
+    ret = avcodec_parameters_to_context(bc.dec, par);
+    if (ret < 0)
+        goto end;
+    bc.dec->pkt_timebase = time_base;
+    bc.dec->thread_count = res->threads;
+    bc.dec->thread_type  = opts->thread_type;
+    bc.dec->flags       |= AV_CODEC_FLAG_COPY_OPAQUE;
+    bc.dec->opaque       = &bc;
+    bc.dec->get_buffer2  = get_buffer;
+
+    reset_peak_rss();
+    cpu0  = get_cpu_time();
+    wall0 = av_gettime_relative();
+
+    ret = avcodec_open2(bc.dec, codec, NULL);
+    if (ret < 0)
+        goto end;
+    /* report the thread count actually used for 0 (auto) */
+    res->threads = bc.dec->thread_count;
+
+    for (int i = 0; i < nb_pkts; i++) {
+        int64_t t0;
+
+        if (opts->max_frames && res->frames >= opts->max_frames)
+            break;
+
+        pkts[i]->opaque = (void *)(intptr_t)(i + 1);
+        t0 = av_gettime_relative();
+        bc.send_time[i] = t0;
+        ret = avcodec_send_packet(bc.dec, pkts[i]);
+        res->decode_us += av_gettime_relative() - t0;
+        if (ret < 0 && ret != AVERROR_INVALIDDATA)
+            goto end;
+
+        ret = receive_frames(&bc, opts, res);
+        if (ret < 0 && ret != AVERROR_INVALIDDATA)
+            goto end;
+    }
+
+    ret = avcodec_send_packet(bc.dec, NULL);
+    if (ret >= 0)
+        ret = receive_frames(&bc, opts, res);
+    if (ret >= 0 && bc.enc)
+        ret = encode(&bc, opts, NULL, res);
+    if (ret < 0)
+        goto end;
+
+    res->wall_us  = av_gettime_relative() - wall0;
+    res->cpu_us   = get_cpu_time() - cpu0;
+    res->peak_rss = get_peak_rss();
+
+    res->nb_buffers   = atomic_load(&bc.nb_buffers);
+    res->buffer_bytes = atomic_load(&bc.buffer_bytes);
+
+    if (bc.nb_latency) {
+        static const int percentiles[3] = { 50, 90, 99 };
+
+        qsort(bc.latency, bc.nb_latency, sizeof(*bc.latency), cmp_int64);
+        for (int i = 0; i < 3; i++)
+            res->latency_us[i] = bc.latency[(bc.nb_latency - 1) * percentiles[i] / 100];
+        res->latency_us[3] = bc.latency[bc.nb_latency - 1];
+    }
+
+end:
+    av_freep(&bc.send_time);
+    av_freep(&bc.latency);
+    av_packet_free(&bc.enc_pkt);
+    av_frame_free(&bc.frame);
+    avcodec_free_context(&bc.enc);
+    avcodec_free_context(&bc.dec);
+    return ret;
+}
+
+static void print_json_string(const char *str)
+{
+    putchar('"');
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\')
+            printf("\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            printf("\\u%04x", *str);
+        else
+            putchar(*str);
+    }
+    putchar('"');
+}
+
+static double fps(int64_t frames, int64_t us)
+{
+    return us ? frames * 1000000.0 / us : 0.0;
+}
+
+static void print_result(const BenchOptions *opts, const BenchResult *res,
+                         int first)
+{
+    switch (opts->format) {
+    case OUTPUT_TEXT:
+        printf("%-40s %-10s %3d %8"PRId64" %9.2f %9.2f %7.1f%% "
+               "%7.2f %7.2f %7.2f %7.2f %8"PRId64" %7"PRId64" %8"PRId64,
+               res->file, res->decoder, res->threads, res->frames,
+               fps(res->frames, res->wall_us),
+               fps(res->frames, res->decode_us),
+               res->wall_us ? 100.0 * res->cpu_us / res->wall_us : 0.0,
+               res->latency_us[0] / 1000.0, res->latency_us[1] / 1000.0,
+               res->latency_us[2] / 1000.0, res->latency_us[3] / 1000.0,
+               res->peak_rss >> 10, res->nb_buffers, res->buffer_bytes >> 10);
+        if (res->encoder)
+            printf(" %s %.2f", res->encoder, fps(res->frames, res->encode_us));
+        printf("\n");
+        break;
+    case OUTPUT_CSV:
+        printf("\"%s\",%s,%s,%d,%"PRId64",%"PRId64",%"PRId64",%"PRId64",%"PRId64","
+               "%.3f,%.3f,%.3f,%"PRId64",%"PRId64",%"PRId64",%"PRId64
+               ",%"PRId64",%"PRId64",%"PRId64"\n",
+               res->file, res->decoder, res->encoder ? res->encoder : "",
+               res->threads, res->frames, res->wall_us, res->decode_us,
+               res->encode_us, res->cpu_us,
+               fps(res->frames, res->wall_us), fps(res->frames, res->decode_us),
+               fps(res->frames, res->encode_us),
+               res->latency_us[0], res->latency_us[1], res->latency_us[2],
+               res->latency_us[3], res->peak_rss, res->nb_buffers,
+               res->buffer_bytes);
+        break;
+    case OUTPUT_JSON:
+        printf("%s\n    {\n        \"file\": ", first ? "" : ",");
+        print_json_string(res->file);
+        printf(",\n        \"decoder\": \"%s\",\n", res->decoder);
+        if (res->encoder)
+            printf("        \"encoder\": \"%s\",\n", res->encoder);
+        printf("        \"threads\": %d,\n"
+               "        \"frames\": %"PRId64",\n"
+               "        \"wall_us\": %"PRId64",\n"
+               "        \"decode_us\": %"PRId64",\n"
+               "        \"encode_us\": %"PRId64",\n"
+               "        \"cpu_us\": %"PRId64",\n"
+               "        \"fps\": %.3f,\n"
+               "        \"decode_fps\": %.3f,\n"
+               "        \"encode_fps\": %.3f,\n"
+               "        \"latency_us\": { \"p50\": %"PRId64", \"p90\": %"PRId64
+               ", \"p99\": %"PRId64", \"max\": %"PRId64" },\n"
+               "        \"peak_rss\": %"PRId64",\n"
+               "        \"frame_buffers\": %"PRId64",\n"
+               "        \"frame_buffer_bytes\": %"PRId64"\n"
+               "    }",
+               res->threads, res->frames, res->wall_us, res->decode_us,
+               res->encode_us, res->cpu_us,
+               fps(res->frames, res->wall_us), fps(res->frames, res->decode_us),
+               fps(res->frames, res->encode_us),
+               res->latency_us[0], res->latency_us[1], res->latency_us[2],
+               res->latency_us[3], res->peak_rss, res->nb_buffers,
+               res->buffer_bytes);
+        break;
+    }
+    fflush(stdout);
+}
+
+static void print_header(const BenchOptions *opts)
+{
+    switch (opts->format) {
+    case OUTPUT_TEXT:
+        printf("# FFmpeg %s, libavcodec %s\n", av_version_info(),
+               AV_STRINGIFY(LIBAVCODEC_VERSION));
+        printf("%-40s %-10s %3s %8s %9s %9s %8s %7s %7s %7s %7s %8s %7s %8s\n",
+               "file", "decoder", "thr", "frames", "fps", "dec fps", "cpu",
+               "p50 ms", "p90 ms", "p99 ms", "max ms", "rss KiB", "bufs",
+               "buf KiB");
+        break;
+    case OUTPUT_CSV:
+        printf("file,decoder,encoder,threads,frames,wall_us,decode_us,encode_us,"
+               "cpu_us,fps,decode_fps,encode_fps,latency_p50_us,latency_p90_us,"
+               "latency_p99_us,latency_max_us,peak_rss,frame_buffers,"
+               "frame_buffer_bytes\n");
+        break;
+    case OUTPUT_JSON:
+        printf("{\n  \"ffmpeg_version\": \"%s\",\n"
+               "  \"libavcodec_version\": \"%s\",\n"
+               "  \"results\": [",
+               av_version_info(), AV_STRINGIFY(LIBAVCODEC_VERSION));
+        break;
+    }
+}
+
+static void print_footer(const BenchOptions *opts)
+{
+    if (opts->format == OUTPUT_JSON)
+        printf("\n  ]\n}\n");
+}
+
+static int bench_file(const char *url, const BenchOptions *opts, int *nb_results)
+{
+    AVFormatContext *fmt = NULL;
+    AVPacket **pkts = NULL;
+    int nb_pkts = 0, allocated = 0;
+    AVStream *st;
+    int ret, idx;
+
+    ret = avformat_open_input(&fmt, url, NULL, NULL);
+    if (ret < 0)
+        return ret;
+    ret = avformat_find_stream_info(fmt, NULL);
+    if (ret < 0)
+        goto end;
+
+    idx = av_find_best_stream(fmt, opts->media_type, -1, -1, NULL, 0);
+    if (idx < 0 && opts->media_type == AVMEDIA_TYPE_UNKNOWN)
+        idx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (idx < 0 && opts->media_type == AVMEDIA_TYPE_UNKNOWN)
+        idx = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, -1, NULL, 0);
+    if (idx < 0) {
+        ret = idx;
+        goto end;
+    }
+    st = fmt->streams[idx];
+
+    while (!opts->max_frames || nb_pkts < opts->max_frames) {
+        AVPacket *pkt = av_packet_alloc();
+        if (!pkt) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        ret = av_read_frame(fmt, pkt);
+        if (ret < 0 || pkt->stream_index != idx) {
+            av_packet_free(&pkt);
+            if (ret == AVERROR_EOF)
+                break;
+            if (ret < 0)
+                goto end;
+            continue;
+        }
+
+        if (nb_pkts == allocated) {
+            AVPacket **tmp;
+            allocated = FFMAX(2 * allocated, 256);
+            tmp = av_realloc_array(pkts, allocated, sizeof(*pkts));
+            if (!tmp) {
+                av_packet_free(&pkt);
+                ret = AVERROR(ENOMEM);
+                goto end;
+            }
+            pkts = tmp;
+        }
+        pkts[nb_pkts++] = pkt;
+    }
+    if (!nb_pkts) {
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    for (int i = 0; i < opts->nb_thread_counts; i++) {
+        BenchResult res = {
+            .file    = url,
+            .threads = opts->thread_counts[i],
+        };
+
+        ret = run_one(st->codecpar, st->time_base, pkts, nb_pkts, opts, &res);
+        if (ret < 0)
+            goto end;
+        print_result(opts, &res, !*nb_results);
+        (*nb_results)++;
+    }
+
+end:
+    for (int i = 0; i < nb_pkts; i++)
+        av_packet_free(&pkts[i]);
+    av_freep(&pkts);
+    avformat_close_input(&fmt);
+    return ret;
+}
+
+static int cmp_name(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Benchmark a single file, or every file below a directory in name order.
+ * Files that cannot be decoded are reported and skipped. */
+static int bench_path(const char *path, const BenchOptions *opts, int *nb_results)
+{
+    AVIODirContext *dir = NULL;
+    AVIODirEntry *entry;
+    char **names = NULL;
+    int nb_names = 0, ret;
+
+    if (avio_open_dir(&dir, path, NULL) < 0) {
+        ret = bench_file(path, opts, nb_results);
+        if (ret < 0)
+            fprintf(stderr, "Skipping %s: %s\n", path, av_err2str(ret));
+        return 0;
+    }
+
+    while ((ret = avio_read_dir(dir, &entry)) >= 0 && entry) {
+        if (entry->name[0] != '.' &&
+            (entry->type == AVIO_ENTRY_FILE || entry->type == AVIO_ENTRY_DIRECTORY)) {
+            char *name = av_asprintf("%s/%s", path, entry->name);
+            if (!name || av_dynarray_add_nofree(&names, &nb_names, name) < 0) {
+                av_free(name);
+                ret = AVERROR(ENOMEM);
+            }
+        }
+        avio_free_directory_entry(&entry);
+        if (ret < 0)
+            break;
+    }
+    avio_close_dir(&dir);
+
+    if (ret >= 0 && nb_names) {
+        qsort(names, nb_names, sizeof(*names), cmp_name);
+        for (int i = 0; i < nb_names && ret >= 0; i++)
+            ret = bench_path(names[i], opts, nb_results);
+    }
+
+    for (int i = 0; i < nb_names; i++)
+        av_free(names[i]);
+    av_free(names);
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <file or directory>...\n"
+            "  -t <n>[,<n>...]   decoder thread counts to test, 0 for auto (default 1)\n"
+            "  -y <type>         thread type: frame, slice or both (default both)\n"
+            "  -m <type>         stream to decode: video or audio (default video, else audio)\n"
+            "  -e <encoder>      re-encode the decoded video with this encoder\n"
+            "  -n <frames>       limit the number of frames per file\n"
+            "  -f <format>       output format: text, csv or json (default text)\n"
+            "Peak RSS is per run on Linux and for the whole process elsewhere.\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions opts = {
+        .thread_counts    = { 1 },
+        .nb_thread_counts = 1,
+        .thread_type      = FF_THREAD_FRAME | FF_THREAD_SLICE,
+        .media_type       = AVMEDIA_TYPE_UNKNOWN,
+    };
+    int nb_results = 0, opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "ht:y:m:e:n:f:")) != -1) {
+        switch (opt) {
+        case 't': {
+            const char *p = optarg;
+            opts.nb_thread_counts = 0;
+            while (*p && opts.nb_thread_counts < MAX_THREAD_CONFIGS) {
+                char *next;
+                opts.thread_counts[opts.nb_thread_counts++] = strtol(p, &next, 0);
+                if (next == p)
+                    goto invalid;
+                p = next + (*next == ',');
+            }
+            if (!opts.nb_thread_counts)
+                goto invalid;
+            break;
+        }
+        case 'y':
+            if (!strcmp(optarg, "frame"))
+                opts.thread_type = FF_THREAD_FRAME;
+            else if (!strcmp(optarg, "slice"))
+                opts.thread_type = FF_THREAD_SLICE;
+            else if (!strcmp(optarg, "both"))
+                opts.thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            else
+                goto invalid;
+            break;
+        case 'm':
+            if (!strcmp(optarg, "video"))
+                opts.media_type = AVMEDIA_TYPE_VIDEO;
+            else if (!strcmp(optarg, "audio"))
+                opts.media_type = AVMEDIA_TYPE_AUDIO;
+            else
+                goto invalid;
+            break;
+        case 'e':
+            opts.encoder = optarg;
+            break;
+        case 'n':
+            opts.max_frames = strtol(optarg, NULL, 0);
+            break;
+        case 'f':
+            if (!strcmp(optarg, "text"))
+                opts.format = OUTPUT_TEXT;
+            else if (!strcmp(optarg, "csv"))
+                opts.format = OUTPUT_CSV;
+            else if (!strcmp(optarg, "json"))
+                opts.format = OUTPUT_JSON;
+            else
+                goto invalid;
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    print_header(&opts);
+    for (int i = optind; i < argc && ret >= 0; i++)
+        ret = bench_path(argv[i], &opts, &nb_results);
+    print_footer(&opts);
+
+    return ret < 0;
+
+invalid:
+    fprintf(stderr, "Invalid argument for -%c: %s\n", opt, optarg);
+    return 1;
+}